@@ -0,0 +1,64 @@
+/**
+ * bench_datetime.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Parsing and formatting of timestamp columns with the default
+ * layout: 'strptime' and 'strftime' against hand-written codecs.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "../src/utility.h"
+
+using namespace xw;
+
+
+static constexpr const char* TIMESTAMP = "2021-03-04 05:06:07";
+
+static void BM_datetime_parse_strptime(benchmark::State& state)
+{
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(dt::Datetime::strptime(TIMESTAMP, orm::util::ISO_DATETIME_FORMAT));
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_datetime_parse_iso(benchmark::State& state)
+{
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(orm::util::as_datetime(TIMESTAMP, orm::util::ISO_DATETIME_FORMAT));
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_datetime_format_strftime(benchmark::State& state)
+{
+	dt::Datetime datetime(2021, 3, 4, 5, 6, 7);
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(datetime.strftime(orm::util::ISO_DATETIME_FORMAT));
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_datetime_format_iso(benchmark::State& state)
+{
+	dt::Datetime datetime(2021, 3, 4, 5, 6, 7);
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(orm::util::format_datetime(datetime, orm::util::ISO_DATETIME_FORMAT));
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_datetime_parse_strptime);
+BENCHMARK(BM_datetime_parse_iso);
+BENCHMARK(BM_datetime_format_strftime);
+BENCHMARK(BM_datetime_format_iso);
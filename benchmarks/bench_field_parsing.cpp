@@ -0,0 +1,82 @@
+/**
+ * bench_field_parsing.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Parsing of a single text column into the field: the text copied
+ * into a temporary string and extracted by 'util::as' against
+ * 'text_as_field' which parses it in place.
+ */
+
+#include <cstring>
+
+#include <benchmark/benchmark.h>
+
+#include "../src/db/meta.h"
+
+using namespace xw;
+
+
+// Text of the column as it is received from the driver.
+template <typename FieldT>
+static const char* sample_data()
+{
+	if constexpr (std::is_same_v<FieldT, int>)
+	{
+		return "1234567";
+	}
+	else if constexpr (std::is_same_v<FieldT, long long>)
+	{
+		return "-9123456789012";
+	}
+	else if constexpr (std::is_same_v<FieldT, double>)
+	{
+		return "12345.678901";
+	}
+	else
+	{
+		return "value of the text column";
+	}
+}
+
+// The path which was used by 'Model::__orm_set_column_data__'.
+template <typename FieldT>
+static FieldT copied_as_field(const char* data)
+{
+	size_t len = std::strlen(data);
+	std::string str_val = {data, data + len + 1};
+	return xw::util::as<FieldT>(str_val.c_str());
+}
+
+template <typename FieldT>
+static void BM_field_parsing_copied(benchmark::State& state)
+{
+	auto data = sample_data<FieldT>();
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(copied_as_field<FieldT>(data));
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+template <typename FieldT>
+static void BM_field_parsing_in_place(benchmark::State& state)
+{
+	auto data = sample_data<FieldT>();
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(orm::db::column_as_field<FieldT>(data));
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_field_parsing_copied, int);
+BENCHMARK_TEMPLATE(BM_field_parsing_in_place, int);
+BENCHMARK_TEMPLATE(BM_field_parsing_copied, long long);
+BENCHMARK_TEMPLATE(BM_field_parsing_in_place, long long);
+BENCHMARK_TEMPLATE(BM_field_parsing_copied, double);
+BENCHMARK_TEMPLATE(BM_field_parsing_in_place, double);
+BENCHMARK_TEMPLATE(BM_field_parsing_copied, std::string);
+BENCHMARK_TEMPLATE(BM_field_parsing_in_place, std::string);
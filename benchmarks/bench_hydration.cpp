@@ -0,0 +1,144 @@
+/**
+ * bench_hydration.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Setting fields of a 20-column model from a result row: text map
+ * with lookup by name for each field against typed row bound to
+ * the setters once per result set.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "../src/db/model.h"
+
+using namespace xw;
+
+
+class BenchmarkModel : public orm::db::Model
+{
+public:
+	static constexpr const char* meta_table_name = "benchmark_models";
+
+	long long id{};
+	int c_1{}, c_2{}, c_3{}, c_4{}, c_5{};
+	double c_6{}, c_7{}, c_8{}, c_9{}, c_10{};
+	long c_11{}, c_12{}, c_13{}, c_14{};
+	std::string c_15, c_16, c_17, c_18, c_19;
+
+	inline static constexpr std::tuple meta_columns = {
+		orm::db::make_pk_column_meta("id", &BenchmarkModel::id),
+		orm::db::make_column_meta("c_1", &BenchmarkModel::c_1),
+		orm::db::make_column_meta("c_2", &BenchmarkModel::c_2),
+		orm::db::make_column_meta("c_3", &BenchmarkModel::c_3),
+		orm::db::make_column_meta("c_4", &BenchmarkModel::c_4),
+		orm::db::make_column_meta("c_5", &BenchmarkModel::c_5),
+		orm::db::make_column_meta("c_6", &BenchmarkModel::c_6),
+		orm::db::make_column_meta("c_7", &BenchmarkModel::c_7),
+		orm::db::make_column_meta("c_8", &BenchmarkModel::c_8),
+		orm::db::make_column_meta("c_9", &BenchmarkModel::c_9),
+		orm::db::make_column_meta("c_10", &BenchmarkModel::c_10),
+		orm::db::make_column_meta("c_11", &BenchmarkModel::c_11),
+		orm::db::make_column_meta("c_12", &BenchmarkModel::c_12),
+		orm::db::make_column_meta("c_13", &BenchmarkModel::c_13),
+		orm::db::make_column_meta("c_14", &BenchmarkModel::c_14),
+		orm::db::make_column_meta("c_15", &BenchmarkModel::c_15),
+		orm::db::make_column_meta("c_16", &BenchmarkModel::c_16),
+		orm::db::make_column_meta("c_17", &BenchmarkModel::c_17),
+		orm::db::make_column_meta("c_18", &BenchmarkModel::c_18),
+		orm::db::make_column_meta("c_19", &BenchmarkModel::c_19)
+	};
+
+	inline void __orm_set_column__(const std::string& column_name, const char* data) override
+	{
+		this->__orm_set_column_data__(BenchmarkModel::meta_columns, column_name, data);
+	}
+};
+
+static constexpr size_t COLUMNS_COUNT = 20;
+
+// Row as it is received from the driver: numbers are decoded, strings
+// refer to the driver's memory.
+struct BenchmarkRow
+{
+	std::vector<std::string> text;
+	orm::db::Columns columns;
+	std::vector<orm::db::Value> values;
+
+	BenchmarkRow()
+	{
+		std::vector<std::string> names;
+		for (size_t i = 0; i < COLUMNS_COUNT; i++)
+		{
+			names.push_back(i ? "c_" + std::to_string(i) : "id");
+			this->text.push_back(i < 15 ? std::to_string(i * 1000 + 7) : "value of column " + std::to_string(i));
+		}
+
+		this->columns = orm::db::Columns(std::move(names));
+		for (size_t i = 0; i < COLUMNS_COUNT; i++)
+		{
+			if (i < 15)
+			{
+				this->values.emplace_back((long long)(i * 1000 + 7));
+			}
+			else
+			{
+				this->values.emplace_back(std::string_view(this->text[i]));
+			}
+		}
+	}
+};
+
+static void BM_hydration_from_map(benchmark::State& state)
+{
+	BenchmarkRow row;
+	std::map<std::string, char*> map;
+	for (size_t i = 0; i < COLUMNS_COUNT; i++)
+	{
+		map[row.columns.name(i)] = row.text[i].data();
+	}
+
+	for (auto _ : state)
+	{
+		BenchmarkModel model;
+		model.from_map(map);
+		benchmark::DoNotOptimize(model);
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+// Setters are resolved for each row.
+static void BM_hydration_from_row(benchmark::State& state)
+{
+	BenchmarkRow row;
+	orm::db::Row view(row.columns, row.values.data());
+	for (auto _ : state)
+	{
+		BenchmarkModel model;
+		orm::db::from_row(model, view);
+		benchmark::DoNotOptimize(model);
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+// Setters are resolved once, like 'Select' does for the result set.
+static void BM_hydration_row_hydrator(benchmark::State& state)
+{
+	BenchmarkRow row;
+	orm::db::Row view(row.columns, row.values.data());
+	orm::db::RowHydrator<BenchmarkModel> hydrate;
+	for (auto _ : state)
+	{
+		BenchmarkModel model;
+		hydrate(model, view);
+		benchmark::DoNotOptimize(model);
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_hydration_from_map);
+BENCHMARK(BM_hydration_from_row);
+BENCHMARK(BM_hydration_row_hydrator);
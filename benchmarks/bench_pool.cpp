@@ -0,0 +1,86 @@
+/**
+ * bench_pool.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Contention of connection pools: each thread requests a connection
+ * and returns it back immediately, like a short query does.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "../src/pool.h"
+#include "../src/sharded_pool.h"
+
+using namespace xw;
+
+
+class BenchmarkConnection : public orm::IDatabaseConnection
+{
+public:
+	[[nodiscard]]
+	inline std::string dbms_name() const override
+	{
+		return "BenchmarkConnection";
+	};
+
+	inline void run_query(
+		const std::string& sql_query,
+		const std::function<void(const std::map<std::string, char*>& /* columns */)>& map_handler,
+		const std::function<void(const std::vector<char*>& /* columns */)>& vector_handler
+	) const override
+	{
+	}
+
+	inline void run_query(const std::string& sql_query, std::string& last_row_id) const override
+	{
+	}
+
+	inline void begin_transaction() const override
+	{
+	}
+
+	inline void end_transaction() const override
+	{
+	}
+
+	inline void rollback_transaction() const override
+	{
+	}
+};
+
+// Pool is shared by all threads of the benchmark, so it is created
+// by the first thread and destroyed after the last one finishes.
+template <typename PoolType>
+static void BM_pool_acquire_release(benchmark::State& state)
+{
+	static std::unique_ptr<orm::IConnectionPool> pool;
+	if (state.thread_index() == 0)
+	{
+		pool = std::make_unique<PoolType>(orm::PoolOptions(state.range(0)), []()
+		{
+			return std::make_shared<BenchmarkConnection>();
+		});
+		pool->create();
+	}
+
+	for (auto _ : state)
+	{
+		auto connection = pool->acquire();
+		benchmark::DoNotOptimize(connection.get());
+		pool->release(connection);
+	}
+
+	state.SetItemsProcessed(state.iterations());
+	if (state.thread_index() == 0)
+	{
+		pool.reset();
+	}
+}
+
+// 64 connections: threads never wait for each other's connection,
+// only for the pool itself. 4 connections: the pool is exhausted.
+BENCHMARK_TEMPLATE(BM_pool_acquire_release, orm::ConnectionPool)
+	->Arg(64)->Arg(4)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_pool_acquire_release, orm::ShardedConnectionPool)
+	->Arg(64)->Arg(4)->ThreadRange(1, 64)->UseRealTime();
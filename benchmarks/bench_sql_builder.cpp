@@ -0,0 +1,106 @@
+/**
+ * bench_sql_builder.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Building of the typical 'SELECT' statement by the default builder:
+ * selected columns, join, condition with parameters, ordering and
+ * limit. The list of columns is either built for each query or
+ * taken from the cache, like 'Select' does.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "../src/sql_builder.h"
+
+using namespace xw;
+
+
+class BenchmarkUser : public orm::db::Model
+{
+public:
+	static constexpr const char* meta_table_name = "users";
+
+	long long id{};
+	std::string name;
+	std::string email;
+	int age{};
+
+	inline static constexpr std::tuple meta_columns = {
+		orm::db::make_pk_column_meta("id", &BenchmarkUser::id),
+		orm::db::make_column_meta("name", &BenchmarkUser::name),
+		orm::db::make_column_meta("email", &BenchmarkUser::email),
+		orm::db::make_column_meta("age", &BenchmarkUser::age)
+	};
+
+	inline void __orm_set_column__(const std::string& column_name, const char* data) override
+	{
+		this->__orm_set_column_data__(BenchmarkUser::meta_columns, column_name, data);
+	}
+};
+
+class BenchmarkOrder : public orm::db::Model
+{
+public:
+	static constexpr const char* meta_table_name = "orders";
+
+	long long id{};
+	long long user_id{};
+
+	inline static constexpr std::tuple meta_columns = {
+		orm::db::make_pk_column_meta("id", &BenchmarkOrder::id),
+		orm::db::make_column_meta("user_id", &BenchmarkOrder::user_id)
+	};
+
+	inline void __orm_set_column__(const std::string& column_name, const char* data) override
+	{
+		this->__orm_set_column_data__(BenchmarkOrder::meta_columns, column_name, data);
+	}
+};
+
+// 'state.range(0)' is 1 when values are passed as parameters.
+static void BM_sql_builder_select(benchmark::State& state)
+{
+	orm::DefaultSQLBuilder builder;
+	auto condition = (orm::q::c<&BenchmarkUser::age>() >= 18) & (orm::q::c<&BenchmarkUser::name>() != "root");
+	std::list<orm::q::Join> joins = {orm::q::left_on<BenchmarkUser, BenchmarkOrder>("user_id")};
+	std::list<orm::q::Ordering> order_by = {orm::q::desc<&BenchmarkUser::age>(), orm::q::asc<&BenchmarkUser::id>()};
+	const auto& columns = orm::db::get_column_names<BenchmarkUser>();
+	std::vector<orm::db::Parameter> parameters;
+	for (auto _ : state)
+	{
+		parameters.clear();
+		benchmark::DoNotOptimize(builder.sql_select(
+			BenchmarkUser::meta_table_name, columns, false, joins, condition, order_by, 50, 100, {}, {},
+			state.range(0) ? &parameters : nullptr
+		));
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+// The list of selected columns is built once.
+static void BM_sql_builder_select_cached_columns(benchmark::State& state)
+{
+	orm::DefaultSQLBuilder builder;
+	auto condition = (orm::q::c<&BenchmarkUser::age>() >= 18) & (orm::q::c<&BenchmarkUser::name>() != "root");
+	std::list<orm::q::Join> joins = {orm::q::left_on<BenchmarkUser, BenchmarkOrder>("user_id")};
+	std::list<orm::q::Ordering> order_by = {orm::q::desc<&BenchmarkUser::age>(), orm::q::asc<&BenchmarkUser::id>()};
+	auto columns = builder.sql_select_columns(
+		BenchmarkUser::meta_table_name, orm::db::get_column_names<BenchmarkUser>()
+	);
+	std::vector<orm::db::Parameter> parameters;
+	for (auto _ : state)
+	{
+		parameters.clear();
+		benchmark::DoNotOptimize(builder.sql_select_(
+			BenchmarkUser::meta_table_name, columns, false, joins, condition, order_by, 50, 100, {}, {},
+			state.range(0) ? &parameters : nullptr
+		));
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_sql_builder_select)->Arg(0)->Arg(1);
+BENCHMARK(BM_sql_builder_select_cached_columns)->Arg(0)->Arg(1);
@@ -13,34 +13,112 @@
 
 __ORM_BEGIN__
 
+DefaultSQLBackend::~DefaultSQLBackend()
+{
+	this->_stop_reporting();
+	_fail_waiters(this->_waiters);
+	_fail_waiters(this->_read_waiters);
+}
+
 void DefaultSQLBackend::create_pool()
 {
-	std::lock_guard<std::mutex> locker(this->_mutex);
-	for (auto i = 0; i < this->_pool_size; i++)
+	this->_pool->create();
+	if (this->_read_pool)
 	{
-		this->_connection_pool.emplace(std::move(this->_connection_builder()));
+		this->_read_pool->create();
 	}
 }
 
-std::shared_ptr<IDatabaseConnection> DefaultSQLBackend::get_connection()
+void DefaultSQLBackend::set_read_pool(const PoolOptions& pool_options, ConnectionBuilder builder)
+{
+	this->_read_pool = this->make_pool(pool_options, std::move(builder));
+}
+
+void DefaultSQLBackend::set_read_pool(std::unique_ptr<IConnectionPool> pool)
 {
-	std::unique_lock<std::mutex> lock(this->_mutex);
-	while (this->_connection_pool.empty())
+	if (!pool)
 	{
-		this->_condition.wait(lock);
+		throw NullPointerException("read pool is nullptr", _ERROR_DETAILS_);
 	}
 
-	auto connection = this->_connection_pool.front();
-	this->_connection_pool.pop();
-	return connection;
+	this->_read_pool = std::move(pool);
+}
+
+std::shared_ptr<IDatabaseConnection> DefaultSQLBackend::get_connection()
+{
+	return this->_pool->acquire();
+}
+
+std::shared_ptr<IDatabaseConnection> DefaultSQLBackend::get_connection(std::chrono::milliseconds timeout)
+{
+	return this->_pool->acquire(timeout);
+}
+
+void DefaultSQLBackend::get_connection_async(ConnectionHandler handler)
+{
+	_acquire_async(*this->_pool, this->_waiters, std::move(handler));
 }
 
 void DefaultSQLBackend::release_connection(const std::shared_ptr<IDatabaseConnection>& connection)
 {
-	std::unique_lock<std::mutex> lock(this->_mutex);
-	this->_connection_pool.push(connection);
-	lock.unlock();
-	this->_condition.notify_one();
+	_release(*this->_pool, this->_waiters, connection);
+}
+
+std::shared_ptr<IDatabaseConnection> DefaultSQLBackend::get_read_connection()
+{
+	return this->_read_pool ? this->_read_pool->acquire() : this->get_connection();
+}
+
+void DefaultSQLBackend::get_read_connection_async(ConnectionHandler handler)
+{
+	if (this->_read_pool)
+	{
+		_acquire_async(*this->_read_pool, this->_read_waiters, std::move(handler));
+	}
+	else
+	{
+		this->get_connection_async(std::move(handler));
+	}
+}
+
+void DefaultSQLBackend::release_read_connection(const std::shared_ptr<IDatabaseConnection>& connection)
+{
+	if (this->_read_pool)
+	{
+		_release(*this->_read_pool, this->_read_waiters, connection);
+	}
+	else
+	{
+		this->release_connection(connection);
+	}
+}
+
+void DefaultSQLBackend::report_pool_metrics(MetricsCallback callback, std::chrono::milliseconds interval)
+{
+	this->_stop_reporting();
+	if (!callback)
+	{
+		return;
+	}
+
+	this->_is_reporting_stopped = false;
+	this->_reporting_thread = std::thread([this, callback = std::move(callback), interval]()
+	{
+		std::unique_lock<std::mutex> lock(this->_reporting_mutex);
+		while (!this->_reporting_condition.wait_for(lock, interval, [this] { return this->_is_reporting_stopped; }))
+		{
+			lock.unlock();
+			try
+			{
+				callback(this->pools_metrics());
+			}
+			catch (...)
+			{
+			}
+
+			lock.lock();
+		}
+	});
 }
 
 ISQLQueryBuilder* DefaultSQLBackend::sql_builder() const
@@ -63,4 +141,206 @@ db::ISchemaEditor* DefaultSQLBackend::schema_editor() const
 	return this->sql_schema_editor.get();
 }
 
+ConnectionBuilder DefaultSQLBackend::_with_initializers(ConnectionBuilder builder)
+{
+	if (!builder)
+	{
+		return nullptr;
+	}
+
+	return [this, builder = std::move(builder)]() -> std::shared_ptr<IDatabaseConnection>
+	{
+		auto connection = builder();
+		if (connection && !this->_initializers.empty())
+		{
+			// The handler is owned by the connection, so it can
+			// refer to the connection by the raw pointer.
+			auto initialize = [this, raw_connection = connection.get()]() -> void
+			{
+				for (const auto& initializer : this->_initializers)
+				{
+					initializer(*raw_connection);
+				}
+			};
+			initialize();
+			if (auto* sql_connection = dynamic_cast<ISQLConnection*>(connection.get()))
+			{
+				sql_connection->set_reconnect_handler(std::move(initialize));
+			}
+		}
+
+		return connection;
+	};
+}
+
+std::unique_ptr<IConnectionPool> DefaultSQLBackend::_make_pool(
+	const PoolOptions& pool_options, ConnectionBuilder builder
+)
+{
+	if (pool_options.max_connections < 1)
+	{
+		throw ValueError("Pool size should be greater than zero", _ERROR_DETAILS_);
+	}
+
+	if (pool_options.min_connections > pool_options.max_connections)
+	{
+		throw ValueError(
+			"Minimum number of connections should not be greater than maximum one", _ERROR_DETAILS_
+		);
+	}
+
+	if (!builder)
+	{
+		throw NullPointerException("connection builder is nullptr", _ERROR_DETAILS_);
+	}
+
+	if (pool_options.is_sharded)
+	{
+		return std::make_unique<ShardedConnectionPool>(pool_options, std::move(builder));
+	}
+
+	return std::make_unique<ConnectionPool>(pool_options, std::move(builder));
+}
+
+void DefaultSQLBackend::_acquire_async(IConnectionPool& pool, Waiters& waiters, ConnectionHandler handler)
+{
+	std::shared_ptr<IDatabaseConnection> connection;
+	try
+	{
+		connection = pool.try_acquire();
+	}
+	catch (...)
+	{
+		handler(nullptr, std::current_exception());
+		return;
+	}
+
+	if (connection)
+	{
+		handler(connection, nullptr);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(waiters.mutex);
+		waiters.handlers.push_back(std::move(handler));
+		waiters.count++;
+	}
+
+	// The connection could be released before the handler
+	// was registered.
+	_serve_waiters(pool, waiters);
+}
+
+void DefaultSQLBackend::_release(
+	IConnectionPool& pool, Waiters& waiters, const std::shared_ptr<IDatabaseConnection>& connection
+)
+{
+	pool.release(connection);
+
+	// The pool is checked after the waiter is registered, so either
+	// the waiter finds this connection, or the counter is seen here.
+	if (waiters.count.load())
+	{
+		_serve_waiters(pool, waiters);
+	}
+}
+
+void DefaultSQLBackend::_serve_waiters(IConnectionPool& pool, Waiters& waiters)
+{
+	while (true)
+	{
+		{
+			std::lock_guard<std::mutex> lock(waiters.mutex);
+			if (waiters.handlers.empty())
+			{
+				return;
+			}
+		}
+
+		// The pool can open a new connection, so it is probed
+		// without holding the lock of waiters.
+		std::shared_ptr<IDatabaseConnection> connection;
+		std::exception_ptr error;
+		try
+		{
+			connection = pool.try_acquire();
+			if (!connection)
+			{
+				return;
+			}
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+		}
+
+		ConnectionHandler handler;
+		{
+			std::lock_guard<std::mutex> lock(waiters.mutex);
+			if (!waiters.handlers.empty())
+			{
+				handler = std::move(waiters.handlers.front());
+				waiters.handlers.pop_front();
+				waiters.count--;
+			}
+		}
+
+		if (!handler)
+		{
+			// Waiters were served by other thread in the meantime. The
+			// connection is returned and the loop checks for waiters
+			// which could be registered while it was held.
+			if (connection)
+			{
+				pool.release(connection);
+			}
+
+			continue;
+		}
+
+		handler(connection, error);
+	}
+}
+
+void DefaultSQLBackend::_fail_waiters(Waiters& waiters)
+{
+	std::deque<ConnectionHandler> handlers;
+	{
+		std::lock_guard<std::mutex> lock(waiters.mutex);
+		handlers.swap(waiters.handlers);
+		waiters.count = 0;
+	}
+
+	// Called from the destructor, so errors of handlers are ignored.
+	for (auto& handler : handlers)
+	{
+		try
+		{
+			handler(nullptr, std::make_exception_ptr(
+				DatabaseError("Backend is destroyed while waiting for connection", _ERROR_DETAILS_)
+			));
+		}
+		catch (...)
+		{
+		}
+	}
+}
+
+void DefaultSQLBackend::_stop_reporting()
+{
+	if (!this->_reporting_thread.joinable())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(this->_reporting_mutex);
+		this->_is_reporting_stopped = true;
+	}
+
+	this->_reporting_condition.notify_all();
+	this->_reporting_thread.join();
+}
+
 __ORM_END__
@@ -10,17 +10,28 @@
 #pragma once
 
 // C++ libraries.
-#include <mutex>
-#include <condition_variable>
-#include <queue>
 #include <memory>
+#include <chrono>
 #include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <exception>
+#include <optional>
 
 // Module definitions.
 #include "./_def_.h"
 
 // Orm libraries.
 #include "./interfaces.h"
+#include "./pool.h"
+#include "./sharded_pool.h"
+#include "./replica_pool.h"
+#include "./pool_metrics.h"
+#include "./coroutine.h"
 
 
 __ORM_BEGIN__
@@ -30,23 +41,70 @@ __ORM_BEGIN__
 class DefaultSQLBackend : public ISQLBackend
 {
 public:
-	using ConnectionBuilder = std::function<std::shared_ptr<IDatabaseConnection>()>;
+	using ConnectionBuilder = orm::ConnectionBuilder;
 
-	explicit inline DefaultSQLBackend(size_t pool_size, ConnectionBuilder builder) :
-		_pool_size(pool_size), _connection_builder(std::move(builder))
+	// Metrics of both pools of the backend. 'read' is empty if the
+	// backend has no separate pool of read connections.
+	struct PoolsMetrics
 	{
-		if (pool_size < 1)
-		{
-			throw ValueError("Pool size should be greater than zero", _ERROR_DETAILS_);
-		}
+		PoolMetrics main;
+		std::optional<PoolMetrics> read;
+	};
+
+	using MetricsCallback = std::function<void(const PoolsMetrics& /* metrics */)>;
+
+	// Prepares a new connection before the pool provides it.
+	using ConnectionInitializer = std::function<void(IDatabaseConnection& /* connection */)>;
+
+	using ConnectionHandler = std::function<void(
+		std::shared_ptr<IDatabaseConnection> /* connection */, std::exception_ptr /* error */
+	)>;
+
+	// Throws 'ValueError' if bounds of the pool are invalid.
+	explicit inline DefaultSQLBackend(const PoolOptions& pool_options, ConnectionBuilder builder) :
+		_pool(this->make_pool(pool_options, std::move(builder)))
+	{
+	}
+
+	// Stops reporting of metrics. Handlers which are waiting for
+	// connections receive 'DatabaseError'.
+	~DefaultSQLBackend() override;
+
+	// Opens 'min_connections' connections of each pool.
+	void create_pool() final;
 
-		if (!this->_connection_builder)
+	// Adds a separate pool of connections which are provided by
+	// 'get_read_connection'. Should be called before the backend
+	// is used.
+	//
+	// Throws 'ValueError' if bounds of the pool are invalid.
+	void set_read_pool(const PoolOptions& pool_options, ConnectionBuilder builder);
+
+	// Acts like 'set_read_pool' above, but uses 'pool' which is built
+	// by the caller, for example, 'ReplicaPool' of pools which are
+	// returned by 'make_pool'.
+	void set_read_pool(std::unique_ptr<IConnectionPool> pool);
+
+	// Adds 'initializer' which is called for each connection of both
+	// pools after it is opened, in order of adding, and again after the
+	// connection reconnects in place of the lost one. Errors which are
+	// thrown by 'initializer' fail opening of the connection. Should
+	// be called before 'create_pool'.
+	inline void add_connection_initializer(ConnectionInitializer initializer)
+	{
+		if (!initializer)
 		{
-			throw NullPointerException("connection builder is nullptr", _ERROR_DETAILS_);
+			throw NullPointerException("connection initializer is nullptr", _ERROR_DETAILS_);
 		}
+
+		this->_initializers.push_back(std::move(initializer));
 	}
 
-	void create_pool() final;
+	[[nodiscard]]
+	inline bool has_read_pool() const
+	{
+		return this->_read_pool != nullptr;
+	}
 
 	inline ConnectionWrapper wrap_connection() final
 	{
@@ -54,16 +112,129 @@ public:
 	}
 
 	// Provides a free connection from pool to access the database.
-	// If there is not any connection available, waits for it.
+	// If there is not any connection available and the pool is full,
+	// waits for it during 'acquire_timeout' of the pool options.
 	// This is a blocking operation.
+	//
+	// Throws 'PoolTimeoutError' if the timeout expires.
 	std::shared_ptr<IDatabaseConnection> get_connection() override;
 
+	// Acts like 'get_connection()', but waits during 'timeout'.
+	// Zero 'timeout' means that the connection is provided only
+	// if it is available immediately.
+	//
+	// Throws 'PoolTimeoutError' if the timeout expires.
+	std::shared_ptr<IDatabaseConnection> get_connection(std::chrono::milliseconds timeout);
+
+	// Provides a free connection to 'handler' without blocking of the
+	// calling thread. If the pool is exhausted, 'handler' is called
+	// from the thread which releases the next connection, waiting
+	// requests are served in order of arrival. 'acquire_timeout' is
+	// not applied. Opening of a new connection is blocking.
+	void get_connection_async(ConnectionHandler handler);
+
+	// Awaitable version of 'get_connection_async'.
+	[[nodiscard]]
+	inline Awaitable<std::shared_ptr<IDatabaseConnection>> co_get_connection()
+	{
+		return Awaitable<std::shared_ptr<IDatabaseConnection>>([this](auto handler) -> void {
+			this->get_connection_async(std::move(handler));
+		});
+	}
+
 	// Returns used connection to pool.
 	// The code that requested a connection, ALWAYS should return
 	// it back after using it, otherwise this connection will be
 	// lost.
 	void release_connection(const std::shared_ptr<IDatabaseConnection>& connection) override;
 
+	// Provides a connection for queries which do not modify the
+	// database. Acts like 'get_connection()' for the pool which is
+	// set by 'set_read_pool' or for the main one if it is not set.
+	//
+	// Throws 'PoolTimeoutError' if the timeout expires.
+	std::shared_ptr<IDatabaseConnection> get_read_connection();
+
+	// Acts like 'get_connection_async' for the pool which is set by
+	// 'set_read_pool' or for the main one if it is not set.
+	void get_read_connection_async(ConnectionHandler handler);
+
+	// Awaitable version of 'get_read_connection_async'.
+	[[nodiscard]]
+	inline Awaitable<std::shared_ptr<IDatabaseConnection>> co_get_read_connection()
+	{
+		return Awaitable<std::shared_ptr<IDatabaseConnection>>([this](auto handler) -> void {
+			this->get_read_connection_async(std::move(handler));
+		});
+	}
+
+	// Returns the connection which was provided by 'get_read_connection'
+	// or 'get_read_connection_async'.
+	void release_read_connection(const std::shared_ptr<IDatabaseConnection>& connection);
+
+	// Closes connections above 'min_connections' which are idle longer
+	// than 'idle_timeout' of the pool options. Check the pool which is
+	// used for details about when it is done automatically.
+	inline void evict_idle_connections()
+	{
+		this->_pool->evict_idle_connections();
+		if (this->_read_pool)
+		{
+			this->_read_pool->evict_idle_connections();
+		}
+	}
+
+	// Number of open connections of the main pool, including used
+	// ones. Check 'pools_metrics' for the pool of read connections.
+	[[nodiscard]]
+	inline size_t connections_count()
+	{
+		return this->_pool->connections_count();
+	}
+
+	// Number of open connections which are waiting in the main pool.
+	[[nodiscard]]
+	inline size_t idle_connections_count()
+	{
+		return this->_pool->idle_connections_count();
+	}
+
+	// Returns the current state of the main pool, counters of
+	// connections and histograms of acquire wait time and hold time
+	// accumulated since the pool was created.
+	[[nodiscard]]
+	inline PoolMetrics pool_metrics()
+	{
+		return this->_pool->metrics();
+	}
+
+	// Acts like 'pool_metrics()' for the pool of read connections.
+	// Returns metrics of the main pool if it is not set.
+	[[nodiscard]]
+	inline PoolMetrics read_pool_metrics()
+	{
+		return this->_read_pool ? this->_read_pool->metrics() : this->_pool->metrics();
+	}
+
+	// Returns metrics of the main pool and of the pool of read
+	// connections if it is set. With SQLite in WAL mode or PostgreSQL
+	// replicas the main pool holds writers only, so the read pool is
+	// the one which serves most queries.
+	[[nodiscard]]
+	inline PoolsMetrics pools_metrics()
+	{
+		return {
+			this->_pool->metrics(),
+			this->_read_pool ? std::optional<PoolMetrics>(this->_read_pool->metrics()) : std::nullopt
+		};
+	}
+
+	// Calls 'callback' with 'pools_metrics()' every 'interval' from
+	// a background thread until the backend is destroyed. Replaces
+	// the previous callback, empty 'callback' stops reporting.
+	// Exceptions which are thrown by 'callback' are ignored.
+	void report_pool_metrics(MetricsCallback callback, std::chrono::milliseconds interval);
+
 	// TESTME: schema_editor
 	// Instantiates default schema editor if it was not
 	// done yet and returns it.
@@ -78,6 +249,16 @@ public:
 
 protected:
 
+	// Builds the pool of the kind which is set in 'pool_options'.
+	// Connections of the pool are prepared by initializers of the
+	// backend.
+	//
+	// Throws 'ValueError' if bounds of the pool are invalid.
+	inline std::unique_ptr<IConnectionPool> make_pool(const PoolOptions& pool_options, ConnectionBuilder builder)
+	{
+		return _make_pool(pool_options, this->_with_initializers(std::move(builder)));
+	}
+
 	// SQL Schema editor related to SQL driver.
 	mutable std::shared_ptr<db::ISchemaEditor> sql_schema_editor = nullptr;
 
@@ -85,11 +266,53 @@ protected:
 	mutable std::shared_ptr<ISQLQueryBuilder> sql_query_builder = nullptr;
 
 private:
-	std::mutex _mutex;
-	std::condition_variable _condition;
-	std::queue<std::shared_ptr<IDatabaseConnection>> _connection_pool;
-	const size_t _pool_size;
-	ConnectionBuilder _connection_builder;
+	std::unique_ptr<IConnectionPool> _pool;
+	std::unique_ptr<IConnectionPool> _read_pool;
+
+	std::vector<ConnectionInitializer> _initializers;
+
+	// Wraps 'builder' to call initializers for the new connection and
+	// to set them as the reconnect handler of SQL connections.
+	ConnectionBuilder _with_initializers(ConnectionBuilder builder);
+
+	// Throws 'ValueError' if bounds of the pool are invalid.
+	static std::unique_ptr<IConnectionPool> _make_pool(const PoolOptions& pool_options, ConnectionBuilder builder);
+
+	std::thread _reporting_thread;
+	std::mutex _reporting_mutex;
+	std::condition_variable _reporting_condition;
+	bool _is_reporting_stopped = false;
+
+	// Wakes the reporting thread and waits until it finishes.
+	void _stop_reporting();
+
+	// Handlers which are waiting for a free connection of the pool.
+	struct Waiters
+	{
+		std::mutex mutex;
+		std::deque<ConnectionHandler> handlers;
+
+		// Checked on release of the connection without the lock.
+		std::atomic<size_t> count = 0;
+	};
+
+	Waiters _waiters;
+	Waiters _read_waiters;
+
+	// Passes a free connection of 'pool' to 'handler' or adds it
+	// to 'waiters'.
+	static void _acquire_async(IConnectionPool& pool, Waiters& waiters, ConnectionHandler handler);
+
+	// Returns 'connection' to 'pool' and serves 'waiters'.
+	static void _release(
+		IConnectionPool& pool, Waiters& waiters, const std::shared_ptr<IDatabaseConnection>& connection
+	);
+
+	// Passes free connections of 'pool' to handlers of 'waiters'.
+	static void _serve_waiters(IConnectionPool& pool, Waiters& waiters);
+
+	// Passes 'DatabaseError' to all handlers of 'waiters'.
+	static void _fail_waiters(Waiters& waiters);
 };
 
 __ORM_END__
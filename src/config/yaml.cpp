@@ -39,6 +39,69 @@ std::string _parse_scalar(const std::string& name, const YAML::Node& node)
 	return value;
 }
 
+void YAMLPoolComponent::initialize(const YAML::Node& node) const
+{
+	if (!node || node.IsNull())
+	{
+		return;
+	}
+
+	if (node.IsScalar())
+	{
+		long pool_size = 0;
+		xw::config::YAMLScalarComponent(pool_size).initialize(node);
+		if (pool_size < 1)
+		{
+			throw ImproperlyConfigured("'connections' should be positive integer", _ERROR_DETAILS_);
+		}
+
+		this->options = PoolOptions(pool_size);
+		return;
+	}
+
+	if (!node.IsMap())
+	{
+		throw ImproperlyConfigured("'connections' should be positive integer or map", _ERROR_DETAILS_);
+	}
+
+	// Negative values mark omitted keys.
+	long min_connections = (long)this->options.min_connections;
+	long max_connections = (long)this->options.max_connections;
+	long timeout = -1, idle_timeout = -1;
+	bool is_sharded = this->options.is_sharded;
+	xw::config::YAMLMapComponent component;
+	component.register_component("min", std::make_unique<xw::config::YAMLScalarComponent>(min_connections));
+	component.register_component("max", std::make_unique<xw::config::YAMLScalarComponent>(max_connections));
+	component.register_component("timeout", std::make_unique<xw::config::YAMLScalarComponent>(timeout));
+	component.register_component("idle_timeout", std::make_unique<xw::config::YAMLScalarComponent>(idle_timeout));
+	component.register_component("sharded", std::make_unique<xw::config::YAMLScalarComponent>(is_sharded));
+	component.initialize(node);
+	if (max_connections < 1)
+	{
+		throw ImproperlyConfigured("'connections.max' should be positive integer", _ERROR_DETAILS_);
+	}
+
+	if (min_connections < 0 || min_connections > max_connections)
+	{
+		throw ImproperlyConfigured(
+			"'connections.min' should be non-negative integer not greater than 'connections.max'", _ERROR_DETAILS_
+		);
+	}
+
+	this->options.min_connections = min_connections;
+	this->options.max_connections = max_connections;
+	this->options.is_sharded = is_sharded;
+	if (timeout >= 0)
+	{
+		this->options.acquire_timeout = std::chrono::milliseconds(timeout);
+	}
+
+	if (idle_timeout >= 0)
+	{
+		this->options.idle_timeout = std::chrono::milliseconds(idle_timeout);
+	}
+}
+
 void YAMLDatabasesComponent::handle_database(const std::string& dbms, const std::string& name, const YAML::Node& node)
 {
 	if (this->backends.contains(name))
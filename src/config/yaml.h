@@ -21,6 +21,9 @@
 // Module definitions.
 #include "./_def_.h"
 
+// Orm libraries.
+#include "../backend.h"
+
 
 __ORM_CONFIG_BEGIN__
 
@@ -28,6 +31,32 @@ __ORM_CONFIG_BEGIN__
 // TODO: docs for 'parse_scalar'
 extern std::string _parse_scalar(const std::string& name, const YAML::Node& node);
 
+// TESTME: YAMLPoolComponent
+// Reads options of the connection pool. The value is either the
+// number of connections of fixed-size pool or the map:
+//
+// connections:
+//   min: 1                # opened at start and never closed because of idleness
+//   max: 10               # opened on demand
+//   timeout: 5000         # milliseconds to wait for a free connection
+//   idle_timeout: 60000   # milliseconds after which idle connections are closed
+//   sharded: false        # use 'ShardedConnectionPool'
+//
+// Omitted keys keep values which are set in 'options'.
+class YAMLPoolComponent : public xw::config::YAMLComponent
+{
+public:
+	explicit inline YAMLPoolComponent(PoolOptions& options) : options(options)
+	{
+	}
+
+	// Throws 'ImproperlyConfigured' if the value is invalid.
+	void initialize(const YAML::Node& node) const override;
+
+protected:
+	PoolOptions& options;
+};
+
 // TESTME: YAMLDatabasesComponent
 // TODO: docs for 'YAMLDatabasesComponent'
 class YAMLDatabasesComponent : public xw::config::YAMLSequenceComponent
@@ -0,0 +1,334 @@
+/**
+ * coroutine.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Awaitable results of asynchronous operations.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+// Module definitions.
+#include "./_def_.h"
+
+
+__ORM_BEGIN__
+
+// Runs 'task' which resumes the awaiting coroutine, for example by
+// posting it to the thread pool of the application.
+using Executor = std::function<void(std::function<void()> /* task */)>;
+
+// Fixed number of threads which run posted tasks in order of
+// posting. Used to resume coroutines completed by event loops, so
+// the number of threads does not grow with the number of queries.
+class ThreadPool final
+{
+public:
+	// Throws 'std::system_error' if threads can not be started.
+	explicit inline ThreadPool(size_t threads_count) : _state(std::make_shared<State>())
+	{
+		this->_threads.reserve(threads_count);
+		try
+		{
+			for (size_t i = 0; i < threads_count; i++)
+			{
+				this->_threads.emplace_back([state = this->_state]() -> void { run(*state); });
+			}
+		}
+		catch (...)
+		{
+			this->stop();
+			throw;
+		}
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+
+	ThreadPool& operator= (const ThreadPool&) = delete;
+
+	// Runs tasks which are posted and stops the threads. If the pool
+	// is destroyed by its own task, the thread of this task finishes
+	// after it returns.
+	inline ~ThreadPool()
+	{
+		this->stop();
+	}
+
+	inline void post(std::function<void()> task)
+	{
+		{
+			std::lock_guard lock(this->_state->mutex);
+			this->_state->tasks.push(std::move(task));
+		}
+
+		this->_state->has_tasks.notify_one();
+	}
+
+	// Returns the executor which posts tasks to the pool. Must not
+	// be used after the pool is destroyed.
+	[[nodiscard]]
+	inline Executor executor()
+	{
+		return [this](std::function<void()> task) -> void { this->post(std::move(task)); };
+	}
+
+private:
+	// Shared with threads, so it outlives the pool which is
+	// destroyed by one of them.
+	struct State
+	{
+		std::mutex mutex;
+		std::condition_variable has_tasks;
+		std::queue<std::function<void()>> tasks;
+		bool is_stopped = false;
+	};
+
+	std::shared_ptr<State> _state;
+	std::vector<std::thread> _threads;
+
+	inline void stop()
+	{
+		{
+			std::lock_guard lock(this->_state->mutex);
+			this->_state->is_stopped = true;
+		}
+
+		this->_state->has_tasks.notify_all();
+		for (auto& thread : this->_threads)
+		{
+			if (thread.get_id() == std::this_thread::get_id())
+			{
+				thread.detach();
+			}
+			else
+			{
+				thread.join();
+			}
+		}
+	}
+
+	static inline void run(State& state)
+	{
+		while (true)
+		{
+			std::function<void()> task;
+			{
+				std::unique_lock lock(state.mutex);
+				state.has_tasks.wait(lock, [&state] { return state.is_stopped || !state.tasks.empty(); });
+				if (state.tasks.empty())
+				{
+					return;
+				}
+
+				task = std::move(state.tasks.front());
+				state.tasks.pop();
+			}
+
+			try
+			{
+				task();
+			}
+			catch (...)
+			{
+				// Tasks report errors by themselves, the thread
+				// keeps running other tasks.
+			}
+		}
+	}
+};
+
+// Returns the executor which is set by threads running event loops,
+// like the reactor, empty on other threads. Coroutines completed on
+// such threads are resumed through it, because the code after
+// 'co_await' can block and stall I/O of all connections which share
+// the loop.
+inline Executor& event_loop_executor()
+{
+	thread_local Executor value;
+	return value;
+}
+
+// Executor which resumes coroutines awaiting 'Awaitable' without
+// their own executor, check 'Awaitable::via'. Should be set once on
+// startup, before the first 'co_await'.
+class DefaultExecutor final
+{
+public:
+	static inline void set(Executor executor)
+	{
+		std::lock_guard lock(_mutex);
+		_executor = std::move(executor);
+	}
+
+	[[nodiscard]]
+	static inline Executor get()
+	{
+		std::lock_guard lock(_mutex);
+		return _executor;
+	}
+
+private:
+	static inline std::mutex _mutex;
+	static inline Executor _executor;
+};
+
+// Result of the asynchronous operation which can be awaited by any
+// coroutine. The operation is started when the object is created,
+// so it does not depend on objects which built it.
+//
+// The awaiting coroutine is resumed through the executor which is
+// passed to 'via', or 'DefaultExecutor' if it is not passed. Without
+// both of them the coroutine is resumed by the thread which completes
+// the operation: the thread which returns a connection for the pool
+// or the awaiting thread itself if the operation completes
+// immediately. If the operation is completed by the event loop, like
+// the reactor thread for asynchronous queries, the coroutine is
+// resumed through the executor of the loop instead, check
+// 'event_loop_executor'.
+template <typename T=void>
+class Awaitable final
+{
+public:
+	using value_type = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+	// Must be called exactly once with the value or the error.
+	using result_handler = std::function<void(value_type /* value */, std::exception_ptr /* error */)>;
+
+	// Calls 'start' with the handler of the result. Errors thrown
+	// by 'start' are rethrown by 'co_await'.
+	explicit inline Awaitable(const std::function<void(result_handler /* handler */)>& start) :
+		_state(std::make_shared<State>())
+	{
+		auto handler = [state = this->_state](value_type value, std::exception_ptr error) -> void {
+			if (state->is_completed.exchange(true))
+			{
+				return;
+			}
+
+			if (error)
+			{
+				state->error = error;
+			}
+			else
+			{
+				state->value.emplace(std::move(value));
+			}
+
+			// The coroutine is resumed only if it was suspended
+			// before the result was set.
+			if (state->is_ready.exchange(true))
+			{
+				resume(*state);
+			}
+		};
+
+		try
+		{
+			start(handler);
+		}
+		catch (...)
+		{
+			handler(value_type{}, std::current_exception());
+		}
+	}
+
+	Awaitable(Awaitable&&) noexcept = default;
+
+	Awaitable(const Awaitable&) = delete;
+
+	Awaitable& operator= (const Awaitable&) = delete;
+
+	// Resumes the awaiting coroutine through 'executor'. Must be
+	// called before 'co_await', for example:
+	//   co_await query.co_all().via(executor);
+	inline Awaitable&& via(Executor executor) &&
+	{
+		this->_state->executor = std::move(executor);
+		return std::move(*this);
+	}
+
+	[[nodiscard]]
+	inline bool await_ready() const noexcept
+	{
+		return this->_state->is_ready.load();
+	}
+
+	inline bool await_suspend(std::coroutine_handle<> coroutine) noexcept
+	{
+		this->_state->coroutine = coroutine;
+
+		// If the result was set in the meantime, the coroutine
+		// continues without suspension.
+		return !this->_state->is_ready.exchange(true);
+	}
+
+	inline T await_resume()
+	{
+		if (this->_state->error)
+		{
+			std::rethrow_exception(this->_state->error);
+		}
+
+		if constexpr (!std::is_void_v<T>)
+		{
+			return std::move(this->_state->value.value());
+		}
+	}
+
+private:
+	struct State
+	{
+		std::optional<value_type> value;
+
+		std::exception_ptr error = nullptr;
+
+		std::coroutine_handle<> coroutine = nullptr;
+
+		// Set by 'via' before the coroutine is suspended.
+		Executor executor;
+
+		std::atomic<bool> is_completed = false;
+
+		// Set by the first of: the result is set or the
+		// coroutine is suspended.
+		std::atomic<bool> is_ready = false;
+	};
+
+	std::shared_ptr<State> _state;
+
+	static inline void resume(const State& state)
+	{
+		auto coroutine = state.coroutine;
+		auto executor = state.executor ? state.executor : DefaultExecutor::get();
+		if (!executor)
+		{
+			executor = event_loop_executor();
+		}
+
+		if (executor)
+		{
+			executor([coroutine]() -> void { coroutine.resume(); });
+		}
+		else
+		{
+			coroutine.resume();
+		}
+	}
+};
+
+__ORM_END__
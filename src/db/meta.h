@@ -8,6 +8,17 @@
 
 #pragma once
 
+// C++ libraries.
+#include <cctype>
+#include <charconv>
+#include <list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 // Base libraries.
 #include <xalwart.base/utility.h>
 
@@ -15,18 +26,22 @@
 #include "./_def_.h"
 
 // Orm libraries.
+#include "./parameter.h"
+#include "./value.h"
 #include "../exceptions.h"
 #include "../utility.h"
 
 
 __ORM_DB_BEGIN__
 
-// TESTME: get_pk_name
-// TODO: docs for 'get_pk_name'
+// TESTME: find_pk_name
+// Returns name of the primary key column or empty view if the model
+// has not it. Can be evaluated at compile time when 'meta_columns'
+// is declared as 'constexpr'.
 template <typename ModelT>
-inline std::string get_pk_name()
+inline constexpr std::string_view find_pk_name()
 {
-	std::string result;
+	std::string_view result;
 	util::tuple_for_each(ModelT::meta_columns, [&result](auto& column)
 	{
 		if (column.is_pk)
@@ -40,6 +55,68 @@ inline std::string get_pk_name()
 	return result;
 }
 
+// TESTME: find_column_name
+// Returns name of the column mapped to 'member_pointer' or empty
+// view if the member is not mapped. Only columns with the type of
+// 'member_pointer' are compared, others are skipped at compile time.
+// Can be evaluated at compile time when 'meta_columns' is declared
+// as 'constexpr'.
+template <typename F, typename O>
+inline constexpr std::string_view find_column_name(F O::* member_pointer)
+{
+	std::string_view name;
+	util::tuple_for_each(O::meta_columns, [&name, member_pointer](auto& column)
+	{
+		if constexpr (std::is_same_v<std::remove_cvref_t<decltype(column.member_pointer)>, F O::*>)
+		{
+			if (column.member_pointer == member_pointer)
+			{
+				name = column.name;
+				return false;
+			}
+		}
+
+		return true;
+	});
+	return name;
+}
+
+// TESTME: find_column_index
+// Returns position of the column mapped to 'member_pointer' in
+// 'meta_columns' or nothing if the member is not mapped. Acts like
+// 'find_column_name' otherwise.
+template <typename F, typename O>
+inline constexpr std::optional<size_t> find_column_index(F O::* member_pointer)
+{
+	size_t index = 0;
+	std::optional<size_t> result;
+	util::tuple_for_each(O::meta_columns, [&index, &result, member_pointer](auto& column)
+	{
+		if constexpr (std::is_same_v<std::remove_cvref_t<decltype(column.member_pointer)>, F O::*>)
+		{
+			if (column.member_pointer == member_pointer)
+			{
+				result = index;
+				return false;
+			}
+		}
+
+		index++;
+		return true;
+	});
+	return result;
+}
+
+// TESTME: get_pk_name
+// Returns name of the primary key column or empty string if the
+// model has not it. The name is copied once per model.
+template <typename ModelT>
+inline const std::string& get_pk_name()
+{
+	static const std::string pk_name(find_pk_name<ModelT>());
+	return pk_name;
+}
+
 // TESTME: make_fk
 // TODO: docs for 'make_fk'
 template <typename ModelT>
@@ -52,7 +129,7 @@ inline std::string make_fk()
 		table_name = table_name.substr(0, table_name.size() - 1);
 	}
 
-	auto pk_name = get_pk_name<ModelT>();
+	const auto& pk_name = get_pk_name<ModelT>();
 	if (pk_name.empty())
 	{
 		throw QueryError("make_fk: model requires pk column", _ERROR_DETAILS_);
@@ -61,38 +138,107 @@ inline std::string make_fk()
 	return table_name + "_" + pk_name;
 }
 
+// Returns names of columns of the model in the order of
+// 'meta_columns', quoted if 'quote' is true. Both lists are built
+// once per model.
+template <typename ModelT>
+inline const std::vector<std::string>& get_indexed_column_names(bool quote)
+{
+	static const std::pair<std::vector<std::string>, std::vector<std::string>> names = []
+	{
+		std::pair<std::vector<std::string>, std::vector<std::string>> result;
+		util::tuple_for_each(ModelT::meta_columns, [&result](auto& column)
+		{
+			result.first.emplace_back(column.name);
+			result.second.push_back(util::quote_str(std::string(column.name)));
+		});
+		return result;
+	}();
+	return quote ? names.second : names.first;
+}
+
 // TESTME: get_column_name
-// TODO: docs for 'get_column_name'
+// Returns name of the column mapped to 'member_pointer', quoted
+// if 'quote' is true. Names are built once per model, so only the
+// position of the column is searched. Use the overload below if the
+// member is known at compile time.
+//
+// Throws 'ValueError' if the member is not mapped to the column.
 template <typename F, typename O>
-inline std::string get_column_name(F O::* member_pointer, bool quote=false)
+inline const std::string& get_column_name(F O::* member_pointer, bool quote=false)
 {
-	std::string name;
-	util::tuple_for_each(O::meta_columns, [&name, member_pointer](auto& column)
+	auto index = find_column_index(member_pointer);
+	if (!index.has_value())
 	{
-		if (util::compare_any(column.member_pointer, member_pointer))
-		{
-			name = column.name;
-			return false;
-		}
+		throw ValueError("column not found", _ERROR_DETAILS_);
+	}
 
-		return true;
-	});
+	return get_indexed_column_names<O>(quote)[index.value()];
+}
 
-	if (name.empty())
+// Splits the type of pointer to the member into types of the model
+// and of the field.
+template <typename T>
+struct member_pointer_traits;
+
+template <typename F, typename O>
+struct member_pointer_traits<F O::*>
+{
+	using model_type = O;
+	using field_type = F;
+};
+
+// Acts like 'get_column_name' above, but the column is found at
+// compile time and both names are built once per member.
+template <auto member_pointer>
+requires std::is_member_object_pointer_v<decltype(member_pointer)>
+inline const std::string& get_column_name(bool quote=false)
+{
+	static constexpr std::string_view name = find_column_name(member_pointer);
+	static_assert(!name.empty(), "member is not mapped to the column");
+	if (quote)
 	{
-		throw ValueError("column not found", _ERROR_DETAILS_);
+		static const std::string quoted_name = util::quote_str(std::string(name));
+		return quoted_name;
 	}
 
-	return quote ? util::quote_str(name) : name;
+	static const std::string column_name(name);
+	return column_name;
 }
 
 // TESTME: get_table_name
-// TODO: docs for 'get_table_name'
+// Returns name of the table of the model, quoted if 'quote' is
+// true. Both names are built once per model.
 template <typename ModelT>
-inline std::string get_table_name(bool quote=false)
+inline const std::string& get_table_name(bool quote=false)
 {
 	static_assert(ModelT::meta_table_name != nullptr, "'meta_table_name' is not initialized");
-	return quote ? util::quote_str(ModelT::meta_table_name) : ModelT::meta_table_name;
+	if (quote)
+	{
+		static const std::string quoted_name = util::quote_str(ModelT::meta_table_name);
+		return quoted_name;
+	}
+
+	static const std::string table_name = ModelT::meta_table_name;
+	return table_name;
+}
+
+// TESTME: get_column_names
+// Returns names of all mapped columns in the order of 'meta_columns'.
+// The list is built once per model.
+template <typename ModelT>
+inline const std::list<std::string>& get_column_names()
+{
+	static const std::list<std::string> names = []
+	{
+		std::list<std::string> result;
+		util::tuple_for_each(ModelT::meta_columns, [&result](auto& column)
+		{
+			result.emplace_back(column.name);
+		});
+		return result;
+	}();
+	return names;
 }
 
 template <typename T>
@@ -103,54 +249,77 @@ concept column_field_type = std::is_fundamental_v<T> ||
 	std::is_same_v<dt::Time, T> ||
 	std::is_same_v<dt::Datetime, T>;
 
-// TESTME: ColumnMeta
-// TODO: docs for 'ColumnMeta'
-template <typename ModelT, column_field_type FieldT>
-struct ColumnMeta
-{
-	using field_type = FieldT;
-	using model_type = ModelT;
+// Default layouts are ISO-8601, so they are parsed and formatted
+// without 'strptime' and 'strftime'.
+inline static const char* DEFAULT_DATE_FORMAT = util::ISO_DATE_FORMAT;
+inline static const char* DEFAULT_TIME_FORMAT = util::ISO_TIME_FORMAT;
+inline static const char* DEFAULT_DATETIME_FORMAT = util::ISO_DATETIME_FORMAT;
 
-	std::string name;
-	bool is_pk = false;
-
-	FieldT ModelT::* member_pointer;
-
-	using field_builder_type = std::function<FieldT(const void*)>;
-	using string_builder_type = std::function<std::string(const ModelT&)>;
-
-	field_builder_type as_field = nullptr;
-	string_builder_type as_string = nullptr;
-
-	ColumnMeta() = default;
-
-	ColumnMeta(
-		std::string name, FieldT ModelT::* member_ptr, bool is_pk,
-		field_builder_type field_builder, string_builder_type string_builder
-	) : name(std::move(name)), member_pointer(member_ptr), is_pk(is_pk),
-		as_field(std::move(field_builder)), as_string(string_builder)
+// Fields which are parsed from text by 'text_as_field' without
+// copying. Characters are excluded, because they are read as is.
+template <typename T>
+concept text_parsed_field_type = std::is_same_v<T, std::string> || std::is_same_v<T, bool> || (
+	std::is_arithmetic_v<T> && !std::is_same_v<T, char> && !std::is_same_v<T, signed char> &&
+	!std::is_same_v<T, unsigned char> && !std::is_same_v<T, wchar_t> && !std::is_same_v<T, char8_t> &&
+	!std::is_same_v<T, char16_t> && !std::is_same_v<T, char32_t>
+);
+
+// TESTME: text_as_field
+// Parses text of the column in place with 'std::from_chars', so the
+// text does not need to be null-terminated and is never copied. Like
+// stream extraction, trailing characters after the number are ignored.
+// Booleans are accepted as numbers or as 't' and 'true'.
+//
+// Throws 'ValueError' if text does not start with a number.
+template <text_parsed_field_type FieldT>
+FieldT text_as_field(std::string_view text)
+{
+	if constexpr (std::is_same_v<FieldT, std::string>)
 	{
+		return std::string(text);
 	}
-
-	ColumnMeta(const ColumnMeta& other)
+	else if constexpr (std::is_same_v<FieldT, bool>)
 	{
-		if (this != &other)
+		if (text == "t" || text == "true")
+		{
+			return true;
+		}
+
+		if (text == "f" || text == "false")
 		{
-			this->name = other.name;
-			this->is_pk = other.is_pk;
-			this->member_pointer = other.member_pointer;
-			this->as_field = other.as_field;
-			this->as_string = other.as_string;
+			return false;
 		}
+
+		return text_as_field<long long>(text) != 0;
 	}
-};
+	else
+	{
+		auto begin = text.data(), end = text.data() + text.size();
+		while (begin != end && std::isspace((unsigned char)*begin))
+		{
+			begin++;
+		}
 
-inline static const char* DEFAULT_DATE_FORMAT = "%Y-%m-%d";
-inline static const char* DEFAULT_TIME_FORMAT = "%H:%M:%S";
-inline static const char* DEFAULT_DATETIME_FORMAT = "%Y-%m-%d %H:%M:%S";
+		// 'std::from_chars' does not accept leading plus.
+		if (begin != end && *begin == '+')
+		{
+			begin++;
+		}
+
+		FieldT field{};
+		auto result = std::from_chars(begin, end, field);
+		if (result.ec != std::errc())
+		{
+			throw ValueError("'" + std::string(text) + "' can not be parsed as number", _ERROR_DETAILS_);
+		}
+
+		return field;
+	}
+}
 
 // TESTME: column_as_field
-// TODO: docs for 'column_as_field'
+// Converts raw null-terminated column data to the field. Numbers and
+// strings are parsed by 'text_as_field'.
 template <column_field_type FieldT>
 FieldT column_as_field(const void* data)
 {
@@ -166,8 +335,124 @@ FieldT column_as_field(const void* data)
 	{
 		return util::as_datetime(data, DEFAULT_DATETIME_FORMAT);
 	}
+	else if constexpr (text_parsed_field_type<FieldT>)
+	{
+		return text_as_field<FieldT>((const char*)data);
+	}
+	else
+	{
+		return xw::util::as<FieldT>(data);
+	}
+}
 
-	return xw::util::as<FieldT>(data);
+// TESTME: value_as_field
+// Converts value which was decoded by the driver to the field.
+// Text is parsed like raw column data by 'column_as_field', numbers
+// and strings are parsed without copying of the text.
+//
+// Throws 'TypeError' if value can not be converted to the field.
+template <column_field_type FieldT>
+FieldT value_as_field(const Value& value)
+{
+	if (auto text = std::get_if<std::string_view>(&value.value))
+	{
+		if constexpr (text_parsed_field_type<FieldT>)
+		{
+			return text_as_field<FieldT>(*text);
+		}
+		else if constexpr (std::is_same_v<FieldT, dt::Date>)
+		{
+			return util::as_date(*text, DEFAULT_DATE_FORMAT);
+		}
+		else if constexpr (std::is_same_v<FieldT, dt::Time>)
+		{
+			return util::as_time(*text, DEFAULT_TIME_FORMAT);
+		}
+		else if constexpr (std::is_same_v<FieldT, dt::Datetime>)
+		{
+			return util::as_datetime(*text, DEFAULT_DATETIME_FORMAT);
+		}
+		else
+		{
+			auto data = std::string(*text);
+			return column_as_field<FieldT>(data.c_str());
+		}
+	}
+
+	if constexpr (std::is_arithmetic_v<FieldT>)
+	{
+		if (auto integer = std::get_if<long long>(&value.value))
+		{
+			return (FieldT)*integer;
+		}
+
+		if (auto real = std::get_if<double>(&value.value))
+		{
+			return (FieldT)*real;
+		}
+	}
+	else if constexpr (std::is_same_v<FieldT, std::string>)
+	{
+		if (auto integer = std::get_if<long long>(&value.value))
+		{
+			return std::to_string(*integer);
+		}
+
+		if (auto real = std::get_if<double>(&value.value))
+		{
+			char buffer[32];
+			auto result = std::to_chars(buffer, buffer + sizeof(buffer), *real);
+			return {buffer, result.ptr};
+		}
+
+		if (auto date = std::get_if<dt::Date>(&value.value))
+		{
+			return util::format_date(*date, DEFAULT_DATE_FORMAT);
+		}
+
+		if (auto time = std::get_if<dt::Time>(&value.value))
+		{
+			return util::format_time(*time, DEFAULT_TIME_FORMAT);
+		}
+
+		if (auto datetime = std::get_if<dt::Datetime>(&value.value))
+		{
+			return util::format_datetime(*datetime, DEFAULT_DATETIME_FORMAT);
+		}
+	}
+	else if constexpr (std::is_same_v<FieldT, dt::Date>)
+	{
+		if (auto date = std::get_if<dt::Date>(&value.value))
+		{
+			return *date;
+		}
+
+		if (auto datetime = std::get_if<dt::Datetime>(&value.value))
+		{
+			return datetime->date();
+		}
+	}
+	else if constexpr (std::is_same_v<FieldT, dt::Time>)
+	{
+		if (auto time = std::get_if<dt::Time>(&value.value))
+		{
+			return *time;
+		}
+
+		if (auto datetime = std::get_if<dt::Datetime>(&value.value))
+		{
+			return datetime->time();
+		}
+	}
+	else if constexpr (std::is_same_v<FieldT, dt::Datetime>)
+	{
+		if (auto datetime = std::get_if<dt::Datetime>(&value.value))
+		{
+			return *datetime;
+		}
+	}
+
+	throw TypeError("value can not be converted to the type of the field", _ERROR_DETAILS_);
 }
 
 // TESTME: field_as_column_v
@@ -189,46 +474,124 @@ std::string field_as_column_v(const FieldT& field)
 	}
 	else if constexpr (std::is_same_v<FieldT, dt::Date>)
 	{
-		return "'" + field.strftime(DEFAULT_DATE_FORMAT) + "'";
+		return "'" + util::format_date(field, DEFAULT_DATE_FORMAT) + "'";
 	}
 	else if constexpr (std::is_same_v<FieldT, dt::Time>)
 	{
-		return "'" + field.strftime(DEFAULT_TIME_FORMAT) + "'";
+		return "'" + util::format_time(field, DEFAULT_TIME_FORMAT) + "'";
 	}
 	else if constexpr (std::is_same_v<FieldT, dt::Datetime>)
 	{
-		return "'" + field.strftime(DEFAULT_DATETIME_FORMAT) + "'";
+		return "'" + util::format_datetime(field, DEFAULT_DATETIME_FORMAT) + "'";
 	}
 
 	return "";
 }
 
-// TESTME: make_column_meta
-// TODO: docs for 'make_column_meta'
+// TESTME: field_as_parameter
+// Converts field value to typed parameter which can be
+// bound to SQL statement.
+template <column_field_type FieldT>
+Parameter field_as_parameter(const FieldT& field)
+{
+	if constexpr (std::is_floating_point_v<FieldT>)
+	{
+		return Parameter((double)field);
+	}
+	else if constexpr (std::is_arithmetic_v<FieldT>)
+	{
+		return Parameter((long long)field);
+	}
+	else if constexpr (std::is_same_v<FieldT, std::string>)
+	{
+		return Parameter(field);
+	}
+	else if constexpr (std::is_same_v<FieldT, const char*>)
+	{
+		return field ? Parameter(std::string(field)) : Parameter();
+	}
+	else if constexpr (std::is_same_v<FieldT, dt::Date>)
+	{
+		return Parameter(util::format_date(field, DEFAULT_DATE_FORMAT));
+	}
+	else if constexpr (std::is_same_v<FieldT, dt::Time>)
+	{
+		return Parameter(util::format_time(field, DEFAULT_TIME_FORMAT));
+	}
+	else if constexpr (std::is_same_v<FieldT, dt::Datetime>)
+	{
+		return Parameter(util::format_datetime(field, DEFAULT_DATETIME_FORMAT));
+	}
+
+	return Parameter();
+}
+
+// TESTME: ColumnMeta
+// Describes the column mapped to 'member_pointer' of 'ModelT'.
+// Conversions are chosen at compile time from 'FieldT', so calls
+// of 'as_field', 'as_string' and 'as_parameter' are inlined into
+// loops over 'meta_columns' instead of going through type-erased
+// functions.
+//
+// 'name' refers to the string literal, so column metadata of the
+// model can be declared as 'constexpr'.
 template <typename ModelT, column_field_type FieldT>
-inline ColumnMeta<ModelT, FieldT> make_column_meta(
-	const std::string& name, FieldT ModelT::* member_ptr, bool is_pk=false
+struct ColumnMeta
+{
+	using field_type = FieldT;
+	using model_type = ModelT;
+
+	std::string_view name;
+	bool is_pk = false;
+
+	FieldT ModelT::* member_pointer = nullptr;
+
+	ColumnMeta() = default;
+
+	inline constexpr ColumnMeta(std::string_view name, FieldT ModelT::* member_ptr, bool is_pk) :
+		name(name), is_pk(is_pk), member_pointer(member_ptr)
+	{
+	}
+
+	// Parses raw column data received from the driver.
+	[[nodiscard]]
+	inline FieldT as_field(const void* data) const
+	{
+		return column_as_field<FieldT>(data);
+	}
+
+	// Returns field of 'model' as SQL literal.
+	[[nodiscard]]
+	inline std::string as_string(const ModelT& model) const
+	{
+		return field_as_column_v(model.*this->member_pointer);
+	}
+
+	// Returns field of 'model' as parameter of SQL statement.
+	[[nodiscard]]
+	inline Parameter as_parameter(const ModelT& model) const
+	{
+		return field_as_parameter(model.*this->member_pointer);
+	}
+};
+
+// TESTME: make_column_meta
+// Describes the column of the model. Only string literals are
+// accepted as 'name', because metadata does not own it.
+template <typename ModelT, column_field_type FieldT, size_t N>
+inline constexpr ColumnMeta<ModelT, FieldT> make_column_meta(
+	const char (&name)[N], FieldT ModelT::* member_ptr, bool is_pk=false
 )
 {
-	return ColumnMeta<ModelT, FieldT>(
-		name, member_ptr, is_pk,
-		[](const void* data) -> FieldT
-		{
-			return column_as_field<FieldT>(data);
-		},
-		[member_ptr](const ModelT& model) -> std::string
-		{
-			return field_as_column_v(model.*member_ptr);
-		}
-	);
+	return ColumnMeta<ModelT, FieldT>(std::string_view(name, N - 1), member_ptr, is_pk);
 }
 
 // TESTME: make_pk_column_meta
 // TODO: docs for 'make_pk_column_meta'
-template <typename ModelT, typename FieldT>
-inline ColumnMeta<ModelT, FieldT> make_pk_column_meta(const std::string& name, FieldT ModelT::* member_ptr)
+template <typename ModelT, typename FieldT, size_t N>
+inline constexpr ColumnMeta<ModelT, FieldT> make_pk_column_meta(const char (&name)[N], FieldT ModelT::* member_ptr)
 {
-	return make_column_meta<ModelT, FieldT>(name, member_ptr, true);
+	return make_column_meta(name, member_ptr, true);
 }
 
 __ORM_DB_END__
@@ -11,7 +11,10 @@
 // C++ libraries.
 #include <map>
 #include <string>
+#include <string_view>
 #include <sstream>
+#include <vector>
+#include <utility>
 
 // Base libraries.
 #include <xalwart.base/exceptions.h>
@@ -27,16 +30,34 @@
 
 // Orm libraries.
 #include "./meta.h"
+#include "./row.h"
 
 
 __ORM_DB_BEGIN__
 
+class Model;
+
+// Used in templates where Model-based class is required.
+template <typename T>
+concept model_based_type = std::is_base_of_v<Model, T> && std::is_default_constructible_v<T>;
+
+template <typename T>
+concept model_based_iterator = std::is_base_of_v<Model, iterator_v_type<T>> &&
+	std::is_default_constructible_v<iterator_v_type<T>>;
+
+template <model_based_type ModelT>
+class RowHydrator;
+
 // !IMPORTANT!
 // Model supports single pk only!
 // TESTME: Model
 // TODO: docs for 'Model'
 class Model : public xw::IStringSerializable
 {
+	// Passes unmapped columns to '__orm_set_column__'.
+	template <model_based_type ModelT>
+	friend class RowHydrator;
+
 public:
 	// Must be overwritten in child class.
 	static constexpr const char* meta_table_name = nullptr;
@@ -154,15 +175,25 @@ protected:
 	)
 	{
 		bool is_set = false;
-		util::tuple_for_each(columns, [this, column_name, data, &is_set](auto& column)
+		util::tuple_for_each(columns, [this, &column_name, data, &is_set](auto& column)
 		{
 			if (column.name == column_name)
 			{
 				using column_type = typename std::remove_reference<decltype(column)>::type;
 				using model_type = typename column_type::model_type;
-				size_t len = std::strlen(data);
-				std::string str_val = {data, data + len + 1};
-				((model_type*)this)->*column.member_pointer = column.as_field(str_val.c_str());
+				auto& field = ((model_type*)this)->*column.member_pointer;
+
+				// Data is parsed in place, strings are copied straight
+				// into the field reusing its memory.
+				if constexpr (std::is_same_v<typename column_type::field_type, std::string>)
+				{
+					field.assign(data);
+				}
+				else
+				{
+					field = column.as_field(data);
+				}
+
 				is_set = true;
 				return false;
 			}
@@ -194,12 +225,192 @@ private:
 	}
 };
 
-// Used in templates where Model-based class is required.
-template <typename T>
-concept model_based_type = std::is_base_of_v<Model, T> && std::is_default_constructible_v<T>;
+// TESTME: ColumnSetters
+// Dispatch table of 'ModelT' which maps names of columns to typed
+// setters of fields. It is built from 'meta_columns' once per model
+// type, so hydration does not walk the columns tuple for each field.
+template <model_based_type ModelT>
+class ColumnSetters final
+{
+public:
+	// Assigns the value which was decoded by the driver to the field.
+	using setter_type = void(*)(ModelT& /* model */, const Value& /* value */);
 
-template <typename T>
-concept model_based_iterator = std::is_base_of_v<Model, iterator_v_type<T>> &&
-	std::is_default_constructible_v<iterator_v_type<T>>;
+	// Assigns the value of the field of default constructed model.
+	using resetter_type = void(*)(ModelT& /* model */);
+
+	// Returns setter of the column with 'name' or nullptr if the column
+	// is not mapped to the model.
+	[[nodiscard]]
+	static inline setter_type find(std::string_view name)
+	{
+		auto* entry = find_entry(name);
+		return entry ? entry->setter : nullptr;
+	}
+
+	// Returns resetter of the column with 'name' or nullptr if the
+	// column is not mapped to the model.
+	[[nodiscard]]
+	static inline resetter_type find_resetter(std::string_view name)
+	{
+		auto* entry = find_entry(name);
+		return entry ? entry->resetter : nullptr;
+	}
+
+private:
+	using columns_type = std::remove_cvref_t<decltype(ModelT::meta_columns)>;
+
+	struct Entry
+	{
+		std::string_view name;
+		setter_type setter;
+		resetter_type resetter;
+	};
+
+	static inline const Entry* find_entry(std::string_view name)
+	{
+		for (const auto& entry : table())
+		{
+			if (entry.name == name)
+			{
+				return &entry;
+			}
+		}
+
+		return nullptr;
+	}
+
+	static inline const std::vector<Entry>& table()
+	{
+		static const auto setters = make_table(std::make_index_sequence<std::tuple_size_v<columns_type>>());
+		return setters;
+	}
+
+	template <size_t ...Indices>
+	static inline std::vector<Entry> make_table(std::index_sequence<Indices...>)
+	{
+		return {{std::get<Indices>(ModelT::meta_columns).name, &set<Indices>, &reset<Indices>}...};
+	}
+
+	template <size_t Index>
+	static void set(ModelT& model, const Value& value)
+	{
+		const auto& column = std::get<Index>(ModelT::meta_columns);
+		using field_type = typename std::remove_cvref_t<decltype(column)>::field_type;
+		model.*column.member_pointer = value_as_field<field_type>(value);
+	}
+
+	// Fields are assigned rather than replaced, so strings keep
+	// their memory.
+	template <size_t Index>
+	static void reset(ModelT& model)
+	{
+		static const ModelT defaults{};
+		const auto& column = std::get<Index>(ModelT::meta_columns);
+		model.*column.member_pointer = defaults.*column.member_pointer;
+	}
+};
+
+// Sets fields of models from rows of the result set. Columns of the
+// result are bound to setters of 'ColumnSetters' when the first row
+// arrives, so the rest rows cost one indirect call per column. Rows
+// of the same result set share 'Columns', which is detected by its
+// generation, and the hydrator is bound again when it changes, even
+// if the driver reuses the same 'Columns' object for the next result
+// set of a multi-statement query.
+template <model_based_type ModelT>
+class RowHydrator final
+{
+public:
+	// If 'is_resetting_nulls' is true, fields of mapped columns which
+	// are NULL in the row get values of default constructed model, so
+	// the same model can be hydrated from each row of the result.
+	explicit RowHydrator(bool is_resetting_nulls=false) : _is_resetting_nulls(is_resetting_nulls)
+	{
+	}
+
+	// Acts like 'Model::from_map', but sets fields from the row with
+	// values which were decoded by the driver, so numbers and dates are
+	// not parsed from text again. NULL values are skipped or reset,
+	// check the constructor. Columns which are not mapped by
+	// 'meta_columns' are passed as text to 'Model::__orm_set_column__',
+	// so models are able to handle extra or computed columns there.
+	//
+	// Throws 'AttributeError' if '__orm_set_column__' does not know
+	// the column.
+	inline void operator() (ModelT& model, const Row& row)
+	{
+		if (row.columns().generation() != this->_generation || !this->_is_bound)
+		{
+			this->bind(row.columns());
+		}
+
+		auto setters = this->_setters.data();
+		for (size_t i = 0; i < this->_setters.size(); i++)
+		{
+			const auto& value = row[i];
+			if (value.is_null())
+			{
+				if (this->_is_resetting_nulls && this->_resetters[i])
+				{
+					this->_resetters[i](model);
+				}
+
+				continue;
+			}
+
+			if (setters[i])
+			{
+				setters[i](model, value);
+			}
+			else
+			{
+				static_cast<Model&>(model).__orm_set_column__(
+					row.name(i), value_as_field<std::string>(value).c_str()
+				);
+			}
+		}
+	}
+
+	// Resolves setters and resetters for 'columns' in the order of the
+	// result. Columns which are not mapped by 'meta_columns' get nullptr.
+	inline void bind(const Columns& columns)
+	{
+		this->_is_bound = false;
+		this->_setters.resize(columns.size());
+		if (this->_is_resetting_nulls)
+		{
+			this->_resetters.resize(columns.size());
+		}
+
+		for (size_t i = 0; i < columns.size(); i++)
+		{
+			this->_setters[i] = ColumnSetters<ModelT>::find(columns.name(i));
+			if (this->_is_resetting_nulls)
+			{
+				this->_resetters[i] = ColumnSetters<ModelT>::find_resetter(columns.name(i));
+			}
+		}
+
+		this->_generation = columns.generation();
+		this->_is_bound = true;
+	}
+
+private:
+	bool _is_resetting_nulls;
+	std::uint64_t _generation = 0;
+	bool _is_bound = false;
+	std::vector<typename ColumnSetters<ModelT>::setter_type> _setters;
+	std::vector<typename ColumnSetters<ModelT>::resetter_type> _resetters;
+};
+
+// Sets fields of the single row, check 'RowHydrator' for details.
+// Use 'RowHydrator' directly when rows of the same result set are
+// read one after another.
+template <model_based_type ModelT>
+inline void from_row(ModelT& model, const Row& row)
+{
+	RowHydrator<ModelT>()(model, row);
+}
 
 __ORM_DB_END__
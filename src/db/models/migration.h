@@ -27,7 +27,7 @@ public:
 
 	static constexpr const char* meta_table_name = "xalwart_migrations";
 
-	inline static const std::tuple meta_columns = {
+	inline static constexpr std::tuple meta_columns = {
 		make_pk_column_meta("id", &Migration::id),
 		make_column_meta("name", &Migration::name),
 		make_column_meta("applied", &Migration::applied)
@@ -0,0 +1,101 @@
+/**
+ * db/parameter.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Typed value of SQL statement parameter.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <string>
+#include <variant>
+#include <charconv>
+
+// Module definitions.
+#include "./_def_.h"
+
+
+__ORM_DB_BEGIN__
+
+// Value which is bound to a placeholder of SQL statement instead
+// of being inlined into the query text.
+//
+// Integral and boolean fields are stored as 'long long', floating
+// point fields as 'double', other fields as text. Default-constructed
+// parameter is SQL 'NULL'.
+struct Parameter final
+{
+	using value_type = std::variant<std::nullptr_t, long long, double, std::string>;
+
+	value_type value = nullptr;
+
+	Parameter() = default;
+
+	inline explicit Parameter(value_type value) : value(std::move(value))
+	{
+	}
+
+	[[nodiscard]]
+	inline bool is_null() const
+	{
+		return std::holds_alternative<std::nullptr_t>(this->value);
+	}
+
+	// Returns text representation of the value which is used when
+	// the driver accepts parameters as strings. Returns an empty
+	// string for 'NULL'.
+	[[nodiscard]]
+	inline std::string to_string() const
+	{
+		if (auto integer = std::get_if<long long>(&this->value))
+		{
+			return std::to_string(*integer);
+		}
+
+		if (auto real = std::get_if<double>(&this->value))
+		{
+			char buffer[32];
+			auto result = std::to_chars(buffer, buffer + sizeof(buffer), *real);
+			return {buffer, result.ptr};
+		}
+
+		if (auto text = std::get_if<std::string>(&this->value))
+		{
+			return *text;
+		}
+
+		return "";
+	}
+
+	// Returns the value as SQL literal to be inlined into the
+	// query text. Text is wrapped in single quotes.
+	[[nodiscard]]
+	inline std::string to_literal() const
+	{
+		if (auto integer = std::get_if<long long>(&this->value))
+		{
+			return std::to_string(*integer);
+		}
+
+		if (auto real = std::get_if<double>(&this->value))
+		{
+			return std::to_string(*real);
+		}
+
+		if (auto text = std::get_if<std::string>(&this->value))
+		{
+			return "'" + *text + "'";
+		}
+
+		return "NULL";
+	}
+
+	inline bool operator== (const Parameter& other) const
+	{
+		return this->value == other.value;
+	}
+};
+
+__ORM_DB_END__
@@ -70,7 +70,7 @@ public:
 	) const
 	{
 		this->ensure_schema(connection);
-		this->migrations(connection).where(q::c(&models::Migration::name) == name).delete_();
+		this->migrations(connection).where(q::c<&models::Migration::name>() == name).delete_();
 	}
 
 	// Deletes all migration records.
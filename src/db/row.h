@@ -0,0 +1,154 @@
+/**
+ * db/row.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Lightweight view of the result row.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+
+// Module definitions.
+#include "./_def_.h"
+
+// Orm libraries.
+#include "./value.h"
+
+
+__ORM_DB_BEGIN__
+
+// Names of columns of the result set. It is built once per result
+// set and is shared by all its rows.
+//
+// Each built instance gets a unique generation which is kept by its
+// copies, so consumers which cache per-layout data detect the change
+// of the result set even if the driver reuses the same object.
+class Columns final
+{
+public:
+	static constexpr size_t npos = (size_t)-1;
+
+	Columns() = default;
+
+	// 'rows_count' is the number of rows of the result set if the
+	// driver knows it before the rows are read, 'npos' otherwise.
+	explicit inline Columns(std::vector<std::string> names, size_t rows_count=npos) :
+		_names(std::move(names)), _rows_count(rows_count), _generation(next_generation())
+	{
+	}
+
+	// Returns zero for empty default-constructed columns.
+	[[nodiscard]]
+	inline std::uint64_t generation() const
+	{
+		return this->_generation;
+	}
+
+	[[nodiscard]]
+	inline size_t size() const
+	{
+		return this->_names.size();
+	}
+
+	// Returns the number of rows of the result set or 'npos' if it is
+	// not known, for example when rows are streamed.
+	[[nodiscard]]
+	inline size_t rows_count() const
+	{
+		return this->_rows_count;
+	}
+
+	[[nodiscard]]
+	inline const std::string& name(size_t index) const
+	{
+		return this->_names[index];
+	}
+
+	// Returns the position of the first column with 'name' or 'npos'.
+	// Results have a few columns, so the linear search is faster
+	// than hashing of the name.
+	[[nodiscard]]
+	inline size_t find(std::string_view name) const
+	{
+		for (size_t i = 0; i < this->_names.size(); i++)
+		{
+			if (this->_names[i] == name)
+			{
+				return i;
+			}
+		}
+
+		return npos;
+	}
+
+private:
+	std::vector<std::string> _names;
+	size_t _rows_count = npos;
+	std::uint64_t _generation = 0;
+
+	static inline std::uint64_t next_generation()
+	{
+		static std::atomic<std::uint64_t> counter{0};
+		return ++counter;
+	}
+};
+
+// Row of the result set. Values are stored by the driver in the
+// order of 'columns()', text values refer to memory of the driver's
+// result, so the row is valid only inside of the row handler.
+class Row final
+{
+public:
+	inline Row(const Columns& columns, const Value* values) : _columns(&columns), _values(values)
+	{
+	}
+
+	[[nodiscard]]
+	inline const Columns& columns() const
+	{
+		return *this->_columns;
+	}
+
+	[[nodiscard]]
+	inline size_t size() const
+	{
+		return this->_columns->size();
+	}
+
+	[[nodiscard]]
+	inline const std::string& name(size_t index) const
+	{
+		return this->_columns->name(index);
+	}
+
+	[[nodiscard]]
+	inline const Value& operator[] (size_t index) const
+	{
+		return this->_values[index];
+	}
+
+	// Returns nullptr if there is no column with 'name'.
+	[[nodiscard]]
+	inline const Value* find(std::string_view name) const
+	{
+		auto index = this->_columns->find(name);
+		return index == Columns::npos ? nullptr : &this->_values[index];
+	}
+
+private:
+	const Columns* _columns;
+	const Value* _values;
+};
+
+// Receives rows one by one. Returns false to skip the rest rows.
+using RowHandler = std::function<bool(const Row& /* row */)>;
+
+__ORM_DB_END__
@@ -0,0 +1,33 @@
+/**
+ * db/statement.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * SQL statement with parameters which is run as a part of the batch.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <string>
+#include <vector>
+
+// Module definitions.
+#include "./_def_.h"
+
+// Orm libraries.
+#include "./parameter.h"
+
+
+__ORM_DB_BEGIN__
+
+// Single SQL statement and values which are bound to its
+// placeholders in the same order.
+struct Statement final
+{
+	std::string sql;
+
+	std::vector<Parameter> parameters;
+};
+
+__ORM_DB_END__
@@ -0,0 +1,51 @@
+/**
+ * db/value.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Typed value of result column.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <string_view>
+#include <variant>
+
+// Base libraries.
+#include <xalwart.base/datetime.h>
+
+// Module definitions.
+#include "./_def_.h"
+
+
+__ORM_DB_BEGIN__
+
+// Column value which was decoded by the driver. Columns which
+// the driver is not able to decode are passed as text.
+//
+// Text refers to memory of the driver's result, so the value
+// is valid only inside of the row handler.
+struct Value final
+{
+	using value_type = std::variant<
+		std::nullptr_t, long long, double, std::string_view, dt::Date, dt::Time, dt::Datetime
+	>;
+
+	value_type value = nullptr;
+
+	Value() = default;
+
+	template <typename T>
+	inline explicit Value(T value) : value(std::move(value))
+	{
+	}
+
+	[[nodiscard]]
+	inline bool is_null() const
+	{
+		return std::holds_alternative<std::nullptr_t>(this->value);
+	}
+};
+
+__ORM_DB_END__
@@ -7,6 +7,7 @@
  *	- ModelError
  *	- QueryError
  *	- SQLError
+ *	- PoolTimeoutError
  */
 
 #pragma once
@@ -35,4 +36,8 @@ DEF_EXCEPTION_WITH_BASE(QueryError, DatabaseError, "query error", "orm::");
 // Must be thrown to indicate drivers' errors when running SQL statements.
 DEF_EXCEPTION_WITH_BASE(SQLError, DatabaseError, "sql error", "orm::");
 
+// Must be thrown when the connection pool is not able to provide
+// a free connection in time.
+DEF_EXCEPTION_WITH_BASE(PoolTimeoutError, DatabaseError, "pool timeout error", "orm::");
+
 __ORM_END__
@@ -11,8 +11,11 @@
 // C++ libraries.
 #include <string>
 #include <map>
+#include <memory>
 #include <functional>
 #include <list>
+#include <vector>
+#include <exception>
 
 // Base libraries.
 #include <xalwart.base/interfaces/orm.h>
@@ -21,8 +24,13 @@
 #include "./_def_.h"
 
 // Orm libraries.
+#include "./db/parameter.h"
+#include "./db/value.h"
+#include "./db/row.h"
+#include "./db/statement.h"
 #include "./queries/conditions.h"
 #include "./db/interfaces.h"
+#include "./utility.h"
 
 
 __ORM_BEGIN__
@@ -35,10 +43,19 @@ __ORM_END__
 __ORM_BEGIN__
 
 // TODO: docs for 'ISQLQueryBuilder'
+//
+// When 'parameters' is not nullptr, values of conditions are
+// appended to it and replaced by placeholders in the query,
+// otherwise values are inlined into the query.
 class ISQLQueryBuilder
 {
 public:
 
+	// Returns placeholder of statement parameter with
+	// one-based 'index'.
+	[[nodiscard]]
+	virtual std::string sql_placeholder(size_t index) const = 0;
+
 	// insert
 	[[nodiscard]]
 	virtual std::string sql_insert(
@@ -57,9 +74,50 @@ public:
 		long int limit,
 		long int offset,
 		const std::list<std::string>& group_by_cols,
-		const q::Condition& having_cond
+		const q::Condition& having_cond,
+		std::vector<db::Parameter>* parameters=nullptr
 	) const = 0;
 
+	// Returns list of selected 'columns' of 'table_name' which is
+	// passed to 'sql_select_'. It must depend on arguments only,
+	// because queries cache it per model and type of the builder.
+	//
+	// The default is '"table"."column" AS "column"' joined by commas.
+	[[nodiscard]]
+	virtual std::string sql_select_columns(
+		const std::string& table_name, const std::list<std::string>& columns
+	) const
+	{
+		size_t size = 0;
+		for (const auto& column : columns)
+		{
+			size += table_name.size() + column.size() * 2 + 14;
+		}
+
+		std::string columns_str;
+		columns_str.reserve(size);
+		for (auto column = columns.begin(); column != columns.end(); column++)
+		{
+			if (column != columns.begin())
+			{
+				columns_str.append(", ");
+			}
+
+			util::append_quoted(columns_str, table_name);
+			columns_str.append(1, '.');
+			util::append_quoted(columns_str, *column);
+			columns_str.append(" AS ");
+			util::append_quoted(columns_str, *column);
+		}
+
+		return columns_str;
+	}
+
+	// Generates 'SELECT' query with 'columns' built by
+	// 'sql_select_columns'. Queries of models do not call it: they
+	// cache the list of columns and call 'sql_select_' directly, so
+	// builders which customize 'SELECT' statement of models should
+	// override 'sql_select_' and 'sql_select_columns'.
 	[[nodiscard]]
 	virtual std::string sql_select(
 		const std::string& table_name,
@@ -71,18 +129,236 @@ public:
 		long int limit,
 		long int offset,
 		const std::list<std::string>& group_by_cols,
-		const q::Condition& having_cond
+		const q::Condition& having_cond,
+		std::vector<db::Parameter>* parameters=nullptr
 	) const = 0;
 
 	// update
 	[[nodiscard]]
 	virtual std::string sql_update(
-		const std::string& table_name, const std::string& columns_data, const q::Condition& condition
+		const std::string& table_name, const std::string& columns_data, const q::Condition& condition,
+		std::vector<db::Parameter>* parameters=nullptr
 	) const = 0;
 
 	// delete
 	[[nodiscard]]
-	virtual std::string sql_delete(const std::string& table_name, const q::Condition& where_cond) const = 0;
+	virtual std::string sql_delete(
+		const std::string& table_name, const q::Condition& where_cond, std::vector<db::Parameter>* parameters=nullptr
+	) const = 0;
+};
+
+// Result of the query which is read row by row on demand instead
+// of being pushed to the handler. The query is in progress until the
+// cursor is exhausted or destroyed, so the connection must not run
+// other queries meanwhile. Destroying the cursor before the last row
+// discards the rest of the result.
+class ISQLCursor
+{
+public:
+	virtual ~ISQLCursor() = default;
+
+	// Reads the next row with values decoded by the driver, like
+	// 'ISQLConnection::run_typed_query' does. The row and its values
+	// are valid until the next call. Returns nullptr when there are
+	// no more rows.
+	virtual const db::Row* next() = 0;
+};
+
+// Database connection which is able to bind values to
+// parameters of SQL statement instead of parsing them
+// from the query text.
+class ISQLConnection : public IDatabaseConnection
+{
+public:
+	using IDatabaseConnection::run_query;
+
+	// Runs 'sql_query' with 'parameters' bound to its
+	// placeholders in the same order.
+	virtual void run_query(
+		const std::string& sql_query,
+		const std::vector<db::Parameter>& parameters,
+		const std::function<void(const std::map<std::string, char*>& /* columns */)>& map_handler,
+		const std::function<void(const std::vector<char*>& /* columns */)>& vector_handler
+	) const = 0;
+
+	virtual void run_query(
+		const std::string& sql_query, const std::vector<db::Parameter>& parameters, std::string& last_row_id
+	) const = 0;
+
+	// Runs 'sql_query' and passes rows to 'row_handler' with values
+	// decoded by the driver. Columns which the driver is not able to
+	// decode are passed as text. Names of columns are read once per
+	// result set and values of the row are stored in a buffer which
+	// is reused for the next row. If 'is_streamed' is true, rows are
+	// passed one by one as they are received, so the whole result is
+	// never held in memory, otherwise the whole result is received at
+	// once. In both cases the rest rows are skipped when
+	// 'row_handler' returns false.
+	virtual void run_typed_query(
+		const std::string& sql_query,
+		const std::vector<db::Parameter>& parameters,
+		const db::RowHandler& row_handler,
+		bool is_streamed=false
+	) const = 0;
+
+	// Starts 'sql_query' and returns the cursor over its rows, which
+	// are received from the database as the cursor is advanced.
+	// 'parameters' are copied, so they can be destroyed right away.
+	//
+	// 'sql_query' should contain a single statement.
+	[[nodiscard]]
+	virtual std::unique_ptr<ISQLCursor> open_cursor(
+		const std::string& sql_query, const std::vector<db::Parameter>& parameters
+	) const = 0;
+
+	// Runs 'statements' as a single unit and returns the number of
+	// rows affected by each of them. If there is no transaction in
+	// progress, all statements are rolled back when one of them fails.
+	//
+	// Each statement should be a single DML statement.
+	virtual std::vector<size_t> run_batch(const std::vector<db::Statement>& statements) const = 0;
+
+	// Returns true if the transaction is in progress, including
+	// the one which was started by running 'BEGIN' directly.
+	[[nodiscard]]
+	virtual bool is_in_transaction() const = 0;
+
+	// Restores the state of the session, e.g. settings which were
+	// set when the connection was opened.
+	using reconnect_handler = std::function<void()>;
+
+	// Sets 'handler' which is called each time the connection is
+	// opened again in place of the lost one. Connections which never
+	// reconnect ignore it.
+	virtual void set_reconnect_handler(reconnect_handler handler) = 0;
+
+	// Maximum number of parameters which can be bound
+	// to a single query.
+	[[nodiscard]]
+	virtual size_t max_parameters() const = 0;
+};
+
+// Database connection which is able to load rows into the
+// table in bulk, without building and parsing SQL statement.
+class IBulkCopyConnection
+{
+public:
+	virtual ~IBulkCopyConnection() = default;
+
+	// Loads 'rows' into the 'columns' of 'table_name'. 'columns' is
+	// a comma-separated list of names, each row contains one value
+	// per column in the same order.
+	virtual void copy_rows(
+		const std::string& table_name,
+		const std::string& columns,
+		const std::list<std::vector<db::Parameter>>& rows
+	) const = 0;
+};
+
+// Database connection which is able to run queries without
+// blocking of the calling thread.
+class IAsyncSQLConnection
+{
+public:
+	virtual ~IAsyncSQLConnection() = default;
+
+	// Receives nullptr if the query succeeded, otherwise the error.
+	using completion_handler = std::function<void(std::exception_ptr /* error */)>;
+
+	// Sends the query and returns without waiting for the result.
+	// Rows are passed to 'row_handler' as they are received, then
+	// 'completion' is called. Both handlers are called from the
+	// background thread, or from the calling one if the query fails
+	// before sending. Errors, including ones thrown by 'row_handler',
+	// are passed to 'completion' instead of throwing.
+	//
+	// The connection must stay alive and must not run other queries
+	// until 'completion' is called. The transaction is not rolled
+	// back if the query fails.
+	//
+	// 'row_handler' can be nullptr.
+	virtual void run_query_async(
+		const std::string& sql_query,
+		const std::vector<db::Parameter>& parameters,
+		db::RowHandler row_handler,
+		completion_handler completion
+	) const = 0;
+
+	// Sends 'statements' with bound parameters and calls 'completion'
+	// when all of them are run or some one fails. Unless
+	// 'in_transaction' is true, statements are run inside of the
+	// transaction which is rolled back on failure.
+	//
+	// The default sends statements one by one by 'run_query_async',
+	// each after the previous one succeeds. Drivers which are able to
+	// send all statements at once should override it.
+	virtual void run_batch_async(
+		const std::vector<db::Statement>& statements, bool in_transaction, completion_handler completion
+	) const
+	{
+		auto batch = std::make_shared<AsyncBatch>();
+		batch->is_own_transaction = !in_transaction;
+		batch->statements.reserve(statements.size() + 2);
+		if (batch->is_own_transaction)
+		{
+			batch->statements.push_back({"BEGIN;", {}});
+		}
+
+		batch->statements.insert(batch->statements.end(), statements.begin(), statements.end());
+		if (batch->is_own_transaction)
+		{
+			batch->statements.push_back({"COMMIT;", {}});
+		}
+
+		batch->completion = std::move(completion);
+		this->run_batch_step(batch);
+	}
+
+protected:
+	// State of the batch which is run by default 'run_batch_async'.
+	struct AsyncBatch
+	{
+		std::vector<db::Statement> statements;
+		size_t index = 0;
+		bool is_own_transaction = false;
+		completion_handler completion;
+	};
+
+	// Sends the current statement of 'batch' and the next one when it
+	// succeeds. Calls the completion handler of 'batch' after the last
+	// statement or the first failure.
+	inline void run_batch_step(const std::shared_ptr<AsyncBatch>& batch) const
+	{
+		if (batch->index == batch->statements.size())
+		{
+			auto completion = std::move(batch->completion);
+			completion(nullptr);
+			return;
+		}
+
+		const auto& statement = batch->statements[batch->index];
+		this->run_query_async(statement.sql, statement.parameters, nullptr, [this, batch](auto error) -> void {
+			if (!error)
+			{
+				batch->index++;
+				this->run_batch_step(batch);
+				return;
+			}
+
+			auto completion = std::move(batch->completion);
+			if (!batch->is_own_transaction || batch->index == 0)
+			{
+				completion(error);
+				return;
+			}
+
+			// Error of the rollback is ignored, the one of the failed
+			// statement is passed instead.
+			this->run_query_async("ROLLBACK;", {}, nullptr, [completion, error](auto) -> void {
+				completion(error);
+			});
+		});
+	}
 };
 
 // TODO: docs for 'ISQLBackend'
@@ -0,0 +1,217 @@
+/**
+ * pool.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./pool.h"
+
+// C++ libraries.
+#include <string>
+
+// Orm libraries.
+#include "./exceptions.h"
+
+
+__ORM_BEGIN__
+
+void ConnectionPool::create()
+{
+	std::unique_lock<std::mutex> lock(this->_mutex);
+	while (this->_connections_count < this->_options.min_connections)
+	{
+		auto connection = this->_open_connection(lock);
+		this->_connections.push_back({std::move(connection), std::chrono::steady_clock::now()});
+	}
+
+	lock.unlock();
+	this->_condition.notify_all();
+}
+
+std::shared_ptr<IDatabaseConnection> ConnectionPool::acquire()
+{
+	if (this->_options.acquire_timeout.has_value())
+	{
+		return this->acquire(this->_options.acquire_timeout.value());
+	}
+
+	auto requested_at = std::chrono::steady_clock::now();
+	std::vector<std::shared_ptr<IDatabaseConnection>> expired;
+	std::unique_lock<std::mutex> lock(this->_mutex);
+	this->_take_expired_connections(expired);
+	while (this->_connections.empty())
+	{
+		if (this->_connections_count < this->_options.max_connections)
+		{
+			return this->_provide(this->_open_connection(lock), requested_at);
+		}
+
+		this->_metrics.add_waiter();
+		this->_condition.wait(lock);
+		this->_metrics.remove_waiter();
+	}
+
+	return this->_provide(this->_take_connection(), requested_at);
+}
+
+std::shared_ptr<IDatabaseConnection> ConnectionPool::acquire(std::chrono::milliseconds timeout)
+{
+	auto requested_at = std::chrono::steady_clock::now();
+	auto deadline = requested_at + timeout;
+	std::vector<std::shared_ptr<IDatabaseConnection>> expired;
+	std::unique_lock<std::mutex> lock(this->_mutex);
+	this->_take_expired_connections(expired);
+	while (this->_connections.empty())
+	{
+		if (this->_connections_count < this->_options.max_connections)
+		{
+			return this->_provide(this->_open_connection(lock), requested_at);
+		}
+
+		this->_metrics.add_waiter();
+		auto status = this->_condition.wait_until(lock, deadline);
+		this->_metrics.remove_waiter();
+		if (status == std::cv_status::timeout && this->_connections.empty())
+		{
+			this->_metrics.record_timeout(0);
+			throw PoolTimeoutError(
+				"Timed out after " + std::to_string(timeout.count()) + " ms waiting for a free connection",
+				_ERROR_DETAILS_
+			);
+		}
+	}
+
+	return this->_provide(this->_take_connection(), requested_at);
+}
+
+std::shared_ptr<IDatabaseConnection> ConnectionPool::try_acquire()
+{
+	auto requested_at = std::chrono::steady_clock::now();
+	std::vector<std::shared_ptr<IDatabaseConnection>> expired;
+	std::unique_lock<std::mutex> lock(this->_mutex);
+	this->_take_expired_connections(expired);
+	if (!this->_connections.empty())
+	{
+		return this->_provide(this->_take_connection(), requested_at);
+	}
+
+	if (this->_connections_count < this->_options.max_connections)
+	{
+		return this->_provide(this->_open_connection(lock), requested_at);
+	}
+
+	return nullptr;
+}
+
+void ConnectionPool::release(const std::shared_ptr<IDatabaseConnection>& connection)
+{
+	auto released_at = std::chrono::steady_clock::now();
+	std::vector<std::shared_ptr<IDatabaseConnection>> expired;
+	std::unique_lock<std::mutex> lock(this->_mutex);
+	auto acquired_at = this->_acquired_at.find(connection.get());
+	if (acquired_at != this->_acquired_at.end())
+	{
+		this->_metrics.record_release(0, released_at - acquired_at->second);
+		this->_acquired_at.erase(acquired_at);
+	}
+
+	this->_connections.push_back({connection, released_at});
+	this->_take_expired_connections(expired);
+	lock.unlock();
+	this->_condition.notify_one();
+}
+
+void ConnectionPool::evict_idle_connections()
+{
+	std::vector<std::shared_ptr<IDatabaseConnection>> expired;
+	std::lock_guard<std::mutex> lock(this->_mutex);
+	this->_take_expired_connections(expired);
+}
+
+size_t ConnectionPool::connections_count()
+{
+	std::lock_guard<std::mutex> lock(this->_mutex);
+	return this->_connections_count;
+}
+
+size_t ConnectionPool::idle_connections_count()
+{
+	std::lock_guard<std::mutex> lock(this->_mutex);
+	return this->_connections.size();
+}
+
+PoolMetrics ConnectionPool::metrics()
+{
+	std::lock_guard<std::mutex> lock(this->_mutex);
+	return this->_metrics.snapshot(this->_connections_count, this->_connections.size());
+}
+
+std::shared_ptr<IDatabaseConnection> ConnectionPool::_take_connection()
+{
+	auto connection = std::move(this->_connections.back().connection);
+	this->_connections.pop_back();
+	return connection;
+}
+
+std::shared_ptr<IDatabaseConnection> ConnectionPool::_provide(
+	std::shared_ptr<IDatabaseConnection> connection, std::chrono::steady_clock::time_point requested_at
+)
+{
+	auto acquired_at = std::chrono::steady_clock::now();
+	this->_metrics.record_acquire(0, acquired_at - requested_at);
+	this->_acquired_at[connection.get()] = acquired_at;
+	return connection;
+}
+
+std::shared_ptr<IDatabaseConnection> ConnectionPool::_open_connection(std::unique_lock<std::mutex>& lock)
+{
+	// Slot is reserved before connecting, so concurrent requests
+	// do not exceed the maximum number of connections.
+	this->_connections_count++;
+	lock.unlock();
+	try
+	{
+		auto connection = this->_connection_builder();
+		lock.lock();
+		this->_metrics.record_creation(0, true);
+		return connection;
+	}
+	catch (...)
+	{
+		lock.lock();
+		this->_connections_count--;
+		this->_metrics.record_creation(0, false);
+
+		// Other thread can be waiting for the slot which was reserved.
+		this->_condition.notify_one();
+		throw;
+	}
+}
+
+void ConnectionPool::_take_expired_connections(std::vector<std::shared_ptr<IDatabaseConnection>>& expired)
+{
+	if (!this->_options.idle_timeout.has_value())
+	{
+		return;
+	}
+
+	auto expiration_time = std::chrono::steady_clock::now() - this->_options.idle_timeout.value();
+	auto expired_count = expired.size();
+	while (
+		!this->_connections.empty() &&
+		this->_connections_count > this->_options.min_connections &&
+		this->_connections.front().released_at < expiration_time
+	)
+	{
+		expired.push_back(std::move(this->_connections.front().connection));
+		this->_connections.pop_front();
+		this->_connections_count--;
+	}
+
+	if (expired.size() > expired_count)
+	{
+		this->_metrics.record_eviction(0, expired.size() - expired_count);
+	}
+}
+
+__ORM_END__
@@ -0,0 +1,213 @@
+/**
+ * pool.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Pools of database connections.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <optional>
+
+// Base libraries.
+#include <xalwart.base/interfaces/orm.h>
+
+// Module definitions.
+#include "./_def_.h"
+
+// Orm libraries.
+#include "./exceptions.h"
+#include "./pool_metrics.h"
+
+
+__ORM_BEGIN__
+
+// Bounds and timeouts of the connection pool.
+struct PoolOptions final
+{
+	// Number of connections which are opened by 'create_pool' and
+	// are never closed because of idleness.
+	size_t min_connections = 1;
+
+	// Maximum number of connections which are open at the same
+	// time. Connections above 'min_connections' are opened on
+	// demand.
+	size_t max_connections = 1;
+
+	// How long 'get_connection()' waits for a free connection.
+	// Waits forever if not set.
+	std::optional<std::chrono::milliseconds> acquire_timeout = std::nullopt;
+
+	// Connections above 'min_connections' which were not used for
+	// this time are closed. Idle connections are kept if not set.
+	std::optional<std::chrono::milliseconds> idle_timeout = std::nullopt;
+
+	// Use 'ShardedConnectionPool' instead of 'ConnectionPool'.
+	bool is_sharded = false;
+
+	PoolOptions() = default;
+
+	// Fixed-size pool which opens all connections at once.
+	inline PoolOptions(size_t pool_size) : min_connections(pool_size), max_connections(pool_size)
+	{
+	}
+};
+
+using ConnectionBuilder = std::function<std::shared_ptr<IDatabaseConnection>()>;
+
+// Thread-safe storage of open connections which are shared
+// between users of the backend.
+class IConnectionPool
+{
+public:
+	virtual ~IConnectionPool() = default;
+
+	// Opens 'min_connections' connections.
+	virtual void create() = 0;
+
+	// Provides a free connection. If there is not any connection
+	// available and the pool is full, waits for it during
+	// 'acquire_timeout' of the pool options.
+	//
+	// Throws 'PoolTimeoutError' if the timeout expires.
+	virtual std::shared_ptr<IDatabaseConnection> acquire() = 0;
+
+	// Acts like 'acquire()', but waits during 'timeout'. Zero
+	// 'timeout' means that the connection is provided only if
+	// it is available immediately.
+	//
+	// Throws 'PoolTimeoutError' if the timeout expires.
+	virtual std::shared_ptr<IDatabaseConnection> acquire(std::chrono::milliseconds timeout) = 0;
+
+	// Provides a free connection only if it is available immediately,
+	// a new connection is opened if the pool is not full. Returns
+	// nullptr instead of waiting, which is not counted as a timeout.
+	//
+	// The default implementation probes 'acquire' with zero timeout,
+	// pools should override it to keep metrics accurate.
+	//
+	// Throws if opening of the connection fails.
+	virtual std::shared_ptr<IDatabaseConnection> try_acquire()
+	{
+		try
+		{
+			return this->acquire(std::chrono::milliseconds(0));
+		}
+		catch (const PoolTimeoutError&)
+		{
+			return nullptr;
+		}
+	}
+
+	// Returns the connection which was provided by 'acquire'.
+	virtual void release(const std::shared_ptr<IDatabaseConnection>& connection) = 0;
+
+	// Closes connections above 'min_connections' which are idle
+	// longer than 'idle_timeout' of the pool options.
+	virtual void evict_idle_connections() = 0;
+
+	// Number of open connections, including used ones.
+	[[nodiscard]]
+	virtual size_t connections_count() = 0;
+
+	// Number of open connections which are waiting in the pool.
+	[[nodiscard]]
+	virtual size_t idle_connections_count() = 0;
+
+	// Returns the current state of the pool and counters which are
+	// accumulated since the pool was created.
+	[[nodiscard]]
+	virtual PoolMetrics metrics() = 0;
+};
+
+// Pool which keeps free connections in a single queue guarded
+// by the mutex.
+//
+// Idle connections are evicted each time the connection is
+// requested or released.
+class ConnectionPool final : public IConnectionPool
+{
+public:
+	inline ConnectionPool(const PoolOptions& options, ConnectionBuilder builder) :
+		_options(options), _connection_builder(std::move(builder))
+	{
+	}
+
+	void create() override;
+
+	std::shared_ptr<IDatabaseConnection> acquire() override;
+
+	std::shared_ptr<IDatabaseConnection> acquire(std::chrono::milliseconds timeout) override;
+
+	std::shared_ptr<IDatabaseConnection> try_acquire() override;
+
+	void release(const std::shared_ptr<IDatabaseConnection>& connection) override;
+
+	void evict_idle_connections() override;
+
+	[[nodiscard]]
+	size_t connections_count() override;
+
+	[[nodiscard]]
+	size_t idle_connections_count() override;
+
+	[[nodiscard]]
+	PoolMetrics metrics() override;
+
+private:
+	struct IdleConnection
+	{
+		std::shared_ptr<IDatabaseConnection> connection;
+		std::chrono::steady_clock::time_point released_at;
+	};
+
+	std::mutex _mutex;
+	std::condition_variable _condition;
+
+	// Free connections ordered by the time of release, so the least
+	// recently used connections are at the front.
+	std::deque<IdleConnection> _connections;
+
+	// Number of open connections, including connections
+	// which are being opened at the moment.
+	size_t _connections_count = 0;
+
+	// Time when each used connection was provided, is needed
+	// to measure how long connections are held.
+	std::unordered_map<const IDatabaseConnection*, std::chrono::steady_clock::time_point> _acquired_at;
+
+	const PoolOptions _options;
+	ConnectionBuilder _connection_builder;
+
+	PoolMetricsCollector _metrics;
+
+	// Takes the most recently used connection, so the rest ones
+	// are able to become idle and to be closed.
+	std::shared_ptr<IDatabaseConnection> _take_connection();
+
+	// Records the time of providing the connection which was
+	// requested at 'requested_at'. Must be called under the lock.
+	std::shared_ptr<IDatabaseConnection> _provide(
+		std::shared_ptr<IDatabaseConnection> connection, std::chrono::steady_clock::time_point requested_at
+	);
+
+	// Opens a new connection outside of the lock and counts it
+	// as open. 'lock' is locked again before returning.
+	std::shared_ptr<IDatabaseConnection> _open_connection(std::unique_lock<std::mutex>& lock);
+
+	// Moves expired idle connections to 'expired' to be closed
+	// after unlocking of the pool. Must be called under the lock.
+	void _take_expired_connections(std::vector<std::shared_ptr<IDatabaseConnection>>& expired);
+};
+
+__ORM_END__
@@ -0,0 +1,123 @@
+/**
+ * pool_metrics.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./pool_metrics.h"
+
+// C++ libraries.
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+
+__ORM_BEGIN__
+
+size_t DurationHistogram::bucket_index(std::chrono::microseconds duration)
+{
+	auto microseconds = (uint64_t)std::max<std::chrono::microseconds::rep>(duration.count(), 0);
+	return std::min<size_t>(std::bit_width(microseconds), BUCKETS_COUNT - 1);
+}
+
+std::chrono::microseconds DurationHistogram::percentile(double quantile) const
+{
+	if (!this->count)
+	{
+		return std::chrono::microseconds(0);
+	}
+
+	auto rank = (uint64_t)std::ceil(std::clamp(quantile, 0.0, 1.0) * (double)this->count);
+	uint64_t accumulated = 0;
+	for (size_t i = 0; i < BUCKETS_COUNT; i++)
+	{
+		accumulated += this->buckets[i];
+		if (accumulated >= rank && accumulated)
+		{
+			return std::min(bucket_bound(i), this->max);
+		}
+	}
+
+	return this->max;
+}
+
+void PoolMetricsCollector::AtomicHistogram::record(std::chrono::steady_clock::duration duration)
+{
+	auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(duration);
+	this->buckets[DurationHistogram::bucket_index(microseconds)].fetch_add(1, std::memory_order_relaxed);
+	auto value = (uint64_t)std::max<std::chrono::microseconds::rep>(microseconds.count(), 0);
+	this->total_microseconds.fetch_add(value, std::memory_order_relaxed);
+	auto max = this->max_microseconds.load(std::memory_order_relaxed);
+	while (value > max && !this->max_microseconds.compare_exchange_weak(max, value, std::memory_order_relaxed));
+}
+
+void PoolMetricsCollector::AtomicHistogram::add_to(DurationHistogram& histogram) const
+{
+	for (size_t i = 0; i < DurationHistogram::BUCKETS_COUNT; i++)
+	{
+		auto count = this->buckets[i].load(std::memory_order_relaxed);
+		histogram.buckets[i] += count;
+		histogram.count += count;
+	}
+
+	histogram.total += std::chrono::microseconds(this->total_microseconds.load(std::memory_order_relaxed));
+	histogram.max = std::max(
+		histogram.max, std::chrono::microseconds(this->max_microseconds.load(std::memory_order_relaxed))
+	);
+}
+
+PoolMetricsCollector::PoolMetricsCollector(size_t shards_count) : _shards_count(std::max<size_t>(shards_count, 1))
+{
+	this->_shards = std::make_unique<Shard[]>(this->_shards_count);
+}
+
+void PoolMetricsCollector::record_acquire(size_t shard, std::chrono::steady_clock::duration wait_time)
+{
+	this->_shards[shard % this->_shards_count].acquire_wait_time.record(wait_time);
+}
+
+void PoolMetricsCollector::record_release(size_t shard, std::chrono::steady_clock::duration hold_time)
+{
+	this->_shards[shard % this->_shards_count].hold_time.record(hold_time);
+}
+
+void PoolMetricsCollector::record_creation(size_t shard, bool is_successful)
+{
+	auto& counters = this->_shards[shard % this->_shards_count];
+	(is_successful ? counters.created_count : counters.creation_failures_count).fetch_add(
+		1, std::memory_order_relaxed
+	);
+}
+
+void PoolMetricsCollector::record_timeout(size_t shard)
+{
+	this->_shards[shard % this->_shards_count].timeouts_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PoolMetricsCollector::record_eviction(size_t shard, size_t count)
+{
+	this->_shards[shard % this->_shards_count].evicted_count.fetch_add(count, std::memory_order_relaxed);
+}
+
+PoolMetrics PoolMetricsCollector::snapshot(size_t connections_count, size_t idle_connections_count) const
+{
+	PoolMetrics metrics;
+	metrics.connections_count = connections_count;
+	metrics.idle_connections_count = std::min(idle_connections_count, connections_count);
+	metrics.used_connections_count = connections_count - metrics.idle_connections_count;
+	metrics.waiters_count = this->_waiters_count.load();
+	for (size_t i = 0; i < this->_shards_count; i++)
+	{
+		const auto& shard = this->_shards[i];
+		shard.acquire_wait_time.add_to(metrics.acquire_wait_time);
+		shard.hold_time.add_to(metrics.hold_time);
+		metrics.created_count += shard.created_count.load(std::memory_order_relaxed);
+		metrics.creation_failures_count += shard.creation_failures_count.load(std::memory_order_relaxed);
+		metrics.timeouts_count += shard.timeouts_count.load(std::memory_order_relaxed);
+		metrics.evicted_count += shard.evicted_count.load(std::memory_order_relaxed);
+	}
+
+	return metrics;
+}
+
+__ORM_END__
@@ -0,0 +1,161 @@
+/**
+ * pool_metrics.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Saturation metrics of connection pools.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <array>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+
+// Module definitions.
+#include "./_def_.h"
+
+
+__ORM_BEGIN__
+
+// Distribution of durations. Bucket 'i' counts durations which are
+// less than 2^i microseconds, but not less than the bound of the
+// previous bucket. The last bucket also counts all longer durations.
+struct DurationHistogram final
+{
+	static constexpr size_t BUCKETS_COUNT = 32;
+
+	std::array<uint64_t, BUCKETS_COUNT> buckets{};
+
+	uint64_t count = 0;
+
+	std::chrono::microseconds total{0};
+
+	std::chrono::microseconds max{0};
+
+	// Returns the upper bound of bucket with 'index'.
+	static inline std::chrono::microseconds bucket_bound(size_t index)
+	{
+		return std::chrono::microseconds(1LL << index);
+	}
+
+	// Returns the index of the bucket which counts 'duration'.
+	static size_t bucket_index(std::chrono::microseconds duration);
+
+	// Returns the upper bound of the bucket which contains the
+	// 'quantile' (from 0 to 1) of durations, so the result is
+	// precise up to a factor of two. Returns zero if the histogram
+	// is empty.
+	[[nodiscard]]
+	std::chrono::microseconds percentile(double quantile) const;
+
+	[[nodiscard]]
+	inline std::chrono::microseconds mean() const
+	{
+		return this->count ? this->total / (std::chrono::microseconds::rep)this->count : std::chrono::microseconds(0);
+	}
+};
+
+// Snapshot of the pool state and counters which are accumulated
+// since the pool was created.
+struct PoolMetrics final
+{
+	// Open connections, including used ones.
+	size_t connections_count = 0;
+
+	size_t used_connections_count = 0;
+
+	size_t idle_connections_count = 0;
+
+	// Threads which are waiting for a free connection.
+	size_t waiters_count = 0;
+
+	uint64_t created_count = 0;
+
+	uint64_t creation_failures_count = 0;
+
+	// Requests which failed with 'PoolTimeoutError'.
+	uint64_t timeouts_count = 0;
+
+	// Connections which were closed because of idleness.
+	uint64_t evicted_count = 0;
+
+	// Time between the request of a connection and receiving it.
+	DurationHistogram acquire_wait_time;
+
+	// Time between receiving of a connection and returning it back.
+	DurationHistogram hold_time;
+};
+
+// Thread-safe collector of pool metrics. Counters are split into
+// shards aligned to the cache line, so threads which record to
+// different shards do not contend with each other.
+class PoolMetricsCollector final
+{
+public:
+	explicit PoolMetricsCollector(size_t shards_count=1);
+
+	void record_acquire(size_t shard, std::chrono::steady_clock::duration wait_time);
+
+	void record_release(size_t shard, std::chrono::steady_clock::duration hold_time);
+
+	void record_creation(size_t shard, bool is_successful);
+
+	void record_timeout(size_t shard);
+
+	void record_eviction(size_t shard, size_t count);
+
+	inline void add_waiter()
+	{
+		this->_waiters_count++;
+	}
+
+	inline void remove_waiter()
+	{
+		this->_waiters_count--;
+	}
+
+	[[nodiscard]]
+	inline size_t waiters_count() const
+	{
+		return this->_waiters_count.load();
+	}
+
+	// Returns accumulated counters together with the state of
+	// the pool which is provided by the caller.
+	[[nodiscard]]
+	PoolMetrics snapshot(size_t connections_count, size_t idle_connections_count) const;
+
+private:
+	struct AtomicHistogram
+	{
+		std::array<std::atomic<uint64_t>, DurationHistogram::BUCKETS_COUNT> buckets{};
+		std::atomic<uint64_t> total_microseconds = 0;
+		std::atomic<uint64_t> max_microseconds = 0;
+
+		void record(std::chrono::steady_clock::duration duration);
+
+		// Adds values of this histogram to 'histogram'.
+		void add_to(DurationHistogram& histogram) const;
+	};
+
+	struct alignas(64) Shard
+	{
+		AtomicHistogram acquire_wait_time;
+		AtomicHistogram hold_time;
+		std::atomic<uint64_t> created_count = 0;
+		std::atomic<uint64_t> creation_failures_count = 0;
+		std::atomic<uint64_t> timeouts_count = 0;
+		std::atomic<uint64_t> evicted_count = 0;
+	};
+
+	std::unique_ptr<Shard[]> _shards;
+	size_t _shards_count;
+
+	std::atomic<size_t> _waiters_count = 0;
+};
+
+__ORM_END__
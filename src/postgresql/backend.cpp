@@ -10,24 +10,49 @@
 
 // C++ libraries.
 #include <memory>
+#include <mutex>
 
 // Base libraries.
 #include <xalwart.base/interfaces/orm.h>
 
 // Orm libraries.
 #include "./schema_editor.h"
+#include "./sql_builder.h"
 
 
 __ORM_POSTGRESQL_BEGIN__
 
-Backend::Backend(size_t pool_size, const PostgreSQLCredentials& credentials) :
-	DefaultSQLBackend(
-		pool_size, [credentials]() -> std::shared_ptr<IDatabaseConnection>
+Backend::Backend(
+	const PoolOptions& pool_options, const PostgreSQLCredentials& credentials,
+	size_t statements_cache_size, bool binary_results
+) : DefaultSQLBackend(pool_options, _make_builder(credentials, statements_cache_size, binary_results, this)),
+	_statements_cache_size(statements_cache_size), _binary_results(binary_results)
+{
+}
+
+void Backend::use_replicas(const std::vector<Replica>& replicas, ReplicaRouting routing)
+{
+	std::vector<std::unique_ptr<IConnectionPool>> pools;
+	pools.reserve(replicas.size());
+	for (const auto& replica : replicas)
+	{
+		pools.push_back(this->make_pool(replica.pool_options, _make_builder(
+			replica.credentials, this->_statements_cache_size, this->_binary_results, this
+		)));
+	}
+
+	this->set_read_pool(std::make_unique<ReplicaPool>(std::move(pools), routing));
+}
+
+void Backend::use_profile(const Profile& profile)
+{
+	this->add_connection_initializer([statements = profile.statements()](IDatabaseConnection& connection) -> void
+	{
+		for (const auto& statement : statements)
 		{
-			return std::make_shared<PostgreSQLConnection>(credentials);
+			connection.run_query(statement, nullptr, nullptr);
 		}
-	)
-{
+	});
 }
 
 db::ISchemaEditor* Backend::schema_editor() const
@@ -40,6 +65,38 @@ db::ISchemaEditor* Backend::schema_editor() const
 	return this->sql_schema_editor.get();
 }
 
+ISQLQueryBuilder* Backend::sql_builder() const
+{
+	if (!this->sql_query_builder)
+	{
+		this->sql_query_builder = std::make_shared<SQLBuilder>();
+	}
+
+	return this->sql_query_builder.get();
+}
+
+std::shared_ptr<Reactor> Backend::_get_reactor()
+{
+	std::call_once(this->_reactor_flag, [this]() -> void {
+		this->_reactor = std::make_shared<Reactor>();
+	});
+	return this->_reactor;
+}
+
+ConnectionBuilder Backend::_make_builder(
+	const PostgreSQLCredentials& credentials, size_t statements_cache_size,
+	bool binary_results, Backend* backend
+)
+{
+	return [credentials, statements_cache_size, binary_results, backend]() -> std::shared_ptr<IDatabaseConnection>
+	{
+		return std::make_shared<PostgreSQLConnection>(
+			credentials, statements_cache_size, binary_results,
+			[backend]() -> std::shared_ptr<Reactor> { return backend->_get_reactor(); }
+		);
+	};
+}
+
 std::vector<std::string> Backend::get_table_names(const IDatabaseConnection* connection)
 {
 	std::string query =
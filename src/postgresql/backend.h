@@ -13,22 +13,42 @@
 // C++ libraries.
 #include <string>
 #include <vector>
+#include <memory>
+#include <mutex>
 
 // Module definitions.
 #include "./_def_.h"
 
 // Orm libraries.
 #include "./connection.h"
+#include "./profile.h"
 #include "../backend.h"
 
 
 __ORM_POSTGRESQL_BEGIN__
 
+// Server with a copy of the primary database which serves reads.
+struct Replica final
+{
+	PostgreSQLCredentials credentials;
+
+	PoolOptions pool_options = PoolOptions(3);
+};
+
 // TESTME: Backend
 class Backend : public DefaultSQLBackend
 {
 public:
-	explicit Backend(size_t pool_size, const PostgreSQLCredentials& credentials);
+	// 'statements_cache_size' and 'binary_results' are passed to
+	// each connection, check 'PostgreSQLConnection' for details.
+	// All connections share a single reactor thread which waits
+	// for results of asynchronous queries. It is started by the
+	// first asynchronous query, so backends which run synchronous
+	// queries only do not start any threads.
+	explicit Backend(
+		const PoolOptions& pool_options, const PostgreSQLCredentials& credentials,
+		size_t statements_cache_size=32, bool binary_results=false
+	);
 
 	[[nodiscard]]
 	inline std::string dbms_name() const override
@@ -36,13 +56,54 @@ public:
 		return "postgresql";
 	}
 
+	// Routes connections which are requested by 'get_read_connection'
+	// to pools of 'replicas', so 'Repository::select' does not load
+	// the primary server. Writes and transactions stay on the primary.
+	// Should be called before 'create_pool'. Replicas are not checked
+	// for replication lag, so reads can miss the latest writes of
+	// other repositories. 'Repository' keeps reading the primary after
+	// its own writes, check its docs.
+	//
+	// Throws 'ValueError' if 'replicas' is empty or bounds of some
+	// pool are invalid.
+	void use_replicas(const std::vector<Replica>& replicas, ReplicaRouting routing=ReplicaRouting::LeastLoaded);
+
+	// Applies settings of 'profile' to the session of each connection
+	// which is opened later, so it should be called before
+	// 'create_pool'.
+	void use_profile(const Profile& profile);
+
 	// Instantiates PostgreSQL schema editor if it was not
 	// done yet and returns it.
 	[[nodiscard]]
 	db::ISchemaEditor* schema_editor() const override;
 
+	// Instantiates PostgreSQL query builder if it was not
+	// done yet and returns it.
+	[[nodiscard]]
+	ISQLQueryBuilder* sql_builder() const override;
+
 	[[nodiscard]]
 	std::vector<std::string> get_table_names(const IDatabaseConnection* connection) override;
+
+private:
+	// Connections of the primary server and of replicas share it.
+	// Created by '_get_reactor' on the first request.
+	std::shared_ptr<Reactor> _reactor;
+	std::once_flag _reactor_flag;
+
+	size_t _statements_cache_size;
+	bool _binary_results;
+
+	// Starts the reactor if it is not started yet and returns it.
+	std::shared_ptr<Reactor> _get_reactor();
+
+	// Connections request the reactor from 'backend', which must
+	// outlive them.
+	static ConnectionBuilder _make_builder(
+		const PostgreSQLCredentials& credentials, size_t statements_cache_size,
+		bool binary_results, Backend* backend
+	);
 };
 
 __ORM_POSTGRESQL_END__
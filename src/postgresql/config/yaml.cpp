@@ -8,6 +8,9 @@
 
 #ifdef USE_POSTGRESQL
 
+// C++ libraries.
+#include <optional>
+
 // Base libraries.
 #include <xalwart.base/exceptions.h>
 
@@ -17,6 +20,32 @@
 
 __ORM_POSTGRESQL_BEGIN__
 
+void YAMLPostgreSQLReplicasComponent::handle_replica(const YAML::Node& node) const
+{
+	// Empty values and zero port mark omitted keys.
+	Replica replica;
+	replica.credentials.host = "";
+	replica.credentials.port = 0;
+	xw::config::YAMLMapComponent component;
+	component.register_component("name", std::make_unique<xw::config::YAMLScalarComponent>(replica.credentials.name));
+	component.register_component("user", std::make_unique<xw::config::YAMLScalarComponent>(replica.credentials.user));
+	component.register_component(
+		"password", std::make_unique<xw::config::YAMLScalarComponent>(replica.credentials.password)
+	);
+	component.register_component("host", std::make_unique<xw::config::YAMLScalarComponent>(replica.credentials.host));
+	component.register_component("port", std::make_unique<xw::config::YAMLScalarComponent>(replica.credentials.port));
+	component.register_component(
+		"connections", std::make_unique<orm::config::YAMLPoolComponent>(replica.pool_options)
+	);
+	component.initialize(node);
+	if (replica.credentials.host.empty())
+	{
+		throw ImproperlyConfigured("'host' of postgresql replica should be non-empty string", _ERROR_DETAILS_);
+	}
+
+	this->replicas.push_back(std::move(replica));
+}
+
 void YAMLPostgreSQLComponent::initialize(const YAML::Node& node) const
 {
 	xw::config::YAMLMapComponent::initialize(node);
@@ -29,15 +58,67 @@ void YAMLPostgreSQLComponent::initialize(const YAML::Node& node) const
 		throw ImproperlyConfigured(exc.what(), _ERROR_DETAILS_);
 	}
 
-	if (this->pool_size < 1)
+	if (this->statements_cache_size < 0)
+	{
+		throw ImproperlyConfigured(
+			"'statements_cache' should be non-negative integer", _ERROR_DETAILS_
+		);
+	}
+
+	std::optional<Profile> profile;
+	if (!this->profile.empty())
+	{
+		try
+		{
+			profile = Profile::from_name(this->profile);
+		}
+		catch (const ValueError& exc)
+		{
+			throw ImproperlyConfigured(exc.what(), _ERROR_DETAILS_);
+		}
+	}
+
+	ReplicaRouting routing;
+	if (this->replica_routing == "least-loaded")
+	{
+		routing = ReplicaRouting::LeastLoaded;
+	}
+	else if (this->replica_routing == "round-robin")
+	{
+		routing = ReplicaRouting::RoundRobin;
+	}
+	else
 	{
 		throw ImproperlyConfigured(
-			"'connections' should be positive integer", _ERROR_DETAILS_
+			"'replica_routing' should be 'least-loaded' or 'round-robin'", _ERROR_DETAILS_
 		);
 	}
 
-	this->backend = std::make_shared<Backend>(this->pool_size, this->credentials);
-	this->backend->create_pool();
+	auto replicas = this->replicas;
+	for (auto& replica : replicas)
+	{
+		auto& credentials = replica.credentials;
+		credentials.name = credentials.name.empty() ? this->credentials.name : credentials.name;
+		credentials.user = credentials.user.empty() ? this->credentials.user : credentials.user;
+		credentials.password = credentials.password.empty() ? this->credentials.password : credentials.password;
+		credentials.port = credentials.port ? credentials.port : this->credentials.port;
+	}
+
+	auto postgresql_backend = std::make_shared<Backend>(
+		this->pool_options, this->credentials, this->statements_cache_size, this->binary_results
+	);
+	if (!replicas.empty())
+	{
+		postgresql_backend->use_replicas(replicas, routing);
+	}
+
+	if (profile.has_value())
+	{
+		postgresql_backend->use_profile(profile.value());
+	}
+
+	postgresql_backend->create_pool();
+	this->backend = postgresql_backend;
 }
 
 __ORM_POSTGRESQL_END__
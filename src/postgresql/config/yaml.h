@@ -13,6 +13,7 @@
 // C++ libraries.
 #include <string>
 #include <memory>
+#include <vector>
 
 // Base libraries.
 #include <xalwart.base/config/components/yaml/default.h>
@@ -23,12 +24,41 @@
 
 // Orm libraries.
 #include "../credentials.h"
+#include "../backend.h"
+#include "../../config/yaml.h"
 
 
 __ORM_POSTGRESQL_BEGIN__
 
+// TESTME: YAMLPostgreSQLReplicasComponent
+// Parses the list of replicas. Each item accepts 'name', 'user',
+// 'password', 'host', 'port' and 'connections' like the primary
+// server. Omitted credentials are taken from the primary server
+// by 'YAMLPostgreSQLComponent'.
+class YAMLPostgreSQLReplicasComponent : public xw::config::YAMLSequenceComponent
+{
+public:
+	explicit inline YAMLPostgreSQLReplicasComponent(std::vector<Replica>& replicas) : YAMLSequenceComponent(
+		[this](const YAML::Node& node)
+		{
+			this->handle_replica(node);
+		}
+	), replicas(replicas)
+	{
+	}
+
+protected:
+	std::vector<Replica>& replicas;
+
+	void handle_replica(const YAML::Node& node) const;
+};
+
 // TESTME: YAMLPostgreSQLComponent
 // TODO: docs for 'YAMLPostgreSQLComponent'
+//
+// 'replicas' lists servers which serve 'Repository::select', check
+// 'YAMLPostgreSQLReplicasComponent'. 'replica_routing' is either
+// "least-loaded" (default) or "round-robin".
 class YAMLPostgreSQLComponent : public xw::config::YAMLMapComponent
 {
 public:
@@ -41,7 +71,20 @@ public:
 		);
 		this->register_component("host", std::make_unique<xw::config::YAMLScalarComponent>(this->credentials.host));
 		this->register_component("port", std::make_unique<xw::config::YAMLScalarComponent>(this->credentials.port));
-		this->register_component("connections", std::make_unique<xw::config::YAMLScalarComponent>(this->pool_size));
+		this->register_component(
+			"connections", std::make_unique<orm::config::YAMLPoolComponent>(this->pool_options)
+		);
+		this->register_component(
+			"statements_cache", std::make_unique<xw::config::YAMLScalarComponent>(this->statements_cache_size)
+		);
+		this->register_component(
+			"binary_results", std::make_unique<xw::config::YAMLScalarComponent>(this->binary_results)
+		);
+		this->register_component("profile", std::make_unique<xw::config::YAMLScalarComponent>(this->profile));
+		this->register_component("replicas", std::make_unique<YAMLPostgreSQLReplicasComponent>(this->replicas));
+		this->register_component(
+			"replica_routing", std::make_unique<xw::config::YAMLScalarComponent>(this->replica_routing)
+		);
 	}
 
 	void initialize(const YAML::Node& node) const override;
@@ -50,7 +93,24 @@ protected:
 	std::shared_ptr<IBackend>& backend;
 
 	PostgreSQLCredentials credentials;
-	long pool_size = 3;
+	// Check 'YAMLPoolComponent' for details.
+	PoolOptions pool_options = PoolOptions(3);
+
+	// Maximum number of prepared statements registered on
+	// each connection, zero disables preparing.
+	long statements_cache_size = 32;
+
+	// Receive results of prepared statements in binary format.
+	bool binary_results = false;
+
+	// Name of session settings for connections, empty keeps defaults
+	// of the server. Check 'postgresql::Profile::from_name'.
+	std::string profile;
+
+	// Credentials of replicas are completed by 'initialize'.
+	std::vector<Replica> replicas;
+
+	std::string replica_routing = "least-loaded";
 };
 
 __ORM_POSTGRESQL_END__
@@ -8,11 +8,126 @@
 
 #ifdef USE_POSTGRESQL
 
+// C++ libraries.
+#include <algorithm>
+#include <exception>
+#include <cstring>
+#include <cstdint>
+#include <charconv>
+#include <unordered_set>
+#include <string_view>
+
+// POSIX
+#include <poll.h>
+
 
 __ORM_POSTGRESQL_BEGIN__
 
-PostgreSQLConnection::PostgreSQLConnection(const PostgreSQLCredentials& credentials) :
-	in_transaction(false)
+class PostgreSQLConnection::Cursor final : public ISQLCursor
+{
+public:
+	inline Cursor(
+		const PostgreSQLConnection* connection, const std::string& query, const std::vector<db::Parameter>& parameters
+	) : connection(connection), row(columns, nullptr)
+	{
+		connection->send_streamed(query, parameters, connection->binary_results);
+		this->is_running = true;
+	}
+
+	inline ~Cursor() override
+	{
+		PQclear(this->result);
+		if (this->is_running)
+		{
+			// All results must be read before the next query can be
+			// sent, the rest rows are discarded.
+			this->connection->cancel_query();
+			while (auto* res = PQgetResult(this->connection->db.get()))
+			{
+				PQclear(res);
+			}
+		}
+	}
+
+	const db::Row* next() override
+	{
+		while (this->is_running)
+		{
+			if (this->result && this->row_index < PQntuples(this->result))
+			{
+				if (!this->has_columns)
+				{
+					this->columns = columns_of(this->result, false);
+					this->has_columns = true;
+				}
+
+				// Text values refer to the result, so it is kept
+				// until the next call.
+				read_values(this->result, this->row_index++, this->values);
+				this->row = db::Row(this->columns, this->values.data());
+				return &this->row;
+			}
+
+			PQclear(this->result);
+			this->result = nullptr;
+			this->row_index = 0;
+			auto* res = PQgetResult(this->connection->db.get());
+			if (!res)
+			{
+				this->is_running = false;
+				break;
+			}
+
+			auto result_status = PQresultStatus(res);
+			if (has_rows(result_status))
+			{
+				this->result = res;
+				continue;
+			}
+
+			if (
+				(result_status == PGRES_FATAL_ERROR || result_status == PGRES_BAD_RESPONSE) &&
+				this->error_message.empty()
+			)
+			{
+				this->error_message = PQresultErrorMessage(res);
+			}
+
+			PQclear(res);
+		}
+
+		if (!this->error_message.empty())
+		{
+			auto message = std::move(this->error_message);
+			this->error_message.clear();
+			this->connection->rollback_transaction();
+			throw SQLError(message, _ERROR_DETAILS_);
+		}
+
+		return nullptr;
+	}
+
+private:
+	const PostgreSQLConnection* connection;
+	bool is_running = false;
+	PGresult* result = nullptr;
+	int row_index = 0;
+	std::string error_message;
+	bool has_columns = false;
+	db::Columns columns;
+	std::vector<db::Value> values;
+	db::Row row;
+};
+
+PostgreSQLConnection::PostgreSQLConnection(
+	const PostgreSQLCredentials& credentials, size_t statements_cache_size, bool binary_results,
+	std::shared_ptr<Reactor> reactor
+) : in_transaction(false), binary_results(binary_results),
+	statements(statements_cache_size, [this](const std::string&, PreparedStatement& statement)
+	{
+		this->evicted_statements.push_back(std::move(statement.name));
+	}),
+	reactor(std::move(reactor))
 {
 	credentials.validate();
 	this->db.reset(
@@ -24,26 +139,47 @@ PostgreSQLConnection::PostgreSQLConnection(const PostgreSQLCredentials& credenti
 			credentials.user.c_str(),
 			credentials.password.c_str()
 		),
-		[&](PGconn* conn)
+		[](PGconn* conn)
 		{
-			try
-			{
-				if (this->in_transaction)
-				{
-					this->rollback_transaction();
-				}
-			}
-			catch (std::exception& exc)
-			{
-				PQfinish(conn);
-				throw;
-			}
+			PQfinish(conn);
 		}
 	);
 
-	if (PQstatus(this->db.get()) != CONNECTION_OK && PQsetnonblocking(this->db.get(), 1) != 0 )
+	if (PQstatus(this->db.get()) != CONNECTION_OK || PQsetnonblocking(this->db.get(), 1) != 0)
+	{
+		throw DatabaseError(PQerrorMessage(this->db.get()), _ERROR_DETAILS_);
+	}
+}
+
+PostgreSQLConnection::PostgreSQLConnection(
+	const PostgreSQLCredentials& credentials, size_t statements_cache_size, bool binary_results,
+	ReactorProvider reactor_provider
+) : PostgreSQLConnection(credentials, statements_cache_size, binary_results, std::shared_ptr<Reactor>())
+{
+	this->reactor_provider = std::move(reactor_provider);
+}
+
+PostgreSQLConnection::~PostgreSQLConnection()
+{
+	// The handler of the unfinished query refers to the connection.
+	if (this->is_async_query_running && this->reactor)
+	{
+		this->reactor->unwatch(PQsocket(this->db.get()));
+	}
+
+	// Prepared statements are released together with the session.
+	this->statements.discard();
+	if (this->in_transaction)
 	{
-		throw DatabaseError(PQerrorMessage(this->db.get()));
+		// Errors are ignored: the server rolls back the transaction
+		// when the session is closed anyway.
+		try
+		{
+			this->rollback_transaction();
+		}
+		catch (...)
+		{
+		}
 	}
 }
 
@@ -64,62 +200,1339 @@ void PostgreSQLConnection::run_query(
 	}
 }
 
-void PostgreSQLConnection::run_query(const std::string& sql_query, std::string& last_row_id) const
+void PostgreSQLConnection::run_query(const std::string& sql_query, std::string& /* last_row_id */) const
 {
 	this->run_query(sql_query, nullptr, nullptr);
 }
 
-void PostgreSQLConnection::run_query_unsafe(
-	const std::string& query,
-	std::function<void(const std::map<std::string, char*>&)> map_handler,
-	std::function<void(const std::vector<char*>&)> vector_handler
+void PostgreSQLConnection::run_query(
+	const std::string& sql_query,
+	const std::vector<db::Parameter>& parameters,
+	const std::function<void(const std::map<std::string, char*>& /* columns */)>& map_handler,
+	const std::function<void(const std::vector<char*>& /* columns */)>& vector_handler
 ) const
 {
-	if (query.empty())
+	try
 	{
-		this->throw_empty_arg("query", _ERROR_DETAILS_);
+		this->run_query_unsafe(sql_query, map_handler, vector_handler, parameters, !parameters.empty());
+	}
+	catch (const std::exception& exc)
+	{
+		this->rollback_transaction();
+		throw;
 	}
+}
 
-	auto res = PQexec(this->db.get(), query.c_str());
-	auto result_status = PQresultStatus(res);
-	if (result_status == PGRES_TUPLES_OK)
+void PostgreSQLConnection::run_query(
+	const std::string& sql_query, const std::vector<db::Parameter>& parameters, std::string& /* last_row_id */
+) const
+{
+	this->run_query(sql_query, parameters, nullptr, nullptr);
+}
+
+std::vector<size_t> PostgreSQLConnection::run_batch(const std::vector<db::Statement>& statements) const
+{
+	if (statements.empty())
+	{
+		return {};
+	}
+
+	try
 	{
-		if (map_handler || vector_handler)
+#ifdef LIBPQ_HAS_PIPELINING
+		return this->execute_pipeline(statements);
+#else
+		std::vector<size_t> affected_rows;
+		affected_rows.reserve(statements.size());
+		auto is_own_transaction = !this->in_transaction;
+		this->begin_transaction();
+		for (size_t i = 0; i < statements.size(); i++)
 		{
-			auto fields_count = PQnfields(res);
-			auto tuples_count = PQntuples(res);
-			for (auto i = 0; i < tuples_count; i++)
+			PGresult* res;
+			try
 			{
-				if (map_handler)
+				res = this->execute(
+					statements[i].sql, statements[i].parameters, false, !statements[i].parameters.empty()
+				);
+			}
+			catch (const SQLError& exc)
+			{
+				throw SQLError("statement #" + std::to_string(i) + ": " + exc.what(), _ERROR_DETAILS_);
+			}
+
+			affected_rows.push_back(PostgreSQLConnection::affected_rows(res));
+			PQclear(res);
+		}
+
+		if (is_own_transaction)
+		{
+			this->end_transaction();
+		}
+
+		return affected_rows;
+#endif
+	}
+	catch (const std::exception& exc)
+	{
+		this->rollback_transaction();
+		throw;
+	}
+}
+
+void PostgreSQLConnection::run_query_async(
+	const std::string& sql_query,
+	const std::vector<db::Parameter>& parameters,
+	db::RowHandler row_handler,
+	completion_handler completion
+) const
+{
+	if (!completion)
+	{
+		this->throw_empty_arg("completion", _ERROR_DETAILS_);
+	}
+
+	if (this->is_async_query_running.exchange(true))
+	{
+		completion(std::make_exception_ptr(
+			DatabaseError("Connection is busy with other asynchronous query", _ERROR_DETAILS_)
+		));
+		return;
+	}
+
+	std::shared_ptr<AsyncQuery> query;
+	try
+	{
+		this->prepare_connection(sql_query);
+		this->ensure_reactor();
+
+		int is_sent;
+		if (parameters.empty())
+		{
+			is_sent = PQsendQuery(this->db.get(), sql_query.c_str());
+		}
+		else
+		{
+			std::vector<std::string> values;
+			auto values_pointers = parameters_as_text(parameters, values);
+			is_sent = PQsendQueryParams(
+				this->db.get(), sql_query.c_str(), (int)parameters.size(),
+				nullptr, values_pointers.data(), nullptr, nullptr, 0
+			);
+		}
+
+		if (!is_sent)
+		{
+			throw SQLError(PQerrorMessage(this->db.get()), _ERROR_DETAILS_);
+		}
+
+		query = std::make_shared<AsyncQuery>();
+		query->row_handler = std::move(row_handler);
+		query->completion = std::move(completion);
+	}
+	catch (...)
+	{
+		this->is_async_query_running = false;
+		completion(std::current_exception());
+		return;
+	}
+
+	this->continue_async_query(query);
+}
+
+void PostgreSQLConnection::run_batch_async(
+	const std::vector<db::Statement>& statements, [[maybe_unused]] bool in_transaction, completion_handler completion
+) const
+{
+#ifdef LIBPQ_HAS_PIPELINING
+	if (!completion)
+	{
+		this->throw_empty_arg("completion", _ERROR_DETAILS_);
+	}
+
+	if (statements.empty())
+	{
+		completion(nullptr);
+		return;
+	}
+
+	if (this->is_async_query_running.exchange(true))
+	{
+		completion(std::make_exception_ptr(
+			DatabaseError("Connection is busy with other asynchronous query", _ERROR_DETAILS_)
+		));
+		return;
+	}
+
+	std::shared_ptr<AsyncQuery> query;
+	try
+	{
+		for (const auto& statement : statements)
+		{
+			this->prepare_connection(statement.sql);
+		}
+
+		this->ensure_reactor();
+
+		if (!PQenterPipelineMode(this->db.get()))
+		{
+			throw DatabaseError(PQerrorMessage(this->db.get()), _ERROR_DETAILS_);
+		}
+
+		// Statements are not prepared on the server, because preparing
+		// waits for the result.
+		for (const auto& statement : statements)
+		{
+			std::vector<std::string> values;
+			auto values_pointers = parameters_as_text(statement.parameters, values);
+			auto is_sent = PQsendQueryParams(
+				this->db.get(), statement.sql.c_str(), (int)statement.parameters.size(),
+				nullptr, values_pointers.data(), nullptr, nullptr, 0
+			);
+			if (!is_sent)
+			{
+				auto message = std::string(PQerrorMessage(this->db.get()));
+				throw SQLError(message, _ERROR_DETAILS_);
+			}
+		}
+
+		if (!PQpipelineSync(this->db.get()))
+		{
+			throw DatabaseError(PQerrorMessage(this->db.get()), _ERROR_DETAILS_);
+		}
+
+		query = std::make_shared<AsyncQuery>();
+		query->is_pipeline = true;
+		query->completion = std::move(completion);
+	}
+	catch (...)
+	{
+		// Statements which are sent already are discarded with the
+		// state of the connection.
+		if (PQpipelineStatus(this->db.get()) != PQ_PIPELINE_OFF && !PQexitPipelineMode(this->db.get()))
+		{
+			try
+			{
+				this->reset();
+			}
+			catch (...)
+			{
+				// The error of the batch is passed instead, the lost
+				// connection is restored by the next query.
+			}
+		}
+
+		this->is_async_query_running = false;
+		completion(std::current_exception());
+		return;
+	}
+
+	this->continue_async_query(query);
+#else
+	IAsyncSQLConnection::run_batch_async(statements, in_transaction, std::move(completion));
+#endif
+}
+
+void PostgreSQLConnection::copy_rows(
+	const std::string& table_name,
+	const std::string& columns,
+	const std::list<std::vector<db::Parameter>>& rows
+) const
+{
+	if (table_name.empty())
+	{
+		this->throw_empty_arg("table_name", _ERROR_DETAILS_);
+	}
+
+	if (columns.empty())
+	{
+		this->throw_empty_arg("columns", _ERROR_DETAILS_);
+	}
+
+	try
+	{
+		PQclear(this->execute(
+			"COPY " + util::quote_str(table_name) + " (" + columns + ") FROM STDIN;", {}, false, false
+		));
+
+		// Connection stays in copy mode until the end of copying is
+		// sent, so failures of sending abort the copying instead of
+		// leaving it unfinished.
+		std::string error_message;
+		try
+		{
+			std::string buffer;
+			buffer.reserve(COPY_CHUNK_SIZE * 2);
+			for (const auto& row : rows)
+			{
+				for (size_t i = 0; i < row.size(); i++)
 				{
-					std::map<std::string, char*> result;
-					for (auto j = 0; j < fields_count; j++)
+					if (i)
 					{
-						result[PQfname(res, j)] = PQgetvalue(res, i, j);
+						buffer += '\t';
 					}
 
-					map_handler(result);
+					append_copy_value(buffer, row[i]);
 				}
-				else if (vector_handler)
-				{
-					std::vector<char*> result;
-					result.reserve(fields_count);
-					for (auto j = 0; j < fields_count; j++)
-					{
-						result.push_back(PQgetvalue(res, i, j));
-					}
 
-					vector_handler(result);
+				buffer += '\n';
+				if (buffer.size() >= COPY_CHUNK_SIZE)
+				{
+					this->put_copy_data(buffer);
+					buffer.clear();
 				}
 			}
+
+			if (!buffer.empty())
+			{
+				this->put_copy_data(buffer);
+			}
+		}
+		catch (const std::exception& exc)
+		{
+			error_message = exc.what();
+		}
+
+		auto copy_error = this->end_copy(error_message);
+		if (!error_message.empty())
+		{
+			throw DatabaseError(error_message, _ERROR_DETAILS_);
+		}
+
+		if (!copy_error.empty())
+		{
+			throw SQLError(copy_error, _ERROR_DETAILS_);
 		}
 	}
-	else if (result_status == PGRES_FATAL_ERROR)
+	catch (const std::exception& exc)
+	{
+		this->rollback_transaction();
+		throw;
+	}
+}
+
+void PostgreSQLConnection::reset() const
+{
+	this->statements.discard();
+	this->evicted_statements.clear();
+	this->in_transaction = false;
+	PQreset(this->db.get());
+	if (PQstatus(this->db.get()) != CONNECTION_OK)
 	{
-		throw SQLError(PQresultErrorMessage(res), _ERROR_DETAILS_);
+		throw DatabaseError(PQerrorMessage(this->db.get()), _ERROR_DETAILS_);
 	}
 
-	PQclear(res);
+	this->is_reset_pending = false;
+	if (this->on_reconnect)
+	{
+		try
+		{
+			this->on_reconnect();
+		}
+		catch (...)
+		{
+			this->is_reset_pending = true;
+			throw;
+		}
+	}
+}
+
+void PostgreSQLConnection::run_typed_query(
+	const std::string& sql_query,
+	const std::vector<db::Parameter>& parameters,
+	const db::RowHandler& row_handler,
+	bool is_streamed
+) const
+{
+	// Streamed rows of the same result set come in separate
+	// results, so names of columns are read only once.
+	db::Columns columns;
+	bool has_columns = false;
+	std::vector<db::Value> values;
+	auto reader = [&](const PGresult* result, int row) -> bool
+	{
+		if (!row_handler)
+		{
+			return true;
+		}
+
+		if (!has_columns)
+		{
+			columns = columns_of(result, !is_streamed);
+			has_columns = true;
+		}
+
+		read_values(result, row, values);
+		return row_handler(db::Row(columns, values.data()));
+	};
+	try
+	{
+		if (is_streamed)
+		{
+			this->execute_streamed(sql_query, parameters, this->binary_results, reader);
+		}
+		else
+		{
+			auto* res = this->execute(sql_query, parameters, this->binary_results, true);
+			try
+			{
+				auto tuples_count = PQntuples(res);
+				for (auto i = 0; i < tuples_count && reader(res, i); i++);
+			}
+			catch (const std::exception& exc)
+			{
+				PQclear(res);
+				throw;
+			}
+
+			PQclear(res);
+		}
+	}
+	catch (const std::exception& exc)
+	{
+		this->rollback_transaction();
+		throw;
+	}
+}
+
+std::unique_ptr<ISQLCursor> PostgreSQLConnection::open_cursor(
+	const std::string& sql_query, const std::vector<db::Parameter>& parameters
+) const
+{
+	try
+	{
+		return std::make_unique<Cursor>(this, sql_query, parameters);
+	}
+	catch (const std::exception& exc)
+	{
+		this->rollback_transaction();
+		throw;
+	}
+}
+
+void PostgreSQLConnection::run_query_unsafe(
+	const std::string& query,
+	std::function<void(const std::map<std::string, char*>&)> map_handler,
+	std::function<void(const std::vector<char*>&)> vector_handler,
+	const std::vector<db::Parameter>& parameters,
+	bool is_prepared
+) const
+{
+	auto* res = this->execute(query, parameters, false, is_prepared);
+	if (PQresultStatus(res) == PGRES_TUPLES_OK && (map_handler || vector_handler))
+	{
+		auto fields_count = PQnfields(res);
+		auto tuples_count = PQntuples(res);
+		try
+		{
+			for (auto i = 0; i < tuples_count; i++)
+			{
+				if (map_handler)
+				{
+					map_handler(row_as_map(res, i));
+				}
+				else if (vector_handler)
+				{
+					std::vector<char*> result;
+					result.reserve(fields_count);
+					for (auto j = 0; j < fields_count; j++)
+					{
+						result.push_back(PQgetvalue(res, i, j));
+					}
+
+					vector_handler(result);
+				}
+			}
+		}
+		catch (const std::exception& exc)
+		{
+			PQclear(res);
+			throw;
+		}
+	}
+
+	PQclear(res);
+}
+
+void PostgreSQLConnection::prepare_connection(const std::string& query) const
+{
+	if (query.empty())
+	{
+		this->throw_empty_arg("query", _ERROR_DETAILS_);
+	}
+
+	// Connection can be lost while it waits in the pool. It is safe
+	// to reconnect only if there is no transaction in progress.
+	if ((PQstatus(this->db.get()) == CONNECTION_BAD || this->is_reset_pending) && !this->in_transaction)
+	{
+		this->reset();
+	}
+}
+
+PGresult* PostgreSQLConnection::execute(
+	const std::string& query, const std::vector<db::Parameter>& parameters, bool is_binary, bool is_prepared
+) const
+{
+	this->prepare_connection(query);
+	std::vector<std::string> values;
+	auto values_pointers = parameters_as_text(parameters, values);
+	PGresult* res;
+	auto parameters_count = (int)parameters.size();
+	if (is_prepared && this->is_preparable(query))
+	{
+		auto statement = this->prepare_statement(query);
+		res = PQexecPrepared(
+			this->db.get(), statement.name.c_str(), parameters_count, values_pointers.data(), nullptr, nullptr,
+			is_binary && statement.is_binary_safe ? 1 : 0
+		);
+	}
+	else if (parameters_count)
+	{
+		res = PQexecParams(
+			this->db.get(), query.c_str(), parameters_count, nullptr, values_pointers.data(), nullptr, nullptr, 0
+		);
+	}
+	else
+	{
+		res = PQexec(this->db.get(), query.c_str());
+	}
+
+	auto result_status = PQresultStatus(res);
+	if (!res || result_status == PGRES_FATAL_ERROR || result_status == PGRES_BAD_RESPONSE)
+	{
+		auto message = std::string(res ? PQresultErrorMessage(res) : PQerrorMessage(this->db.get()));
+		PQclear(res);
+		throw SQLError(message, _ERROR_DETAILS_);
+	}
+
+	return res;
+}
+
+void PostgreSQLConnection::send_streamed(
+	const std::string& query, const std::vector<db::Parameter>& parameters, bool is_binary
+) const
+{
+	this->prepare_connection(query);
+	std::vector<std::string> values;
+	auto values_pointers = parameters_as_text(parameters, values);
+	this->is_streamed_in_transaction = PQtransactionStatus(this->db.get()) != PQTRANS_IDLE;
+	int is_sent;
+	if (this->is_preparable(query))
+	{
+		auto statement = this->prepare_statement(query);
+		is_sent = PQsendQueryPrepared(
+			this->db.get(), statement.name.c_str(), (int)parameters.size(), values_pointers.data(), nullptr, nullptr,
+			is_binary && statement.is_binary_safe ? 1 : 0
+		);
+	}
+	else
+	{
+		is_sent = PQsendQueryParams(
+			this->db.get(), query.c_str(), (int)parameters.size(), nullptr, values_pointers.data(), nullptr, nullptr, 0
+		);
+	}
+
+	if (!is_sent)
+	{
+		throw SQLError(PQerrorMessage(this->db.get()), _ERROR_DETAILS_);
+	}
+
+	// Rows are received in small results instead of a single one
+	// which contains the whole table. If the mode can not be set,
+	// the result is still processed correctly, but buffered.
+#ifdef LIBPQ_HAS_CHUNK_MODE
+	PQsetChunkedRowsMode(this->db.get(), STREAM_CHUNK_SIZE);
+#else
+	PQsetSingleRowMode(this->db.get());
+#endif
+	this->flush();
+}
+
+void PostgreSQLConnection::execute_streamed(
+	const std::string& query, const std::vector<db::Parameter>& parameters, bool is_binary, const row_reader& reader
+) const
+{
+	this->send_streamed(query, parameters, is_binary);
+
+	// All results must be read before the next query can be sent,
+	// even if the reader stops reading or throws an exception.
+	bool is_stopped = false;
+	std::exception_ptr reader_exception = nullptr;
+	std::string error_message;
+	while (auto* res = PQgetResult(this->db.get()))
+	{
+		auto result_status = PQresultStatus(res);
+		if (has_rows(result_status))
+		{
+			auto tuples_count = PQntuples(res);
+			for (auto i = 0; i < tuples_count && !is_stopped; i++)
+			{
+				try
+				{
+					is_stopped = reader && !reader(res, i);
+				}
+				catch (...)
+				{
+					reader_exception = std::current_exception();
+					is_stopped = true;
+				}
+
+				if (is_stopped)
+				{
+					this->cancel_query();
+				}
+			}
+		}
+		else if (
+			(result_status == PGRES_FATAL_ERROR || result_status == PGRES_BAD_RESPONSE) &&
+			!is_stopped && error_message.empty()
+		)
+		{
+			error_message = PQresultErrorMessage(res);
+		}
+
+		PQclear(res);
+	}
+
+	if (reader_exception)
+	{
+		std::rethrow_exception(reader_exception);
+	}
+
+	if (!error_message.empty())
+	{
+		throw SQLError(error_message, _ERROR_DETAILS_);
+	}
+}
+
+#ifdef LIBPQ_HAS_PIPELINING
+std::vector<size_t> PostgreSQLConnection::execute_pipeline(const std::vector<db::Statement>& statements) const
+{
+	for (const auto& statement : statements)
+	{
+		this->prepare_connection(statement.sql);
+	}
+
+	// Statements are prepared before entering the pipeline, because
+	// preparing waits for the server. Statements of the batch must
+	// not evict each other from the cache, otherwise they would be
+	// deallocated before the pipeline is sent. Statements without
+	// parameters have values inlined, so they are not prepared.
+	std::unordered_set<std::string_view> preparable_queries;
+	for (const auto& statement : statements)
+	{
+		if (!statement.parameters.empty() && this->is_preparable(statement.sql))
+		{
+			preparable_queries.insert(statement.sql);
+		}
+	}
+
+	std::vector<std::string> statement_names(statements.size());
+	if (preparable_queries.size() <= this->statements.capacity())
+	{
+		for (size_t i = 0; i < statements.size(); i++)
+		{
+			if (preparable_queries.contains(statements[i].sql))
+			{
+				statement_names[i] = this->prepare_statement(statements[i].sql).name;
+			}
+		}
+	}
+
+	if (!PQenterPipelineMode(this->db.get()))
+	{
+		throw DatabaseError(PQerrorMessage(this->db.get()), _ERROR_DETAILS_);
+	}
+
+	// Each statement which was sent must be read back even if
+	// sending of the rest ones failed.
+	std::string error_message;
+	size_t sent_count = 0;
+	for (; sent_count < statements.size(); sent_count++)
+	{
+		const auto& statement = statements[sent_count];
+		std::vector<std::string> values;
+		auto values_pointers = parameters_as_text(statement.parameters, values);
+		auto parameters_count = (int)statement.parameters.size();
+		int is_sent;
+		if (!statement_names[sent_count].empty())
+		{
+			is_sent = PQsendQueryPrepared(
+				this->db.get(), statement_names[sent_count].c_str(), parameters_count,
+				values_pointers.data(), nullptr, nullptr, 0
+			);
+		}
+		else
+		{
+			is_sent = PQsendQueryParams(
+				this->db.get(), statement.sql.c_str(), parameters_count,
+				nullptr, values_pointers.data(), nullptr, nullptr, 0
+			);
+		}
+
+		if (!is_sent)
+		{
+			error_message = PQerrorMessage(this->db.get());
+			break;
+		}
+	}
+
+	std::vector<size_t> affected_rows;
+	affected_rows.reserve(sent_count);
+	if (PQpipelineSync(this->db.get()))
+	{
+		this->flush();
+
+		// Results of each statement are terminated by nullptr. After
+		// the failed statement the server skips the rest ones, their
+		// results are 'PGRES_PIPELINE_ABORTED'.
+		for (size_t i = 0; i < sent_count; i++)
+		{
+			while (auto* res = PQgetResult(this->db.get()))
+			{
+				auto result_status = PQresultStatus(res);
+				if (result_status == PGRES_COMMAND_OK || result_status == PGRES_TUPLES_OK)
+				{
+					affected_rows.push_back(PostgreSQLConnection::affected_rows(res));
+				}
+				else if (
+					(result_status == PGRES_FATAL_ERROR || result_status == PGRES_BAD_RESPONSE) &&
+					error_message.empty()
+				)
+				{
+					error_message = "statement #" + std::to_string(i) + ": " + PQresultErrorMessage(res);
+				}
+
+				PQclear(res);
+			}
+		}
+
+		auto* sync_result = PQgetResult(this->db.get());
+		if (PQresultStatus(sync_result) != PGRES_PIPELINE_SYNC && error_message.empty())
+		{
+			error_message = PQerrorMessage(this->db.get());
+		}
+
+		PQclear(sync_result);
+	}
+	else if (error_message.empty())
+	{
+		error_message = PQerrorMessage(this->db.get());
+	}
+
+	if (!PQexitPipelineMode(this->db.get()) && error_message.empty())
+	{
+		error_message = PQerrorMessage(this->db.get());
+	}
+
+	if (!error_message.empty())
+	{
+		throw SQLError(error_message, _ERROR_DETAILS_);
+	}
+
+	return affected_rows;
+}
+#endif
+
+void PostgreSQLConnection::ensure_reactor() const
+{
+	if (!this->reactor)
+	{
+		this->reactor = this->reactor_provider ? this->reactor_provider() : std::make_shared<Reactor>();
+	}
+}
+
+void PostgreSQLConnection::continue_async_query(const std::shared_ptr<AsyncQuery>& query) const
+{
+	try
+	{
+		if (!this->read_async_results(query))
+		{
+			return;
+		}
+	}
+	catch (...)
+	{
+		query->error = std::current_exception();
+	}
+
+	// The flag is cleared before calling the handler, so the next
+	// query can be sent from it.
+	auto completion = std::move(query->completion);
+	this->is_async_query_running = false;
+	completion(query->error);
+}
+
+bool PostgreSQLConnection::read_async_results(const std::shared_ptr<AsyncQuery>& query) const
+{
+	auto* connection = this->db.get();
+
+	// Server can be blocked on sending of the results, so the
+	// input is consumed while the query is being sent.
+	auto flush_result = PQflush(connection);
+	if (flush_result < 0 || !PQconsumeInput(connection))
+	{
+		throw DatabaseError(PQerrorMessage(connection), _ERROR_DETAILS_);
+	}
+
+	unsigned events = Reactor::Readable | Reactor::Writable;
+	if (flush_result == 0)
+	{
+		events = Reactor::Readable;
+		while (!PQisBusy(connection))
+		{
+			auto* res = PQgetResult(connection);
+			if (!res)
+			{
+				if (!query->is_pipeline)
+				{
+					return true;
+				}
+
+				// Results of each statement of the pipeline are
+				// terminated by nullptr.
+				query->statement_index++;
+				continue;
+			}
+
+			auto result_status = PQresultStatus(res);
+#ifdef LIBPQ_HAS_PIPELINING
+			if (result_status == PGRES_PIPELINE_SYNC)
+			{
+				PQclear(res);
+				if (!PQexitPipelineMode(connection))
+				{
+					throw DatabaseError(PQerrorMessage(connection), _ERROR_DETAILS_);
+				}
+
+				return true;
+			}
+#endif
+			if (result_status == PGRES_FATAL_ERROR || result_status == PGRES_BAD_RESPONSE)
+			{
+				if (!query->error)
+				{
+					std::string message = PQresultErrorMessage(res);
+					if (query->is_pipeline)
+					{
+						message = "statement #" + std::to_string(query->statement_index) + ": " + message;
+					}
+
+					query->error = std::make_exception_ptr(SQLError(message, _ERROR_DETAILS_));
+				}
+			}
+			else if (result_status == PGRES_TUPLES_OK && query->row_handler && !query->error && !query->is_stopped)
+			{
+				try
+				{
+					query->columns = columns_of(res, true);
+					auto tuples_count = PQntuples(res);
+					for (auto i = 0; i < tuples_count && !query->is_stopped; i++)
+					{
+						read_values(res, i, query->values);
+						query->is_stopped = !query->row_handler(db::Row(query->columns, query->values.data()));
+					}
+				}
+				catch (...)
+				{
+					query->error = std::current_exception();
+				}
+			}
+
+			PQclear(res);
+		}
+	}
+
+	this->reactor->watch(PQsocket(connection), events, [this, query](unsigned) -> void {
+		this->continue_async_query(query);
+	});
+	return false;
+}
+
+bool PostgreSQLConnection::has_rows(ExecStatusType status)
+{
+#ifdef LIBPQ_HAS_CHUNK_MODE
+	if (status == PGRES_TUPLES_CHUNK)
+	{
+		return true;
+	}
+#endif
+	return status == PGRES_SINGLE_TUPLE || status == PGRES_TUPLES_OK;
+}
+
+size_t PostgreSQLConnection::affected_rows(const PGresult* result)
+{
+	// Empty for commands which do not change rows.
+	auto* text = PQcmdTuples(const_cast<PGresult*>(result));
+	size_t count = 0;
+	std::from_chars(text, text + std::strlen(text), count);
+	return count;
+}
+
+void PostgreSQLConnection::put_copy_data(const std::string& data) const
+{
+	int result;
+	while ((result = PQputCopyData(this->db.get(), data.data(), (int)data.size())) == 0)
+	{
+		// Output buffer of non-blocking connection is full.
+		this->flush();
+	}
+
+	if (result < 0)
+	{
+		throw DatabaseError(PQerrorMessage(this->db.get()), _ERROR_DETAILS_);
+	}
+}
+
+std::string PostgreSQLConnection::end_copy(const std::string& error_message) const
+{
+	int result;
+	auto* error = error_message.empty() ? nullptr : error_message.c_str();
+	while ((result = PQputCopyEnd(this->db.get(), error)) == 0)
+	{
+		this->flush();
+	}
+
+	if (result < 0)
+	{
+		throw DatabaseError(PQerrorMessage(this->db.get()), _ERROR_DETAILS_);
+	}
+
+	this->flush();
+	std::string copy_error;
+	while (auto* res = PQgetResult(this->db.get()))
+	{
+		if (PQresultStatus(res) != PGRES_COMMAND_OK && copy_error.empty())
+		{
+			copy_error = PQresultErrorMessage(res);
+		}
+
+		PQclear(res);
+	}
+
+	return copy_error;
+}
+
+void PostgreSQLConnection::append_copy_value(std::string& buffer, const db::Parameter& value)
+{
+	if (auto text = std::get_if<std::string>(&value.value))
+	{
+		// Delimiters and backslashes inside of the value must be
+		// escaped to not be treated as the end of the column or row.
+		for (auto symbol : *text)
+		{
+			switch (symbol)
+			{
+				case '\\':
+					buffer += "\\\\";
+					break;
+				case '\t':
+					buffer += "\\t";
+					break;
+				case '\n':
+					buffer += "\\n";
+					break;
+				case '\r':
+					buffer += "\\r";
+					break;
+				default:
+					buffer += symbol;
+					break;
+			}
+		}
+	}
+	else if (value.is_null())
+	{
+		buffer += "\\N";
+	}
+	else
+	{
+		char number[32];
+		std::to_chars_result result{};
+		if (auto integer = std::get_if<long long>(&value.value))
+		{
+			result = std::to_chars(number, number + sizeof(number), *integer);
+		}
+		else
+		{
+			result = std::to_chars(number, number + sizeof(number), std::get<double>(value.value));
+		}
+
+		buffer.append(number, result.ptr);
+	}
+}
+
+void PostgreSQLConnection::cancel_query() const
+{
+	// Cancelled statement aborts the whole transaction, so inside
+	// of it the rest rows are only received and discarded.
+	if (this->is_streamed_in_transaction)
+	{
+		return;
+	}
+
+	if (auto* cancel = PQgetCancel(this->db.get()))
+	{
+		// Errors are ignored: the rest rows are discarded anyway.
+		char error_buffer[256];
+		PQcancel(cancel, error_buffer, sizeof(error_buffer));
+		PQfreeCancel(cancel);
+	}
+}
+
+void PostgreSQLConnection::flush() const
+{
+	int result;
+	while ((result = PQflush(this->db.get())) == 1)
+	{
+		// Server can be blocked on sending of the results, so
+		// the input is consumed while waiting for the socket.
+		pollfd descriptor{PQsocket(this->db.get()), POLLIN | POLLOUT, 0};
+		if (poll(&descriptor, 1, -1) < 0 || ((descriptor.revents & POLLIN) && !PQconsumeInput(this->db.get())))
+		{
+			break;
+		}
+	}
+
+	if (result != 0)
+	{
+		throw DatabaseError(PQerrorMessage(this->db.get()), _ERROR_DETAILS_);
+	}
+}
+
+std::vector<const char*> PostgreSQLConnection::parameters_as_text(
+	const std::vector<db::Parameter>& parameters, std::vector<std::string>& values
+)
+{
+	// Parameters are sent in text format, the server infers
+	// their types from the statement.
+	std::vector<const char*> values_pointers;
+	values.reserve(parameters.size());
+	values_pointers.reserve(parameters.size());
+	for (const auto& parameter : parameters)
+	{
+		values.push_back(parameter.to_string());
+		values_pointers.push_back(parameter.is_null() ? nullptr : values.back().c_str());
+	}
+
+	return values_pointers;
+}
+
+db::Columns PostgreSQLConnection::columns_of(const PGresult* result, bool is_complete)
+{
+	auto fields_count = PQnfields(result);
+	std::vector<std::string> names;
+	names.reserve(fields_count);
+	for (auto i = 0; i < fields_count; i++)
+	{
+		names.emplace_back(PQfname(result, i));
+	}
+
+	return db::Columns(std::move(names), is_complete ? (size_t)PQntuples(result) : db::Columns::npos);
+}
+
+void PostgreSQLConnection::read_values(const PGresult* result, int row, std::vector<db::Value>& values)
+{
+	auto fields_count = PQnfields(result);
+	values.resize(fields_count);
+	for (auto i = 0; i < fields_count; i++)
+	{
+		auto& value = values[i];
+		if (PQgetisnull(result, row, i))
+		{
+			value = db::Value();
+			continue;
+		}
+
+		auto* data = PQgetvalue(result, row, i);
+		auto length = PQgetlength(result, row, i);
+		if (PQfformat(result, i) == 1)
+		{
+			value = decode_binary(data, length, PQftype(result, i));
+		}
+		else
+		{
+			value = db::Value(std::string_view(data, length));
+		}
+	}
+}
+
+bool PostgreSQLConnection::has_binary_decoder(Oid type, bool integer_datetimes)
+{
+	switch (type)
+	{
+		case TypeOid::Bool:
+		case TypeOid::Int2:
+		case TypeOid::Int4:
+		case TypeOid::Int8:
+		case TypeOid::Float4:
+		case TypeOid::Float8:
+		case TypeOid::Date:
+		case TypeOid::Char:
+		case TypeOid::Name:
+		case TypeOid::Text:
+		case TypeOid::BpChar:
+		case TypeOid::VarChar:
+			return true;
+		case TypeOid::Time:
+		case TypeOid::Timestamp:
+			// Very old servers can send time as floating point.
+			return integer_datetimes;
+		case TypeOid::TimestampTz:
+			// Binary value is in UTC, while the text is in the time zone
+			// of the session and the offset is not kept by fields, so it
+			// is read as text to get the same value either way.
+			return false;
+		default:
+			return false;
+	}
+}
+
+db::Value PostgreSQLConnection::decode_binary(const char* data, int length, Oid type)
+{
+	// Binary values are sent in network byte order.
+	auto read_integer = [data, length]() -> uint64_t
+	{
+		uint64_t result = 0;
+		for (auto i = 0; i < length; i++)
+		{
+			result = (result << 8) | (unsigned char)data[i];
+		}
+
+		return result;
+	};
+
+	// Days and microseconds are counted from 2000-01-01.
+	const long long microseconds_per_day = 86400000000LL;
+	switch (type)
+	{
+		case TypeOid::Bool:
+			return db::Value((long long)(data[0] != 0));
+		case TypeOid::Int2:
+			return db::Value((long long)(int16_t)read_integer());
+		case TypeOid::Int4:
+			return db::Value((long long)(int32_t)read_integer());
+		case TypeOid::Int8:
+			return db::Value((long long)(int64_t)read_integer());
+		case TypeOid::Float4:
+		{
+			auto bits = (uint32_t)read_integer();
+			float result;
+			std::memcpy(&result, &bits, sizeof(result));
+			return db::Value((double)result);
+		}
+		case TypeOid::Float8:
+		{
+			auto bits = read_integer();
+			double result;
+			std::memcpy(&result, &bits, sizeof(result));
+			return db::Value(result);
+		}
+		case TypeOid::Date:
+		{
+			auto days = (int32_t)read_integer();
+			if (days == INT32_MAX || days == INT32_MIN)
+			{
+				throw ValueError("infinite date is not supported", _ERROR_DETAILS_);
+			}
+
+			return db::Value(date_from_days(days));
+		}
+		case TypeOid::Time:
+		{
+			auto microseconds = (int64_t)read_integer();
+			return db::Value(time_from_microseconds(microseconds));
+		}
+		case TypeOid::Timestamp:
+		{
+			auto microseconds = (int64_t)read_integer();
+			if (microseconds == INT64_MAX || microseconds == INT64_MIN)
+			{
+				throw ValueError("infinite timestamp is not supported", _ERROR_DETAILS_);
+			}
+
+			auto days = microseconds / microseconds_per_day;
+			microseconds %= microseconds_per_day;
+			if (microseconds < 0)
+			{
+				days--;
+				microseconds += microseconds_per_day;
+			}
+
+			auto date = date_from_days(days);
+			auto time = time_from_microseconds(microseconds);
+			return db::Value(dt::Datetime(
+				date.year(), date.month(), date.day(),
+				time.hour(), time.minute(), time.second(), time.microsecond()
+			));
+		}
+		default:
+			// Text types are sent as is.
+			return db::Value(std::string_view(data, length));
+	}
+}
+
+dt::Date PostgreSQLConnection::date_from_days(long long days)
+{
+	// Converts days since 2000-01-01 to the civil date using
+	// the proleptic Gregorian calendar.
+	auto z = days + 730425;
+	auto era = (z >= 0 ? z : z - 146096) / 146097;
+	auto day_of_era = z - era * 146097;
+	auto year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+	auto day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+	auto month_index = (5 * day_of_year + 2) / 153;
+	auto day = (int)(day_of_year - (153 * month_index + 2) / 5 + 1);
+	auto month = (int)(month_index < 10 ? month_index + 3 : month_index - 9);
+	auto year = (int)(year_of_era + era * 400 + (month <= 2 ? 1 : 0));
+	return dt::Date(year, month, day);
+}
+
+dt::Time PostgreSQLConnection::time_from_microseconds(long long microseconds)
+{
+	auto seconds = microseconds / 1000000;
+	return dt::Time(
+		(int)(seconds / 3600), (int)(seconds / 60 % 60), (int)(seconds % 60), (int)(microseconds % 1000000)
+	);
+}
+
+std::map<std::string, char*> PostgreSQLConnection::row_as_map(const PGresult* result, int row)
+{
+	std::map<std::string, char*> map;
+	auto fields_count = PQnfields(result);
+	for (auto i = 0; i < fields_count; i++)
+	{
+		map[PQfname(result, i)] = PQgetvalue(result, row, i);
+	}
+
+	return map;
+}
+
+PostgreSQLConnection::PreparedStatement PostgreSQLConnection::prepare_statement(const std::string& sql_query) const
+{
+	auto statement = this->statements.take(sql_query);
+	if (statement.has_value())
+	{
+		this->cache_hits++;
+	}
+	else
+	{
+		this->cache_misses++;
+		this->deallocate_evicted_statements(DEALLOCATE_BATCH_SIZE);
+		statement = PreparedStatement{"xw_statement_" + std::to_string(++this->statements_counter)};
+		auto res = PQprepare(this->db.get(), statement->name.c_str(), sql_query.c_str(), 0, nullptr);
+		if (PQresultStatus(res) != PGRES_COMMAND_OK)
+		{
+			auto message = std::string(res ? PQresultErrorMessage(res) : PQerrorMessage(this->db.get()));
+			PQclear(res);
+			throw SQLError(message, _ERROR_DETAILS_);
+		}
+
+		PQclear(res);
+		if (this->binary_results)
+		{
+			// Result format is set for all columns at once, so binary
+			// format is used only if each column can be decoded.
+			auto description = PQdescribePrepared(this->db.get(), statement->name.c_str());
+			if (PQresultStatus(description) == PGRES_COMMAND_OK)
+			{
+				auto fields_count = PQnfields(description);
+				auto* integer_datetimes = PQparameterStatus(this->db.get(), "integer_datetimes");
+				auto has_integer_datetimes = integer_datetimes && std::string(integer_datetimes) == "on";
+				statement->is_binary_safe = true;
+				for (auto i = 0; i < fields_count && statement->is_binary_safe; i++)
+				{
+					statement->is_binary_safe = has_binary_decoder(PQftype(description, i), has_integer_datetimes);
+				}
+			}
+
+			PQclear(description);
+		}
+	}
+
+	this->statements.put(sql_query, statement.value());
+	return statement.value();
+}
+
+void PostgreSQLConnection::deallocate_evicted_statements(size_t min_count) const
+{
+	if (this->evicted_statements.empty() || this->evicted_statements.size() < min_count)
+	{
+		return;
+	}
+
+	// Failed 'DEALLOCATE' aborts the transaction of the caller, so
+	// statements are kept until the connection is outside of it.
+	if (PQtransactionStatus(this->db.get()) != PQTRANS_IDLE)
+	{
+		return;
+	}
+
+	std::string query;
+	for (const auto& name : this->evicted_statements)
+	{
+		query += "DEALLOCATE " + name + ";";
+	}
+
+	// Names are dropped even on failure: statements which were not
+	// deallocated are released by the server with the session.
+	this->evicted_statements.clear();
+	auto res = PQexec(this->db.get(), query.c_str());
+	if (PQresultStatus(res) != PGRES_COMMAND_OK)
+	{
+		auto message = std::string(res ? PQresultErrorMessage(res) : PQerrorMessage(this->db.get()));
+		PQclear(res);
+		throw SQLError(message, _ERROR_DETAILS_);
+	}
+
+	PQclear(res);
+}
+
+bool PostgreSQLConnection::is_preparable(const std::string& sql_query) const
+{
+	if (!this->statements.capacity())
+	{
+		return false;
+	}
+
+	// Transaction control and schema statements are executed as is.
+	auto begin = sql_query.find_first_not_of(" \t\r\n");
+	if (begin == std::string::npos)
+	{
+		return false;
+	}
+
+	auto keyword = sql_query.substr(begin, 6);
+	std::transform(keyword.begin(), keyword.end(), keyword.begin(), ::toupper);
+	if (keyword != "SELECT" && keyword != "INSERT" && keyword != "UPDATE" && keyword != "DELETE")
+	{
+		return false;
+	}
+
+	// Server can not prepare several statements at once, so the query
+	// should not contain a semicolon outside of literals and quoted
+	// identifiers, except the trailing one.
+	char quote = 0;
+	for (size_t i = begin; i < sql_query.size(); i++)
+	{
+		auto ch = sql_query[i];
+		if (quote)
+		{
+			if (ch == quote)
+			{
+				quote = 0;
+			}
+		}
+		else if (ch == '\'' || ch == '"')
+		{
+			quote = ch;
+		}
+		else if (ch == ';')
+		{
+			return sql_query.find_first_not_of(" \t\r\n", i + 1) == std::string::npos;
+		}
+	}
+
+	return true;
 }
 
 __ORM_POSTGRESQL_END__
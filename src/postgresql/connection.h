@@ -13,27 +13,65 @@
 // C++ libraries.
 #include <string>
 #include <functional>
+#include <memory>
+#include <atomic>
 
 // PostgreSQL
 #include <libpq-fe.h>
 
-// Base libraries.
-#include <xalwart.base/interfaces/orm.h>
-
 // Module definitions.
 #include "./_def_.h"
 
 // Orm libraries.
 #include "./credentials.h"
+#include "../interfaces.h"
 #include "../exceptions.h"
+#include "../utility.h"
+#include "../reactor.h"
 
 
 __ORM_POSTGRESQL_BEGIN__
 
-class PostgreSQLConnection : public IDatabaseConnection
+class PostgreSQLConnection : public ISQLConnection, public IBulkCopyConnection, public IAsyncSQLConnection
 {
 public:
-	explicit PostgreSQLConnection(const PostgreSQLCredentials& credentials);
+	// 'statements_cache_size' is the maximum number of server-side
+	// prepared statements registered on the connection. Zero disables
+	// preparing of statements. Single 'SELECT', 'INSERT', 'UPDATE'
+	// and 'DELETE' statements are prepared only if they are run by
+	// methods with parameters: 'run_typed_query' and 'open_cursor'
+	// with or without parameters, 'run_query' and 'run_batch' if the
+	// statement has them. Queries with inlined values, which are run
+	// by 'run_query' without parameters, are sent as they are, so
+	// one-off statements do not evict the ones which are reused.
+	//
+	// 'binary_results' enables receiving of prepared statements'
+	// results in binary format by 'run_typed_query'. It is used only
+	// if each column of the result has a binary decoder. Results of
+	// queries which are not prepared, i.e. all queries when
+	// 'statements_cache_size' is zero and scripts with several
+	// statements, are always received as text.
+	//
+	// 'reactor' waits for results of asynchronous queries, it can be
+	// shared by many connections. If it is nullptr, the connection
+	// starts its own reactor on the first asynchronous query.
+	explicit PostgreSQLConnection(
+		const PostgreSQLCredentials& credentials, size_t statements_cache_size=32, bool binary_results=false,
+		std::shared_ptr<Reactor> reactor=nullptr
+	);
+
+	// Returns the reactor which is shared by connections.
+	using ReactorProvider = std::function<std::shared_ptr<Reactor>()>;
+
+	// Acts like the constructor above, but the reactor is requested
+	// from 'reactor_provider' on the first asynchronous query, so it
+	// is not started while only synchronous queries are run.
+	PostgreSQLConnection(
+		const PostgreSQLCredentials& credentials, size_t statements_cache_size, bool binary_results,
+		ReactorProvider reactor_provider
+	);
+
+	~PostgreSQLConnection() override;
 
 	[[nodiscard]]
 	inline std::string dbms_name() const final
@@ -54,6 +92,87 @@ public:
 
 	void run_query(const std::string& sql_query, std::string& last_row_id) const override;
 
+	// Acts like 'run_query' above, but sends 'parameters' separately
+	// from the query text. Placeholders are '$1', '$2', ...
+	void run_query(
+		const std::string& sql_query,
+		const std::vector<db::Parameter>& parameters,
+		const std::function<void(const std::map<std::string, char*>& /* columns */)>& map_handler,
+		const std::function<void(const std::vector<char*>& /* columns */)>& vector_handler
+	) const override;
+
+	void run_query(
+		const std::string& sql_query, const std::vector<db::Parameter>& parameters, std::string& last_row_id
+	) const override;
+
+	// Numbers, booleans, dates and times are decoded from binary
+	// format if binary results are enabled, other columns and all
+	// columns of text results are passed as text.
+	void run_typed_query(
+		const std::string& sql_query,
+		const std::vector<db::Parameter>& parameters,
+		const db::RowHandler& row_handler,
+		bool is_streamed=false
+	) const override;
+
+	// Sends all statements in pipeline mode followed by a single
+	// synchronization point, so the batch costs one network round
+	// trip. Outside of the transaction the server runs the pipeline
+	// as an implicit one. If libpq does not support pipelining,
+	// statements are run one by one inside of the transaction.
+	//
+	// Throws 'SQLError' with the index of the first failed statement.
+	std::vector<size_t> run_batch(const std::vector<db::Statement>& statements) const override;
+
+	// Rows are received like in 'run_typed_query' with 'is_streamed'
+	// set to true. Destroying of the cursor before the last row asks
+	// the server to cancel the query, check 'cancel_query'.
+	[[nodiscard]]
+	std::unique_ptr<ISQLCursor> open_cursor(
+		const std::string& sql_query, const std::vector<db::Parameter>& parameters
+	) const override;
+
+	// Sends the query without waiting for the socket, the rest of the
+	// query and results are handled by the reactor. If 'parameters'
+	// are empty, the query can contain several statements which are
+	// run as a single transaction. Results are received in text format.
+	//
+	// Throws 'QueryError' if 'completion' is nullptr.
+	void run_query_async(
+		const std::string& sql_query,
+		const std::vector<db::Parameter>& parameters,
+		db::RowHandler row_handler,
+		completion_handler completion
+	) const override;
+
+	// Sends all statements in pipeline mode like 'run_batch', results
+	// are handled by the reactor like in 'run_query_async'. Outside of
+	// the transaction the server runs the pipeline as an implicit one,
+	// so 'in_transaction' is not needed. If libpq does not support
+	// pipelining, statements are sent one by one.
+	void run_batch_async(
+		const std::vector<db::Statement>& statements, bool in_transaction, completion_handler completion
+	) const override;
+
+	// Loads rows using 'COPY ... FROM STDIN' in text format. Rows are
+	// encoded directly into the buffer which is sent to the server by
+	// chunks of 'COPY_CHUNK_SIZE' bytes.
+	//
+	// Throws 'SQLError' if the server rejects the data.
+	void copy_rows(
+		const std::string& table_name,
+		const std::string& columns,
+		const std::list<std::vector<db::Parameter>>& rows
+	) const override;
+
+	// Limit of the protocol: number of parameters is sent
+	// as 16-bit integer.
+	[[nodiscard]]
+	inline size_t max_parameters() const override
+	{
+		return 65535;
+	}
+
 	inline void begin_transaction() const final
 	{
 		if (!this->in_transaction)
@@ -83,11 +202,137 @@ public:
 		}
 	}
 
+	// The status of the connection is active while a query is running,
+	// so the flag of 'begin_transaction' is checked too.
+	[[nodiscard]]
+	inline bool is_in_transaction() const override
+	{
+		auto status = PQtransactionStatus(this->db.get());
+		return this->in_transaction || status == PQTRANS_INTRANS || status == PQTRANS_INERROR;
+	}
+
+	// Handler is called by 'reset' after the session is opened.
+	inline void set_reconnect_handler(reconnect_handler handler) override
+	{
+		this->on_reconnect = std::move(handler);
+	}
+
+	// Re-establishes the connection to the server. Prepared statements
+	// do not survive reconnection, so the registry is dropped and
+	// statements are prepared again on the next use. Then the reconnect
+	// handler restores the state of the session. If it fails, the
+	// connection is reset again before the next query.
+	//
+	// Throws 'DatabaseError' if the connection fails, rethrows errors
+	// of the reconnect handler.
+	void reset() const;
+
+	// Number of queries which reused a prepared statement.
+	[[nodiscard]]
+	inline size_t statements_cache_hits() const
+	{
+		return this->cache_hits;
+	}
+
+	// Number of queries which were prepared on the server.
+	[[nodiscard]]
+	inline size_t statements_cache_misses() const
+	{
+		return this->cache_misses;
+	}
+
 protected:
+	class Cursor;
+
 	mutable bool in_transaction;
 
+	// Restores the state of the session after 'reset'.
+	reconnect_handler on_reconnect;
+
+	// Set if the reconnect handler failed, so the session is not
+	// restored yet.
+	mutable bool is_reset_pending = false;
+
+	// Whether the streamed query was sent inside of the transaction,
+	// which can be opened by 'begin_transaction' as well as by raw
+	// 'BEGIN' statement. While the query is running the server does
+	// not report it, so it is checked before sending.
+	mutable bool is_streamed_in_transaction = false;
+
+	bool binary_results;
+
 	std::shared_ptr<PGconn> db = nullptr;
 
+	struct PreparedStatement
+	{
+		std::string name;
+
+		// Whether each column of the result has a binary decoder.
+		bool is_binary_safe = false;
+	};
+
+	// Server-side prepared statements keyed by SQL text.
+	// Evicted statements are deallocated on the server.
+	mutable util::LRUCache<std::string, PreparedStatement> statements;
+
+	// Names of statements which were evicted from the cache, but are
+	// not deallocated on the server yet. They are deallocated in
+	// batches to avoid a round trip for each eviction.
+	mutable std::vector<std::string> evicted_statements;
+
+	static constexpr size_t DEALLOCATE_BATCH_SIZE = 16;
+
+	// Used to generate unique statement names.
+	mutable size_t statements_counter = 0;
+
+	mutable size_t cache_hits = 0;
+	mutable size_t cache_misses = 0;
+
+	mutable std::shared_ptr<Reactor> reactor;
+
+	// Provides 'reactor' if it is nullptr, check the constructor.
+	ReactorProvider reactor_provider;
+
+	// Set while the asynchronous query is in progress.
+	mutable std::atomic<bool> is_async_query_running = false;
+
+	// State of the query which is run by 'run_query_async'.
+	struct AsyncQuery
+	{
+		db::RowHandler row_handler;
+
+		// Buffers of the current result which are reused by its rows.
+		db::Columns columns;
+		std::vector<db::Value> values;
+
+		completion_handler completion;
+
+		// The first error of the query. Results are received up to
+		// the end even after the error, so the connection is ready
+		// for the next query.
+		std::exception_ptr error = nullptr;
+
+		// Set when 'row_handler' returns false.
+		bool is_stopped = false;
+
+		// Set if statements are sent in pipeline mode, results are
+		// received up to the synchronization point then.
+		bool is_pipeline = false;
+
+		// Index of the statement of the pipeline whose results are
+		// being received.
+		size_t statement_index = 0;
+	};
+
+#ifdef LIBPQ_HAS_CHUNK_MODE
+	// Maximum number of rows in a single result of streaming.
+	static constexpr int STREAM_CHUNK_SIZE = 256;
+#endif
+
+	// Size of the data which is sent by a single message
+	// during copying of rows.
+	static constexpr size_t COPY_CHUNK_SIZE = 64 * 1024;
+
 	// Helper method which throws 'QueryError' with message and
 	// location for 'arg' argument name.
 	inline void throw_empty_arg(const std::string& arg, int line, const char* function, const char* file) const
@@ -101,11 +346,165 @@ protected:
 	//
 	// 'sql_query' should be a valid SQL statement.
 	// 'row_handler' can be nullptr.
+	// 'is_prepared' allows to prepare the statement, check 'execute'.
 	virtual void run_query_unsafe(
 		const std::string& sql_query,
 		std::function<void(const std::map<std::string, char*>& /* columns_as_map */)> map_handler,
-		std::function<void(const std::vector<char*>& /* columns_as_vector */)> vector_handler
+		std::function<void(const std::vector<char*>& /* columns_as_vector */)> vector_handler,
+		const std::vector<db::Parameter>& parameters={},
+		bool is_prepared=false
+	) const;
+
+	// Reads the row of the result. Returns false to stop
+	// reading of the rest rows.
+	using row_reader = std::function<bool(const PGresult* /* result */, int /* row */)>;
+
+	// Checks the query and restores lost connection.
+	void prepare_connection(const std::string& query) const;
+
+	// Runs the query and returns the whole result which must
+	// be cleared by the caller. 'is_binary' requests binary
+	// result format, check 'binary_results' for details. The query
+	// is prepared only if 'is_prepared' is true and it is preparable.
+	//
+	// Throws 'SQLError' if the query fails.
+	PGresult* execute(
+		const std::string& query, const std::vector<db::Parameter>& parameters, bool is_binary, bool is_prepared
 	) const;
+
+	// Sends the query and switches the connection to receiving of
+	// rows in small results. Results must be read by the caller. The
+	// query is prepared if it is preparable.
+	//
+	// Throws 'SQLError' if the query can not be sent.
+	void send_streamed(const std::string& query, const std::vector<db::Parameter>& parameters, bool is_binary) const;
+
+	// Runs the query and passes rows to 'reader' as they
+	// are received.
+	//
+	// Throws 'SQLError' if the query fails.
+	void execute_streamed(
+		const std::string& query,
+		const std::vector<db::Parameter>& parameters,
+		bool is_binary,
+		const row_reader& reader
+	) const;
+
+	// Sends the part of data of running 'COPY'. Waits while
+	// the connection is not able to queue it.
+	//
+	// Throws 'DatabaseError' on failure.
+	void put_copy_data(const std::string& data) const;
+
+	// Finishes running 'COPY' and returns the error if the server
+	// rejected the data. If 'error_message' is not empty, the
+	// copying is aborted.
+	//
+	// Throws 'DatabaseError' on failure.
+	std::string end_copy(const std::string& error_message) const;
+
+	// Appends 'value' to 'buffer' in text format of 'COPY'.
+	static void append_copy_value(std::string& buffer, const db::Parameter& value);
+
+#ifdef LIBPQ_HAS_PIPELINING
+	// Runs 'statements' in pipeline mode and returns the number of
+	// rows affected by each of them.
+	//
+	// Throws 'SQLError' if some statement fails.
+	std::vector<size_t> execute_pipeline(const std::vector<db::Statement>& statements) const;
+#endif
+
+	// Requests the reactor from the provider or starts the own one
+	// if it is not set yet.
+	void ensure_reactor() const;
+
+	// Sends queued data and handles received results of the
+	// asynchronous query, then waits for the socket again if the
+	// query is not finished. Calls the completion handler otherwise.
+	void continue_async_query(const std::shared_ptr<AsyncQuery>& query) const;
+
+	// Returns true if all results of the query are received.
+	//
+	// Throws 'DatabaseError' if the connection fails.
+	bool read_async_results(const std::shared_ptr<AsyncQuery>& query) const;
+
+	// Returns true if the result with 'status' contains rows.
+	static bool has_rows(ExecStatusType status);
+
+	// Returns the number of rows affected by the command.
+	static size_t affected_rows(const PGresult* result);
+
+	// Asks the server to stop the running query.
+	void cancel_query() const;
+
+	// Sends all queued data of non-blocking connection.
+	//
+	// Throws 'DatabaseError' on failure.
+	void flush() const;
+
+	// Returns text values of 'parameters' for passing to libpq.
+	// Pointers refer to strings which are stored in 'values',
+	// NULL is passed as nullptr.
+	static std::vector<const char*> parameters_as_text(
+		const std::vector<db::Parameter>& parameters, std::vector<std::string>& values
+	);
+
+	// Returns columns of 'row' keyed by names.
+	static std::map<std::string, char*> row_as_map(const PGresult* result, int row);
+
+	// Returns names of columns of 'result'. 'is_complete' tells that
+	// 'result' contains all rows of the result set, so their number
+	// is passed with the names.
+	static db::Columns columns_of(const PGresult* result, bool is_complete);
+
+	// Replaces 'values' with typed columns of 'row', keeping the
+	// memory of the vector.
+	static void read_values(const PGresult* result, int row, std::vector<db::Value>& values);
+
+	// Built-in types of the server.
+	enum TypeOid : Oid
+	{
+		Bool = 16, Char = 18, Name = 19, Int8 = 20, Int2 = 21, Int4 = 23, Text = 25,
+		Float4 = 700, Float8 = 701, BpChar = 1042, VarChar = 1043,
+		Date = 1082, Time = 1083, Timestamp = 1114, TimestampTz = 1184
+	};
+
+	// Returns whether values of 'type' can be decoded from binary
+	// format. 'integer_datetimes' is the setting of the server.
+	// 'timestamptz' is not decoded, so it is read as text with the
+	// time of the session, like other queries read it.
+	[[nodiscard]]
+	static bool has_binary_decoder(Oid type, bool integer_datetimes);
+
+	// Decodes value of 'type' from binary format.
+	//
+	// Throws 'ValueError' for infinite dates and timestamps.
+	static db::Value decode_binary(const char* data, int length, Oid type);
+
+	// Converts number of days since 2000-01-01 to the date.
+	static dt::Date date_from_days(long long days);
+
+	// Converts number of microseconds since midnight to the time.
+	static dt::Time time_from_microseconds(long long microseconds);
+
+	// Returns prepared statement for 'sql_query'. Prepares the
+	// statement on the server if it is not registered.
+	//
+	// Throws 'SQLError' if preparing fails.
+	PreparedStatement prepare_statement(const std::string& sql_query) const;
+
+	// Returns whether the query is a single DML statement, which
+	// is worth preparing.
+	[[nodiscard]]
+	bool is_preparable(const std::string& sql_query) const;
+
+	// Deallocates statements which were evicted from the cache by a
+	// single query if there are at least 'min_count' of them and
+	// there is no transaction in progress, otherwise keeps them
+	// for the next call.
+	//
+	// Throws 'SQLError' if deallocating fails.
+	void deallocate_evicted_statements(size_t min_count) const;
 };
 
 __ORM_POSTGRESQL_END__
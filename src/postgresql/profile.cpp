@@ -0,0 +1,86 @@
+/**
+ * postgresql/profile.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./profile.h"
+
+#ifdef USE_POSTGRESQL
+
+// Base libraries.
+#include <xalwart.base/exceptions.h>
+
+
+__ORM_POSTGRESQL_BEGIN__
+
+Profile Profile::durable()
+{
+	return Profile{{
+		{"synchronous_commit", "on"}
+	}};
+}
+
+Profile Profile::fast_wal()
+{
+	return Profile{{
+		{"synchronous_commit", "off"}
+	}};
+}
+
+Profile Profile::bulk_load()
+{
+	return Profile{{
+		{"synchronous_commit", "off"},
+		{"work_mem", "64MB"},
+		{"maintenance_work_mem", "512MB"}
+	}};
+}
+
+Profile Profile::from_name(const std::string& name)
+{
+	if (name == "durable")
+	{
+		return durable();
+	}
+
+	if (name == "fast-wal")
+	{
+		return fast_wal();
+	}
+
+	if (name == "bulk-load")
+	{
+		return bulk_load();
+	}
+
+	throw ValueError(
+		"Unknown postgresql profile '" + name + "', expected 'durable', 'fast-wal' or 'bulk-load'", _ERROR_DETAILS_
+	);
+}
+
+std::vector<std::string> Profile::statements() const
+{
+	std::vector<std::string> result;
+	result.reserve(this->settings.size());
+	for (const auto& [name, value] : this->settings)
+	{
+		std::string literal;
+		for (auto character : value)
+		{
+			literal += character;
+			if (character == '\'')
+			{
+				literal += '\'';
+			}
+		}
+
+		result.push_back("SET " + name + " TO '" + literal + "';");
+	}
+
+	return result;
+}
+
+__ORM_POSTGRESQL_END__
+
+#endif // USE_POSTGRESQL
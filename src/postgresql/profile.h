@@ -0,0 +1,57 @@
+/**
+ * postgresql/profile.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Named sets of session settings which tune connections.
+ */
+
+#pragma once
+
+#ifdef USE_POSTGRESQL
+
+// C++ libraries.
+#include <string>
+#include <vector>
+#include <utility>
+
+// Module definitions.
+#include "./_def_.h"
+
+
+__ORM_POSTGRESQL_BEGIN__
+
+// Run-time parameters which are set for the session of each
+// connection after it is opened. Profiles have the same names as
+// SQLite ones and make similar trade-offs.
+struct Profile final
+{
+	// Names and values of parameters in order of applying.
+	std::vector<std::pair<std::string, std::string>> settings;
+
+	// Each commit waits until its WAL records are flushed to disk.
+	static Profile durable();
+
+	// Commits do not wait for the WAL flush. The database stays
+	// consistent, but the last transactions can be lost on a crash.
+	static Profile fast_wal();
+
+	// Acts like 'fast_wal' with more memory for sorting and for
+	// building of indexes after imports.
+	static Profile bulk_load();
+
+	// Returns the profile with 'name': "durable", "fast-wal" or
+	// "bulk-load".
+	//
+	// Throws 'ValueError' if the name is unknown.
+	static Profile from_name(const std::string& name);
+
+	// Returns 'SET' statements in order of settings. Values are
+	// quoted as string literals.
+	[[nodiscard]]
+	std::vector<std::string> statements() const;
+};
+
+__ORM_POSTGRESQL_END__
+
+#endif // USE_POSTGRESQL
@@ -0,0 +1,37 @@
+/**
+ * postgresql/sql_builder.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * SQL query builder with PostgreSQL-specific syntax.
+ */
+
+#pragma once
+
+#ifdef USE_POSTGRESQL
+
+// Module definitions.
+#include "./_def_.h"
+
+// Orm libraries.
+#include "../sql_builder.h"
+
+
+__ORM_POSTGRESQL_BEGIN__
+
+// TESTME: SQLBuilder
+class SQLBuilder : public DefaultSQLBuilder
+{
+public:
+
+	// PostgreSQL uses numbered placeholders: '$1', '$2', ...
+	[[nodiscard]]
+	inline std::string sql_placeholder(size_t index) const override
+	{
+		return "$" + std::to_string(index);
+	}
+};
+
+__ORM_POSTGRESQL_END__
+
+#endif // USE_POSTGRESQL
@@ -10,12 +10,18 @@
 
 // C++ libraries.
 #include <string>
+#include <vector>
+#include <functional>
+#include <memory>
+#include <future>
+#include <exception>
 
 // Module definitions.
 #include "./_def_.h"
 
 // Orm libraries.
 #include "../interfaces.h"
+#include "../coroutine.h"
 
 
 __ORM_BEGIN__
@@ -35,14 +41,327 @@ public:
 	{
 		require_non_null(this->db_connection, "Database connection is nullptr", _ERROR_DETAILS_);
 		require_non_null(this->query_builder, "SQL query builder is nullptr", _ERROR_DETAILS_);
+		this->sql_connection = dynamic_cast<const ISQLConnection*>(this->db_connection);
 	};
 
+	// Returns query with values inlined into it.
 	[[nodiscard]]
-	virtual std::string to_sql() const = 0;
+	inline std::string to_sql() const
+	{
+		return this->build_sql(nullptr);
+	}
 
 protected:
 	const IDatabaseConnection* db_connection = nullptr;
+
+	// The same as 'db_connection' if it is able to bind
+	// parameters, nullptr otherwise.
+	const ISQLConnection* sql_connection = nullptr;
+
 	ISQLQueryBuilder* query_builder = nullptr;
+
+	// Replaces the connection which the query runs on.
+	inline void use_connection(const IDatabaseConnection* connection)
+	{
+		this->db_connection = require_non_null(connection, "Database connection is nullptr", _ERROR_DETAILS_);
+		this->sql_connection = dynamic_cast<const ISQLConnection*>(this->db_connection);
+	}
+
+	using sql_function = std::function<std::string(std::vector<db::Parameter>* /* parameters */)>;
+
+	// Builds the query. Values are appended to 'parameters' and
+	// replaced by placeholders if it is not nullptr, otherwise
+	// they are inlined into the query.
+	[[nodiscard]]
+	virtual std::string build_sql(std::vector<db::Parameter>* parameters) const = 0;
+
+	// Runs query generated by 'build' with bound parameters if
+	// the connection supports them, otherwise runs query with
+	// inlined values. The latter is also used when the query has
+	// more values than the connection is able to bind.
+	inline void run_query(
+		const sql_function& build,
+		const std::function<void(const std::map<std::string, char*>& /* columns */)>& map_handler,
+		const std::function<void(const std::vector<char*>& /* columns */)>& vector_handler
+	) const
+	{
+		if (this->sql_connection)
+		{
+			std::vector<db::Parameter> parameters;
+			auto query = build(&parameters);
+			if (parameters.size() <= this->sql_connection->max_parameters())
+			{
+				this->sql_connection->run_query(query, parameters, map_handler, vector_handler);
+				return;
+			}
+		}
+
+		require_non_null(
+			this->db_connection, "SQL Database connection is not initialized", _ERROR_DETAILS_
+		)->run_query(build(nullptr), map_handler, vector_handler);
+	}
+
+	inline void run_query(const sql_function& build, std::string& last_row_id) const
+	{
+		if (this->sql_connection)
+		{
+			std::vector<db::Parameter> parameters;
+			auto query = build(&parameters);
+			if (parameters.size() <= this->sql_connection->max_parameters())
+			{
+				this->sql_connection->run_query(query, parameters, last_row_id);
+				return;
+			}
+		}
+
+		require_non_null(
+			this->db_connection, "SQL Database connection is not initialized", _ERROR_DETAILS_
+		)->run_query(build(nullptr), last_row_id);
+	}
+
+	// Runs statements generated by 'builds' as a single batch if the
+	// connection supports it, check 'ISQLConnection::run_batch' for
+	// details. Otherwise statements are run one by one inside of the
+	// transaction, which is started only if 'in_transaction' is false.
+	inline void run_batch(const std::vector<sql_function>& builds, bool in_transaction=false) const
+	{
+		if (this->sql_connection)
+		{
+			std::vector<db::Statement> statements;
+			statements.reserve(builds.size());
+			for (const auto& build : builds)
+			{
+				db::Statement statement;
+				statement.sql = build(&statement.parameters);
+				if (statement.parameters.size() > this->sql_connection->max_parameters())
+				{
+					statement.sql = build(nullptr);
+					statement.parameters.clear();
+				}
+
+				statements.push_back(std::move(statement));
+			}
+
+			this->sql_connection->run_batch(statements);
+			return;
+		}
+
+		auto* connection = require_non_null(
+			this->db_connection, "SQL Database connection is not initialized", _ERROR_DETAILS_
+		);
+		if (!in_transaction)
+		{
+			connection->begin_transaction();
+		}
+
+		for (const auto& build : builds)
+		{
+			connection->run_query(build(nullptr), nullptr, nullptr);
+		}
+
+		if (!in_transaction)
+		{
+			connection->end_transaction();
+		}
+	}
+
+	// Runs query generated by 'build' without blocking of the calling
+	// thread if the connection supports it, check
+	// 'IAsyncSQLConnection::run_query_async' for details. Otherwise
+	// the query is run synchronously and 'completion' is called
+	// before returning. 'build' is always called before returning.
+	//
+	// 'row_handler' can be nullptr.
+	inline void run_query_async(
+		const sql_function& build,
+		db::RowHandler row_handler,
+		IAsyncSQLConnection::completion_handler completion
+	) const
+	{
+		if (auto* async_connection = dynamic_cast<const IAsyncSQLConnection*>(this->db_connection))
+		{
+			std::string query;
+			std::vector<db::Parameter> parameters;
+			try
+			{
+				query = build(&parameters);
+				if (this->sql_connection && parameters.size() > this->sql_connection->max_parameters())
+				{
+					query = build(nullptr);
+					parameters.clear();
+				}
+			}
+			catch (...)
+			{
+				completion(std::current_exception());
+				return;
+			}
+
+			async_connection->run_query_async(query, parameters, std::move(row_handler), std::move(completion));
+			return;
+		}
+
+		std::exception_ptr error;
+		try
+		{
+			if (row_handler)
+			{
+				this->run_typed_query(build, row_handler, false);
+			}
+			else
+			{
+				this->run_query(build, nullptr, nullptr);
+			}
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+		}
+
+		completion(error);
+	}
+
+	// Acts like 'run_batch', but without blocking of the calling
+	// thread if the connection supports it, check
+	// 'IAsyncSQLConnection::run_batch_async' for details. Values are
+	// bound like in 'run_query_async'.
+	inline void run_batch_async(
+		const std::vector<sql_function>& builds,
+		bool in_transaction,
+		IAsyncSQLConnection::completion_handler completion
+	) const
+	{
+		auto* async_connection = dynamic_cast<const IAsyncSQLConnection*>(this->db_connection);
+		if (async_connection && !builds.empty())
+		{
+			std::vector<db::Statement> statements;
+			try
+			{
+				statements.reserve(builds.size());
+				for (const auto& build : builds)
+				{
+					db::Statement statement;
+					statement.sql = build(&statement.parameters);
+					if (this->sql_connection && statement.parameters.size() > this->sql_connection->max_parameters())
+					{
+						statement.sql = build(nullptr);
+						statement.parameters.clear();
+					}
+
+					statements.push_back(std::move(statement));
+				}
+			}
+			catch (...)
+			{
+				completion(std::current_exception());
+				return;
+			}
+
+			async_connection->run_batch_async(statements, in_transaction, std::move(completion));
+			return;
+		}
+
+		std::exception_ptr error;
+		try
+		{
+			this->run_batch(builds, in_transaction);
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+		}
+
+		completion(error);
+	}
+
+	// Returns the future which is resolved when 'run' calls
+	// the completion handler.
+	static inline std::future<void> as_future(
+		const std::function<void(IAsyncSQLConnection::completion_handler /* completion */)>& run
+	)
+	{
+		auto promise = std::make_shared<std::promise<void>>();
+		auto future = promise->get_future();
+		run([promise](std::exception_ptr error) -> void {
+			if (error)
+			{
+				promise->set_exception(error);
+			}
+			else
+			{
+				promise->set_value();
+			}
+		});
+		return future;
+	}
+
+	// Returns the awaitable which is completed when 'run' calls
+	// the completion handler.
+	static inline Awaitable<> as_awaitable(
+		const std::function<void(IAsyncSQLConnection::completion_handler /* completion */)>& run
+	)
+	{
+		return Awaitable<>([&run](auto handler) -> void {
+			run([handler](std::exception_ptr error) -> void { handler({}, error); });
+		});
+	}
+
+	// Runs query generated by 'build' and passes rows with values
+	// decoded by the connection to 'row_handler', check
+	// 'ISQLConnection::run_typed_query' for details. If the connection
+	// is not able to decode values, they are passed as text.
+	inline void run_typed_query(
+		const sql_function& build,
+		const db::RowHandler& row_handler,
+		bool is_streamed
+	) const
+	{
+		if (this->sql_connection)
+		{
+			std::vector<db::Parameter> parameters;
+			auto query = build(&parameters);
+			if (parameters.size() <= this->sql_connection->max_parameters())
+			{
+				this->sql_connection->run_typed_query(query, parameters, row_handler, is_streamed);
+				return;
+			}
+		}
+
+		// Every row of the result has the same columns, so their
+		// names are taken from the first one.
+		bool is_stopped = false, has_columns = false;
+		db::Columns columns;
+		std::vector<db::Value> values;
+		require_non_null(
+			this->db_connection, "SQL Database connection is not initialized", _ERROR_DETAILS_
+		)->run_query(build(nullptr), [&](const auto& map) -> void {
+			if (is_stopped)
+			{
+				return;
+			}
+
+			if (!has_columns)
+			{
+				std::vector<std::string> names;
+				names.reserve(map.size());
+				for (const auto& column : map)
+				{
+					names.push_back(column.first);
+				}
+
+				columns = db::Columns(std::move(names));
+				has_columns = true;
+			}
+
+			values.clear();
+			for (const auto& column : map)
+			{
+				values.push_back(column.second ? db::Value(std::string_view(column.second)) : db::Value());
+			}
+
+			is_stopped = !row_handler(db::Row(columns, values.data()));
+		}, nullptr);
+	}
 };
 
 __ORM_END__
@@ -0,0 +1,169 @@
+/**
+ * queries/compiled_select.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * 'SELECT' statement which is built once and run many times with
+ * different values of parameters.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <list>
+#include <string>
+#include <vector>
+#include <functional>
+
+// Module definitions.
+#include "./_def_.h"
+
+// Orm libraries.
+#include "../interfaces.h"
+#include "../exceptions.h"
+#include "../db/model.h"
+#include "./stream.h"
+
+
+__ORM_Q_BEGIN__
+
+// Query which is returned by 'Select::compile()'. It holds the SQL
+// with placeholders instead of values, so running it again costs
+// binding of parameters only. Connections which cache prepared
+// statements also skip parsing of the query.
+//
+// Parameters are bound in the order the values were passed to
+// 'where', 'having' and joins of the compiled query. The query must
+// be run on the connection of the backend whose builder compiled it,
+// because placeholders differ between databases. 'limit' and
+// 'offset' are inlined, so compile the query again to change them.
+template <db::model_based_type ModelType>
+class CompiledSelect final
+{
+public:
+	inline CompiledSelect(std::string sql, std::vector<db::Parameter> parameters) :
+		_sql(std::move(sql)), _parameters(std::move(parameters))
+	{
+	}
+
+	// Returns the query with placeholders.
+	[[nodiscard]]
+	inline const std::string& sql() const
+	{
+		return this->_sql;
+	}
+
+	// Returns values which were passed when the query was compiled.
+	[[nodiscard]]
+	inline const std::vector<db::Parameter>& parameters() const
+	{
+		return this->_parameters;
+	}
+
+	// Runs the query with values which were passed when it was
+	// compiled.
+	//
+	// Throws 'QueryError' if connection is not able to bind parameters.
+	[[nodiscard]]
+	inline std::list<ModelType> all(const IDatabaseConnection* connection) const
+	{
+		return this->all(connection, this->_parameters);
+	}
+
+	// Runs the query with 'parameters' bound instead of values which
+	// were passed when it was compiled.
+	//
+	// Throws 'QueryError' if connection is not able to bind parameters
+	// or the number of 'parameters' differs from the compiled one.
+	[[nodiscard]]
+	inline std::list<ModelType> all(
+		const IDatabaseConnection* connection, const std::vector<db::Parameter>& parameters
+	) const
+	{
+		std::list<ModelType> models;
+		db::RowHydrator<ModelType> hydrate;
+		this->run(connection, parameters, [&models, &hydrate](const db::Row& row) -> bool {
+			hydrate(models.emplace_back(), row);
+			return true;
+		}, false);
+		return models;
+	}
+
+	// Acts like 'all' above, but passes models to 'handler' one by one
+	// as rows are received, check 'Select::for_each' for details.
+	inline void for_each(
+		const IDatabaseConnection* connection,
+		const std::vector<db::Parameter>& parameters,
+		const std::function<bool(ModelType&)>& handler
+	) const
+	{
+		db::RowHydrator<ModelType> hydrate;
+		this->run(connection, parameters, [&handler, &hydrate](const db::Row& row) -> bool {
+			ModelType model;
+			hydrate(model, row);
+			return handler(model);
+		}, true);
+	}
+
+	// Returns the range over models which are read from the cursor as
+	// it is iterated, check 'SelectStream' for details.
+	//
+	// Throws 'QueryError' if connection is not able to bind parameters
+	// or the number of 'parameters' differs from the compiled one.
+	[[nodiscard]]
+	inline SelectStream<ModelType> stream(
+		const IDatabaseConnection* connection, const std::vector<db::Parameter>& parameters
+	) const
+	{
+		auto* sql_connection = this->check(connection, parameters);
+		return SelectStream<ModelType>(sql_connection->open_cursor(this->_sql, parameters), {});
+	}
+
+private:
+	std::string _sql;
+	std::vector<db::Parameter> _parameters;
+
+	inline void run(
+		const IDatabaseConnection* connection,
+		const std::vector<db::Parameter>& parameters,
+		const db::RowHandler& row_handler,
+		bool is_streamed
+	) const
+	{
+		this->check(connection, parameters)->run_typed_query(this->_sql, parameters, row_handler, is_streamed);
+	}
+
+	// Returns 'connection' which is able to run the query with
+	// 'parameters', throws 'QueryError' otherwise.
+	inline const ISQLConnection* check(
+		const IDatabaseConnection* connection, const std::vector<db::Parameter>& parameters
+	) const
+	{
+		auto* sql_connection = dynamic_cast<const ISQLConnection*>(connection);
+		if (!sql_connection)
+		{
+			throw QueryError("CompiledSelect: connection is not able to bind parameters", _ERROR_DETAILS_);
+		}
+
+		if (parameters.size() != this->_parameters.size())
+		{
+			throw QueryError(
+				"CompiledSelect: expected " + std::to_string(this->_parameters.size()) +
+					" parameters, got " + std::to_string(parameters.size()),
+				_ERROR_DETAILS_
+			);
+		}
+
+		if (parameters.size() > sql_connection->max_parameters())
+		{
+			throw QueryError(
+				"CompiledSelect: query has more parameters than connection is able to bind",
+				_ERROR_DETAILS_
+			);
+		}
+
+		return sql_connection;
+	}
+};
+
+__ORM_Q_END__
@@ -10,6 +10,8 @@
 
 // C++ libraries.
 #include <string>
+#include <vector>
+#include <functional>
 
 // Module definitions.
 #include "./_def_.h"
@@ -57,13 +59,31 @@ public:
 
 	inline explicit operator std::string() const
 	{
-		auto result = util::quote_str(this->_column) + (this->_ascending ? " ASC" : " DESC");
+		std::string result;
+		result.reserve(this->size_hint());
+		this->append_to(result);
+		return result;
+	}
+
+	// Writes SQL text of the ordering to the end of 'output'.
+	inline void append_to(std::string& output) const
+	{
 		if (!this->_table.empty())
 		{
-			result = util::quote_str(this->_table) + "." + result;
+			util::append_quoted(output, this->_table);
+			output.append(1, '.');
 		}
 
-		return result;
+		util::append_quoted(output, this->_column);
+		output.append(this->_ascending ? " ASC" : " DESC");
+	}
+
+	// Returns the length of SQL text without quotes of names
+	// which can be already quoted.
+	[[nodiscard]]
+	inline size_t size_hint() const
+	{
+		return this->_table.size() + this->_column.size() + 10;
 	}
 };
 
@@ -83,23 +103,145 @@ inline Ordering desc(ColumnT ModelT::* column)
 	return Ordering(ModelT::meta_table_name, db::get_column_name(column), false);
 }
 
+// Acts like 'asc' above, but the column is found at compile time,
+// example: 'asc<&User::id>()'.
+template <auto column, typename ModelT = typename db::member_pointer_traits<decltype(column)>::model_type>
+requires db::model_based_type<ModelT>
+inline Ordering asc()
+{
+	return Ordering(ModelT::meta_table_name, db::get_column_name<column>(), true);
+}
+
+// Acts like 'desc' above, but the column is found at compile time.
+template <auto column, typename ModelT = typename db::member_pointer_traits<decltype(column)>::model_type>
+requires db::model_based_type<ModelT>
+inline Ordering desc()
+{
+	return Ordering(ModelT::meta_table_name, db::get_column_name<column>(), false);
+}
+
+// SQL expression which holds values separately from the
+// text, so they can be bound to the statement as parameters.
 struct Condition
 {
 public:
-	// Condition string, example `"id" = 1`.
-	std::string raw_condition;
+	// Condition text split by parameters: 'parameters[i]' is placed
+	// between 'parts[i]' and 'parts[i + 1]', so there is always one
+	// part more than parameters. Example: `"id" = ` and ``
+	// with parameter `1`.
+	std::vector<std::string> parts{""};
+
+	// Values of the condition.
+	std::vector<db::Parameter> parameters;
 
 public:
 	inline Condition() = default;
 
-	inline explicit Condition(std::string condition) : raw_condition(std::move(condition))
+	inline explicit Condition(std::string condition) : parts{std::move(condition)}
 	{
 	}
 
+	// Returns condition with inlined values, example `"id" = 1`.
 	inline explicit operator std::string() const
 	{
-		return this->raw_condition;
+		std::string result;
+		result.reserve(this->size_hint());
+		this->append_to(result);
+		return result;
 	};
+
+	// Builds condition text with placeholders instead of values
+	// and appends the values to 'output' in the same order.
+	//
+	// 'placeholder' returns the placeholder for one-based index
+	// of the parameter in the whole statement.
+	[[nodiscard]]
+	inline std::string to_sql(
+		const std::function<std::string(size_t /* index */)>& placeholder, std::vector<db::Parameter>& output
+	) const
+	{
+		std::string result;
+		result.reserve(this->size_hint());
+		this->append_sql_to(result, placeholder, output);
+		return result;
+	}
+
+	// Acts like 'operator std::string', but writes the text to the
+	// end of 'sql'.
+	inline void append_to(std::string& sql) const
+	{
+		sql.append(this->parts.front());
+		for (size_t i = 0; i < this->parameters.size(); i++)
+		{
+			sql.append(this->parameters[i].to_literal()).append(this->parts[i + 1]);
+		}
+	}
+
+	// Acts like 'to_sql', but writes the text to the end of 'sql'.
+	inline void append_sql_to(
+		std::string& sql,
+		const std::function<std::string(size_t /* index */)>& placeholder,
+		std::vector<db::Parameter>& output
+	) const
+	{
+		sql.append(this->parts.front());
+		for (size_t i = 0; i < this->parameters.size(); i++)
+		{
+			output.push_back(this->parameters[i]);
+			sql.append(placeholder(output.size())).append(this->parts[i + 1]);
+		}
+	}
+
+	// Returns approximate length of SQL text, placeholders and
+	// short literals are expected in place of values.
+	[[nodiscard]]
+	inline size_t size_hint() const
+	{
+		size_t size = this->parameters.size() * 4;
+		for (const auto& part : this->parts)
+		{
+			size += part.size();
+		}
+
+		return size;
+	}
+
+	[[nodiscard]]
+	inline bool empty() const
+	{
+		return this->parameters.empty() && this->parts.front().empty();
+	}
+
+	// Adds SQL text to the beginning of the condition.
+	inline Condition& prepend(const std::string& text)
+	{
+		this->parts.front().insert(0, text);
+		return *this;
+	}
+
+	// Adds SQL text to the end of the condition.
+	inline Condition& append(const std::string& text)
+	{
+		this->parts.back() += text;
+		return *this;
+	}
+
+	// Adds parameter to the end of the condition.
+	inline Condition& append(db::Parameter parameter)
+	{
+		this->parameters.push_back(std::move(parameter));
+		this->parts.emplace_back();
+		return *this;
+	}
+
+	// Adds other condition to the end of this one.
+	inline Condition& append(const Condition& other)
+	{
+		this->parts.back() += other.parts.front();
+		this->parts.insert(this->parts.end(), std::next(other.parts.begin()), other.parts.end());
+		this->parameters.insert(this->parameters.end(), other.parameters.begin(), other.parameters.end());
+		return *this;
+	}
 };
 
 struct ColumnCondition : public Condition
@@ -109,18 +251,26 @@ public:
 
 	inline ColumnCondition(
 		const std::string& table_name, const std::string& column_name, const std::string& condition
-	) : Condition("")
+	) : ColumnCondition(table_name, column_name, Condition(condition))
+	{
+	}
+
+	inline ColumnCondition(
+		const std::string& table_name, const std::string& column_name, const Condition& condition
+	) : Condition(condition)
 	{
 		if (column_name.empty())
 		{
 			throw QueryError("'column_name' is empty", _ERROR_DETAILS_);
 		}
 
-		this->raw_condition = util::quote_str(column_name) + " " + condition;
+		auto column = util::quote_str(column_name) + " ";
 		if (!table_name.empty())
 		{
-			this->raw_condition = util::quote_str(table_name) + "." + this->raw_condition;
+			column = util::quote_str(table_name) + "." + column;
 		}
+
+		this->prepend(column);
 	}
 };
 
@@ -134,7 +284,9 @@ public:
 
 	inline explicit ComparisonOperation(
 		const std::string& column_name, const std::string& op, const ColumnT& value
-	) : ColumnCondition(ModelT::meta_table_name, column_name, op + " " + db::field_as_column_v(value))
+	) : ColumnCondition(
+		ModelT::meta_table_name, column_name, Condition(op + " ").append(db::field_as_parameter(value))
+	)
 	{
 	}
 };
@@ -191,6 +343,16 @@ inline Column<ModelT, ColumnT> c(ColumnT ModelT::* member_pointer)
 	return Column<ModelT, ColumnT>(db::get_column_name(member_pointer));
 }
 
+// Acts like 'c' above, but the column is found at compile time,
+// example: 'c<&User::age>() >= 18'.
+template <auto member_pointer, typename TraitsT = db::member_pointer_traits<decltype(member_pointer)>>
+inline Column<typename TraitsT::model_type, typename TraitsT::field_type> c()
+{
+	return Column<typename TraitsT::model_type, typename TraitsT::field_type>(
+		db::get_column_name<member_pointer>()
+	);
+}
+
 template <db::column_field_type ColumnT, db::model_based_type ModelT>
 inline ColumnCondition is_null(ColumnT ModelT::* member_pointer)
 {
@@ -210,17 +372,17 @@ inline ColumnCondition is_not_null(ColumnT ModelT::* member_pointer)
 // SQL logical operators.
 inline Condition operator& (const Condition& left, const Condition& right)
 {
-	return Condition("(" + (std::string)left + " AND " + (std::string)right + ")");
+	return Condition("(").append(left).append(" AND ").append(right).append(")");
 }
 
 inline Condition operator| (const Condition& left, const Condition& right)
 {
-	return Condition("(" + (std::string)left + " OR " + (std::string)right + ")");
+	return Condition("(").append(left).append(" OR ").append(right).append(")");
 }
 
 inline Condition operator~ (const Condition& cond)
 {
-	return Condition("NOT (" + (std::string)cond + ")");
+	return Condition("NOT (").append(cond).append(")");
 }
 
 template <db::column_field_type ColumnT, db::model_based_type ModelT>
@@ -230,7 +392,8 @@ inline ColumnCondition between(ColumnT ModelT::* column, const ColumnT& lower, c
 
 	return ColumnCondition(
 		ModelT::meta_table_name, db::get_column_name(column),
-		"BETWEEN " + db::field_as_column_v(lower) + " AND " + db::field_as_column_v(upper)
+		Condition("BETWEEN ").append(db::field_as_parameter(lower))
+			.append(" AND ").append(db::field_as_parameter(upper))
 	);
 }
 
@@ -241,7 +404,8 @@ inline ColumnCondition between(const char* ModelT::* column, const char* lower,
 
 	return ColumnCondition(
 		ModelT::meta_table_name, db::get_column_name(column),
-		"BETWEEN " + db::field_as_column_v(lower) + " AND " + db::field_as_column_v(upper)
+		Condition("BETWEEN ").append(db::field_as_parameter(lower))
+			.append(" AND ").append(db::field_as_parameter(upper))
 	);
 }
 
@@ -252,7 +416,8 @@ inline ColumnCondition between(std::string ModelT::* column, const std::string&
 
 	return ColumnCondition(
 		ModelT::meta_table_name, db::get_column_name(column),
-		"BETWEEN " + db::field_as_column_v(lower) + " AND " + db::field_as_column_v(upper)
+		Condition("BETWEEN ").append(db::field_as_parameter(lower))
+			.append(" AND ").append(db::field_as_parameter(upper))
 	);
 }
 
@@ -261,7 +426,10 @@ inline ColumnCondition like(ColumnT ModelT::* column, const std::string& pattern
 {
 	static_assert(ModelT::meta_table_name != nullptr, "'meta_table_name' is not initialized");
 
-	return ColumnCondition(ModelT::meta_table_name, db::get_column_name(column), "LIKE '" + pattern + "'");
+	return ColumnCondition(
+		ModelT::meta_table_name, db::get_column_name(column),
+		Condition("LIKE ").append(db::field_as_parameter(pattern))
+	);
 }
 
 template <db::column_field_type ColumnT, db::model_based_type ModelT>
@@ -270,7 +438,9 @@ inline ColumnCondition like(ColumnT ModelT::* column, const std::string& pattern
 	static_assert(ModelT::meta_table_name != nullptr, "'meta_table_name' is not initialized");
 
 	return ColumnCondition(
-		ModelT::meta_table_name, db::get_column_name(column), "LIKE '" + pattern + "' ESCAPE '" + escape + "'"
+		ModelT::meta_table_name, db::get_column_name(column),
+		Condition("LIKE ").append(db::field_as_parameter(pattern))
+			.append(" ESCAPE ").append(db::field_as_parameter(escape))
 	);
 }
 
@@ -284,10 +454,18 @@ inline ColumnCondition in(ColumnT ModelT::* column, IteratorT begin, IteratorT e
 		throw QueryError("xw::orm::q::in: list is empty", _ERROR_DETAILS_);
 	}
 
-	std::string condition = "IN (" + str::join(
-		", ", begin, end, [](const ColumnT& item) -> std::string { return db::field_as_column_v(item); }
-	) + ")";
-	return ColumnCondition(ModelT::meta_table_name, db::get_column_name(column), condition);
+	auto condition = Condition("IN (");
+	for (auto it = begin; it != end; it++)
+	{
+		if (it != begin)
+		{
+			condition.append(", ");
+		}
+
+		condition.append(db::field_as_parameter<ColumnT>(*it));
+	}
+
+	return ColumnCondition(ModelT::meta_table_name, db::get_column_name(column), condition.append(")"));
 }
 
 template <db::column_field_type ColumnT, db::column_field_type RangeValueT, db::model_based_type ModelT>
@@ -333,13 +511,13 @@ inline Join join_on(const std::string& type, const std::string& fk_to_left="", c
 	auto condition_str = util::quote_str(left_table_name) + "." + util::quote_str(left_pk)
 		+ " = " +
 		util::quote_str(table_name) + "." + util::quote_str(fk);
-	auto extra_cond_str = (std::string)extra_condition;
-	if (!extra_cond_str.empty())
+	auto condition = q::Condition(condition_str);
+	if (!extra_condition.empty())
 	{
-		condition_str += " AND (" + extra_cond_str + ")";
+		condition.append(" AND (").append(extra_condition).append(")");
 	}
 
-	return Join(type, table_name, q::Condition(condition_str));
+	return Join(type, table_name, condition);
 }
 
 template <db::model_based_type LeftT, db::model_based_type RightT>
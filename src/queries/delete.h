@@ -10,6 +10,7 @@
 
 // C++ libraries.
 #include <optional>
+#include <algorithm>
 
 // Module definitions.
 #include "./_def_.h"
@@ -32,33 +33,6 @@ public:
 	{
 	}
 
-	// Throws 'QueryError' when driver is not set.
-	[[nodiscard]]
-	inline std::string to_sql() const override
-	{
-		require_non_null(this->query_builder, "SQL builder is not initialized", _ERROR_DETAILS_);
-		auto condition = this->where_condition;
-		if (!condition.has_value())
-		{
-			util::tuple_for_each(ModelType::meta_columns, [this, &condition](auto& column)
-			{
-				if (column.is_pk)
-				{
-					condition = ColumnCondition(
-						db::get_table_name<ModelType>(),
-						column.name,
-						"IN (" + str::join(", ", this->primary_keys.begin(), this->primary_keys.end()) + ")"
-					);
-					return false;
-				}
-
-				return true;
-			});
-		}
-
-		return this->query_builder->sql_delete(db::get_table_name<ModelType>(), condition.value());
-	}
-
 	// Appends model's pk to deletion list.
 	inline Delete& model(const ModelType& model)
 	{
@@ -85,11 +59,51 @@ public:
 	// If no models were set, executes `DELETE` without
 	// condition, otherwise generates it from primary keys
 	// if it was not set manually.
+	//
+	// Primary keys which do not fit into the limit of parameters
+	// are deleted by several statements sent as a single batch.
 	inline void commit() const
 	{
-		require_non_null(
-			this->db_connection, "SQL Database connection is not initialized", _ERROR_DETAILS_
-		)->run_query(this->to_sql(), nullptr, nullptr);
+		auto statements = this->split_primary_keys();
+		if (!statements.empty())
+		{
+			this->run_batch(statements);
+			return;
+		}
+
+		this->run_query(
+			[this](auto* parameters) -> auto { return this->build_sql(parameters); }, nullptr, nullptr
+		);
+	}
+
+	// Acts like 'commit()', but does not block the calling thread
+	// if the connection supports asynchronous queries, check
+	// 'IAsyncSQLConnection' for details.
+	inline void commit_async(IAsyncSQLConnection::completion_handler completion) const
+	{
+		auto statements = this->split_primary_keys();
+		if (!statements.empty())
+		{
+			this->run_batch_async(statements, false, std::move(completion));
+			return;
+		}
+
+		this->run_query_async(
+			[this](auto* parameters) -> auto { return this->build_sql(parameters); }, nullptr, std::move(completion)
+		);
+	}
+
+	[[nodiscard]]
+	inline std::future<void> commit_async() const
+	{
+		return this->as_future([this](auto completion) { this->commit_async(std::move(completion)); });
+	}
+
+	// Awaitable version of 'commit_async'.
+	[[nodiscard]]
+	inline Awaitable<> co_commit() const
+	{
+		return this->as_awaitable([this](auto completion) { this->commit_async(std::move(completion)); });
 	}
 
 protected:
@@ -98,7 +112,76 @@ protected:
 
 	// List of primary keys to delete. It will be used by
 	// default if `where` is not called.
-	std::vector<std::string> primary_keys{};
+	std::vector<db::Parameter> primary_keys{};
+
+	// Throws 'QueryError' when driver is not set.
+	[[nodiscard]]
+	inline std::string build_sql(std::vector<db::Parameter>* parameters) const override
+	{
+		return this->build_sql(0, this->primary_keys.size(), parameters);
+	}
+
+	// Splits primary keys which do not fit into the limit of
+	// parameters into several statements. Returns nothing if the
+	// condition was set manually or all keys fit into one statement.
+	[[nodiscard]]
+	inline std::vector<typename AbstractQuery<ModelType>::sql_function> split_primary_keys() const
+	{
+		std::vector<typename AbstractQuery<ModelType>::sql_function> statements;
+		if (!this->sql_connection || this->where_condition.has_value())
+		{
+			return statements;
+		}
+
+		auto keys_per_statement = this->sql_connection->max_parameters();
+		if (keys_per_statement && this->primary_keys.size() > keys_per_statement)
+		{
+			for (size_t begin = 0; begin < this->primary_keys.size(); begin += keys_per_statement)
+			{
+				auto end = std::min(begin + keys_per_statement, this->primary_keys.size());
+				statements.emplace_back([this, begin, end](auto* parameters) -> auto {
+					return this->build_sql(begin, end, parameters);
+				});
+			}
+		}
+
+		return statements;
+	}
+
+	// Builds the statement which deletes primary keys in range
+	// ['begin', 'end') if the condition was not set manually.
+	[[nodiscard]]
+	inline std::string build_sql(size_t begin, size_t end, std::vector<db::Parameter>* parameters) const
+	{
+		require_non_null(this->query_builder, "SQL builder is not initialized", _ERROR_DETAILS_);
+		auto condition = this->where_condition;
+		if (!condition.has_value())
+		{
+			util::tuple_for_each(ModelType::meta_columns, [this, &condition, begin, end](auto& column)
+			{
+				if (column.is_pk)
+				{
+					auto values = Condition("IN (");
+					for (auto i = begin; i < end; i++)
+					{
+						if (i != begin)
+						{
+							values.append(", ");
+						}
+
+						values.append(this->primary_keys[i]);
+					}
+
+					condition = ColumnCondition(db::get_table_name<ModelType>(), std::string(column.name), values.append(")"));
+					return false;
+				}
+
+				return true;
+			});
+		}
+
+		return this->query_builder->sql_delete(db::get_table_name<ModelType>(), condition.value(), parameters);
+	}
 
 	inline void append_model(const ModelType& model)
 	{
@@ -111,7 +194,7 @@ protected:
 		{
 			if (column.is_pk)
 			{
-				this->primary_keys.push_back(column.as_string(model));
+				this->primary_keys.push_back(column.as_parameter(model));
 				return false;
 			}
 
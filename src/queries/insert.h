@@ -8,6 +8,9 @@
 
 #pragma once
 
+// C++ libraries.
+#include <algorithm>
+
 // Base libraries.
 #include <xalwart.base/utility.h>
 #include <xalwart.base/types/string.h>
@@ -26,19 +29,14 @@ template <db::model_based_type ModelType>
 class Insert final : public AbstractQuery<ModelType>
 {
 public:
+	// Default number of rows starting from which 'commit_batch'
+	// loads rows in bulk if the connection supports it.
+	static constexpr size_t DEFAULT_COPY_THRESHOLD = 1000;
+
 	inline explicit Insert(
 		const IDatabaseConnection* connection, ISQLQueryBuilder* builder
-	) : AbstractQuery<ModelType>(connection, builder)
-	{
-	}
-
-	// Throws 'QueryError' when driver is not set.
-	[[nodiscard]]
-	inline std::string to_sql() const override
+	) : AbstractQuery<ModelType>(connection, builder), q_copy_threshold(DEFAULT_COPY_THRESHOLD)
 	{
-		return require_non_null(
-			this->query_builder, "SQL query builder is not initialized", _ERROR_DETAILS_
-		)->sql_insert(db::get_table_name<ModelType>(), this->columns_line, this->rows);
 	}
 
 	// Throws 'QueryError' if model is null.
@@ -58,6 +56,15 @@ public:
 		return *this;
 	}
 
+	// Sets the number of rows starting from which 'commit_batch'
+	// uses 'IBulkCopyConnection::copy_rows' instead of 'INSERT'
+	// statement. Zero disables bulk loading.
+	inline Insert& copy_threshold(size_t threshold)
+	{
+		this->q_copy_threshold = threshold;
+		return *this;
+	}
+
 	// Inserts one row and returns inserted pk as string.
 	//
 	// Throws 'QueryError' if more than one model was set.
@@ -68,7 +75,9 @@ public:
 			throw QueryError("Trying to insert one model, but multiple models were set", _ERROR_DETAILS_);
 		}
 
-		this->db_connection->run_query(this->to_sql(), nullptr, nullptr);
+		this->run_query(
+			[this](auto* parameters) -> auto { return this->build_sql(parameters); }, nullptr, nullptr
+		);
 	}
 
 	// Inserts one row and sets inserted primary key
@@ -81,18 +90,101 @@ public:
 			throw QueryError("Trying to insert one model, but multiple models were set", _ERROR_DETAILS_);
 		}
 
-		auto query = this->to_sql();
 		std::string raw_pk;
-		this->db_connection->run_query(query, raw_pk);
+		this->run_query([this](auto* parameters) -> auto { return this->build_sql(parameters); }, raw_pk);
 		if (!raw_pk.empty())
 		{
 			pk = xw::util::as<T>(raw_pk.c_str());
 		}
 	}
 
+	// Inserts all rows. If the number of rows reaches the copy
+	// threshold and the connection is able to load rows in bulk,
+	// rows are sent without building of the SQL statement.
 	inline void commit_batch() const
 	{
-		this->db_connection->run_query(this->to_sql(), nullptr, nullptr);
+		if (this->q_copy_threshold && this->rows.size() >= this->q_copy_threshold)
+		{
+			if (auto* copy_connection = dynamic_cast<const IBulkCopyConnection*>(this->db_connection))
+			{
+				copy_connection->copy_rows(db::get_table_name<ModelType>(), this->columns_line, this->rows);
+				return;
+			}
+		}
+
+		auto statements = this->split_rows();
+		if (!statements.empty())
+		{
+			this->run_batch(statements);
+			return;
+		}
+
+		this->run_query(
+			[this](auto* parameters) -> auto { return this->build_sql(parameters); }, nullptr, nullptr
+		);
+	}
+
+	// Acts like 'commit_one()', but does not block the calling thread
+	// if the connection supports asynchronous queries, check
+	// 'IAsyncSQLConnection' for details. The inserted primary key
+	// is not retrieved.
+	//
+	// Throws 'QueryError' if more than one model was set.
+	inline void commit_one_async(IAsyncSQLConnection::completion_handler completion) const
+	{
+		if (this->rows.size() > 1)
+		{
+			throw QueryError("Trying to insert one model, but multiple models were set", _ERROR_DETAILS_);
+		}
+
+		this->run_query_async(
+			[this](auto* parameters) -> auto { return this->build_sql(parameters); }, nullptr, std::move(completion)
+		);
+	}
+
+	[[nodiscard]]
+	inline std::future<void> commit_one_async() const
+	{
+		return this->as_future([this](auto completion) { this->commit_one_async(std::move(completion)); });
+	}
+
+	// Awaitable version of 'commit_one_async'.
+	[[nodiscard]]
+	inline Awaitable<> co_commit_one() const
+	{
+		return this->as_awaitable([this](auto completion) { this->commit_one_async(std::move(completion)); });
+	}
+
+	// Acts like 'commit_batch()', but does not block the calling
+	// thread if the connection supports asynchronous queries, check
+	// 'IAsyncSQLConnection' for details. Rows are always inserted
+	// by 'INSERT' statements, because copying blocks the connection
+	// until all rows are sent.
+	inline void commit_batch_async(IAsyncSQLConnection::completion_handler completion) const
+	{
+		auto statements = this->split_rows();
+		if (!statements.empty())
+		{
+			this->run_batch_async(statements, false, std::move(completion));
+			return;
+		}
+
+		this->run_query_async(
+			[this](auto* parameters) -> auto { return this->build_sql(parameters); }, nullptr, std::move(completion)
+		);
+	}
+
+	[[nodiscard]]
+	inline std::future<void> commit_batch_async() const
+	{
+		return this->as_future([this](auto completion) { this->commit_batch_async(std::move(completion)); });
+	}
+
+	// Awaitable version of 'commit_batch_async'.
+	[[nodiscard]]
+	inline Awaitable<> co_commit_batch() const
+	{
+		return this->as_awaitable([this](auto completion) { this->commit_batch_async(std::move(completion)); });
 	}
 
 protected:
@@ -101,15 +193,87 @@ protected:
 	std::string columns_line;
 
 	// Collection of rows to insert.
-	std::list<std::string> rows;
+	std::list<std::vector<db::Parameter>> rows;
 
-	// Converts model into row (string) and appends it to `rows`.
-	//
-	// `is_first`: used to indicate if `append` is called for the
-	// first time. If true, then generates `columns_line`.
+	size_t q_copy_threshold;
+
+	// Throws 'QueryError' when driver is not set.
+	[[nodiscard]]
+	inline std::string build_sql(std::vector<db::Parameter>* parameters) const override
+	{
+		return this->build_rows_sql(this->rows.begin(), this->rows.end(), parameters);
+	}
+
+	// Rows which do not fit into the limit of parameters are split
+	// into several statements instead of inlining all values.
+	// Returns nothing if all rows fit into a single statement.
+	[[nodiscard]]
+	inline std::vector<typename AbstractQuery<ModelType>::sql_function> split_rows() const
+	{
+		std::vector<typename AbstractQuery<ModelType>::sql_function> statements;
+		if (!this->sql_connection || this->rows.empty() || this->rows.front().empty())
+		{
+			return statements;
+		}
+
+		auto rows_per_statement = std::max<size_t>(
+			this->sql_connection->max_parameters() / this->rows.front().size(), 1
+		);
+		if (this->rows.size() > rows_per_statement)
+		{
+			for (auto begin = this->rows.begin(); begin != this->rows.end();)
+			{
+				auto end = begin;
+				for (size_t i = 0; i < rows_per_statement && end != this->rows.end(); i++, end++);
+				statements.emplace_back([this, begin, end](auto* parameters) -> auto {
+					return this->build_rows_sql(begin, end, parameters);
+				});
+				begin = end;
+			}
+		}
+
+		return statements;
+	}
+
+	// Builds the statement which inserts rows in range ['begin', 'end').
+	[[nodiscard]]
+	inline std::string build_rows_sql(
+		std::list<std::vector<db::Parameter>>::const_iterator begin,
+		std::list<std::vector<db::Parameter>>::const_iterator end,
+		std::vector<db::Parameter>* parameters
+	) const
+	{
+		auto* builder = require_non_null(
+			this->query_builder, "SQL query builder is not initialized", _ERROR_DETAILS_
+		);
+		std::list<std::string> rows_list;
+		for (auto it = begin; it != end; it++)
+		{
+			const auto& row = *it;
+			std::string row_str;
+			for (const auto& value : row)
+			{
+				if (parameters)
+				{
+					parameters->push_back(value);
+					row_str += builder->sql_placeholder(parameters->size()) + ", ";
+				}
+				else
+				{
+					row_str += value.to_literal() + ", ";
+				}
+			}
+
+			rows_list.push_back(str::rtrim(row_str, ", "));
+		}
+
+		return builder->sql_insert(db::get_table_name<ModelType>(), this->columns_line, rows_list);
+	}
+
+	// Converts model into row of values and appends it to `rows`.
 	inline void append_model(const ModelType& model)
 	{
-		std::string row;
+		std::vector<db::Parameter> row;
 		util::tuple_for_each(ModelType::meta_columns, [&row, model](auto& column)
 		{
 			if constexpr (ModelType::meta_omit_pk)
@@ -120,30 +284,37 @@ protected:
 				}
 			}
 
-			row += column.as_string(model) + ", ";
+			row.push_back(column.as_parameter(model));
 			return true;
 		});
 
-		this->rows.push_back(str::rtrim(row, ", "));
+		this->rows.push_back(std::move(row));
 	}
 
+	// Columns line does not depend on the model, so it is built once
+	// per model type.
 	inline void build_columns_line(const ModelType& model)
 	{
-		util::tuple_for_each(ModelType::meta_columns, [this](auto& column)
+		static const std::string line = []
 		{
-			if constexpr (ModelType::meta_omit_pk)
+			std::string result;
+			util::tuple_for_each(ModelType::meta_columns, [&result](auto& column)
 			{
-				if (column.is_pk)
+				if constexpr (ModelType::meta_omit_pk)
 				{
-					return true;
+					if (column.is_pk)
+					{
+						return true;
+					}
 				}
-			}
 
-			this->columns_line += column.name + ", ";
-			return true;
-		});
+				result.append(column.name).append(", ");
+				return true;
+			});
 
-		this->columns_line = str::rtrim(this->columns_line, ", ");
+			return str::rtrim(result, ", ");
+		}();
+		this->columns_line = line;
 	}
 };
 
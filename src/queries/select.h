@@ -9,9 +9,15 @@
 #pragma once
 
 // C++ libraries.
+#include <algorithm>
+#include <atomic>
 #include <list>
+#include <memory_resource>
+#include <mutex>
 #include <optional>
 #include <functional>
+#include <typeindex>
+#include <vector>
 
 // Base libraries.
 #include <xalwart.base/types/string.h>
@@ -24,6 +30,9 @@
 // Orm libraries.
 #include "./functions.h"
 #include "./abstract_query.h"
+#include "./compiled_select.h"
+#include "./stream.h"
+#include "../coroutine.h"
 
 
 __ORM_Q_BEGIN__
@@ -33,9 +42,20 @@ template <db::model_based_type ModelType>
 class Select final : public AbstractQuery<ModelType>
 {
 public:
+	// Returns the connection which modifies the database.
+	using connection_provider = std::function<const IDatabaseConnection*()>;
+
+	// Rows are selected on 'connection'. Statements which modify the
+	// database, like 'delete_', are run on the connection which is
+	// returned by 'write_connection', so the reading one can be
+	// read-only. It is called on the first write only, so the writing
+	// connection is not held by queries which only read. If it is
+	// nullptr, 'connection' is used for writing too.
 	inline explicit Select(
-		const IDatabaseConnection* connection, ISQLQueryBuilder* builder
-	) : AbstractQuery<ModelType>(connection, builder), q_distinct(false), q_limit(-1), q_offset(-1)
+		const IDatabaseConnection* connection, ISQLQueryBuilder* builder,
+		connection_provider write_connection=nullptr
+	) : AbstractQuery<ModelType>(connection, builder), q_distinct(false), q_limit(-1), q_offset(-1),
+		write_connection(std::move(write_connection))
 	{
 		this->table_name = db::get_table_name<ModelType>();
 		this->pk_name = db::get_pk_name<ModelType>();
@@ -45,66 +65,144 @@ public:
 		}
 	};
 
-	// Throws 'QueryError' when driver is not set.
-	[[nodiscard]]
-	inline std::string to_sql() const override
-	{
-		std::list<std::string> columns;
-		util::tuple_for_each(ModelType::meta_columns, [&columns](auto& column) {
-			columns.push_back(column.name);
-		});
-		auto where_condition = this->q_where.has_value() ? this->q_where.value() : Condition("");
-		auto having_condition = this->q_having.has_value() ? this->q_having.value() : Condition("");
-		return require_non_null(
-			this->query_builder, "SQL query builder is not initialized", _ERROR_DETAILS_
-		)->sql_select(
-			this->table_name,
-			columns,
-			this->q_distinct,
-			this->joins,
-			where_condition,
-			this->q_order_by,
-			this->q_limit,
-			this->q_offset,
-			this->q_group_by,
-			having_condition
-		);
-	}
-
 	// TESTME: aggregate
 	// Runs aggregate function for selected rows.
 	//
 	// Throws 'QueryError' when driver is not set.
-	template <typename ReturnType>
+	template <db::column_field_type ReturnType>
 	[[nodiscard]]
 	inline ReturnType aggregate(const AggregateFunction<ReturnType>& func) const
 	{
 		std::string result_key = "agg_result";
-		auto where_condition = this->q_where.has_value() ? this->q_where.value() : Condition("");
-		auto having_condition = this->q_having.has_value() ? this->q_having.value() : Condition("");
-		auto query = require_non_null(
+		const auto& where_condition = condition_or_empty(this->q_where);
+		const auto& having_condition = condition_or_empty(this->q_having);
+		auto* builder = require_non_null(
 			this->query_builder, func.name + ": SQL query builder is not initialized", _ERROR_DETAILS_
-		)->sql_select_(
-			this->table_name,
-			(std::string)func + " AS " + result_key,
-			this->q_distinct,
-			this->joins,
-			where_condition,
-			this->q_order_by,
-			this->q_limit,
-			this->q_offset,
-			this->q_group_by,
-			having_condition
 		);
-		ReturnType result;
-		require_non_null(
-			this->db_connection, func.name + ": SQL driver is not initialized", _ERROR_DETAILS_
-		)->run_query(query, [&result, result_key](const auto& map) -> void {
-			result = xw::util::as<ReturnType>(map[result_key]);
-		}, nullptr);
+		ReturnType result{};
+		this->run_typed_query(
+			[&](auto* parameters) -> auto {
+				return builder->sql_select_(
+					this->table_name,
+					(std::string)func + " AS " + result_key,
+					this->q_distinct,
+					this->joins,
+					where_condition,
+					this->q_order_by,
+					this->q_limit,
+					this->q_offset,
+					this->q_group_by,
+					having_condition,
+					parameters
+				);
+			},
+			[&result, &result_key](const db::Row& row) -> bool {
+				auto* value = row.find(result_key);
+				if (value && !value->is_null())
+				{
+					result = db::value_as_field<ReturnType>(*value);
+				}
+
+				return false;
+			},
+			false
+		);
 		return result;
 	}
 
+	// Acts like 'aggregate' above, but does not block the calling
+	// thread if the connection supports asynchronous queries, check
+	// 'IAsyncSQLConnection' for details. 'callback' receives the
+	// result or the error.
+	template <db::column_field_type ReturnType>
+	inline void aggregate_async(
+		const AggregateFunction<ReturnType>& func,
+		std::function<void(ReturnType /* result */, std::exception_ptr /* error */)> callback
+	) const
+	{
+		std::string result_key = "agg_result";
+		const auto& where_condition = condition_or_empty(this->q_where);
+		const auto& having_condition = condition_or_empty(this->q_having);
+		auto* builder = require_non_null(
+			this->query_builder, func.name + ": SQL query builder is not initialized", _ERROR_DETAILS_
+		);
+		auto result = std::make_shared<ReturnType>();
+		this->run_query_async(
+			[&](auto* parameters) -> auto {
+				return builder->sql_select_(
+					this->table_name,
+					(std::string)func + " AS " + result_key,
+					this->q_distinct,
+					this->joins,
+					where_condition,
+					this->q_order_by,
+					this->q_limit,
+					this->q_offset,
+					this->q_group_by,
+					having_condition,
+					parameters
+				);
+			},
+			[result, result_key](const db::Row& row) -> bool {
+				auto* value = row.find(result_key);
+				if (value && !value->is_null())
+				{
+					*result = db::value_as_field<ReturnType>(*value);
+				}
+
+				return false;
+			},
+			[result, callback = std::move(callback)](std::exception_ptr error) -> void {
+				callback(std::move(*result), error);
+			}
+		);
+	}
+
+	// Returns the awaitable result of the aggregate function,
+	// check 'aggregate_async' for details.
+	template <db::column_field_type ReturnType>
+	[[nodiscard]]
+	inline Awaitable<ReturnType> co_aggregate(const AggregateFunction<ReturnType>& func) const
+	{
+		return Awaitable<ReturnType>([this, &func](auto handler) -> void {
+			this->aggregate_async(func, std::move(handler));
+		});
+	}
+
+	[[nodiscard]]
+	inline auto co_count() const
+	{
+		return this->co_aggregate(q::count());
+	}
+
+	template <db::column_field_type ColumnType>
+	[[nodiscard]]
+	inline auto co_avg(ColumnType ModelType::* column) const
+	{
+		return this->co_aggregate(q::avg(column));
+	}
+
+	template <db::column_field_type ColumnType>
+	[[nodiscard]]
+	inline auto co_min(ColumnType ModelType::* column) const
+	{
+		return this->co_aggregate(q::min(column));
+	}
+
+	template <db::column_field_type ColumnType>
+	[[nodiscard]]
+	inline auto co_max(ColumnType ModelType::* column) const
+	{
+		return this->co_aggregate(q::max(column));
+	}
+
+	template <db::column_field_type ColumnType>
+	[[nodiscard]]
+	inline auto co_sum(ColumnType ModelType::* column) const
+	{
+		return this->co_aggregate(q::sum(column));
+	}
+
 	// TESTME: avg
 	// Calculates average value of given column in selected rows.
 	//
@@ -203,14 +301,14 @@ public:
 		auto* connection = this->db_connection;
 		auto* builder = this->query_builder;
 		this->relations.push_back([connection, builder, fk_column, first, second, model_pk](ModelType& model) -> void {
-			auto pk_val = "'" + model.__get_attr__(db::get_column_name(model_pk).c_str())->__str__() + "'";
+			auto pk_val = db::Parameter(model.__get_attr__(db::get_column_name(model_pk).c_str())->__str__());
 			first(model, xw::Lazy<std::list<OtherModelType>>(
 				[connection, builder, fk_column, pk_val, first, second, model_pk]() -> std::list<OtherModelType> {
 					return select<OtherModelType>(connection, builder)
 						.template many_to_one<PrimaryKeyT, ModelType>(second, first, model_pk, fk_column)
 							.where(q::ColumnCondition(
 							db::get_table_name<OtherModelType>(),
-							util::quote_str(fk_column), "= " + pk_val
+							util::quote_str(fk_column), q::Condition("= ").append(pk_val)
 						))
 						.all();
 				}
@@ -282,7 +380,7 @@ public:
 		this->relations.push_back([
 			connection, builder, first, second, t_name, fk_column, other_model_pk, pk_name_str
 		](ModelType& model) -> void {
-			auto model_pk_val = "'" + model.__get_attr__(pk_name_str.c_str())->__str__() + "'";
+			auto model_pk_val = db::Parameter(model.__get_attr__(pk_name_str.c_str())->__str__());
 			first(model, xw::Lazy<OtherModelType>(
 				[
 					connection, builder, first, second, t_name, fk_column, model_pk_val, other_model_pk
@@ -292,7 +390,8 @@ public:
 						.template one_to_many<PrimaryKeyT, ModelType>(second, first, other_model_pk, fk_column)
 						.where(q::ColumnCondition(
 							db::get_table_name<ModelType>(),
-							util::quote_str(db::get_column_name(other_model_pk).c_str()), "= " + model_pk_val
+							db::get_column_name(other_model_pk, true),
+							q::Condition("= ").append(model_pk_val)
 						))
 						.first();
 				}
@@ -515,18 +614,103 @@ public:
 	[[nodiscard]]
 	inline std::list<ModelType> all() const
 	{
-		return this->all<ModelType>(nullptr);
+		std::list<ModelType> models;
+		this->all_into(models);
+		return models;
+	}
+
+	// Acts like 'all()', but returns models stored contiguously.
+	[[nodiscard]]
+	inline std::vector<ModelType> all_vector() const
+	{
+		std::vector<ModelType> models;
+		this->all_into(models);
+		return models;
+	}
+
+	// Acts like 'all_vector()' above, but the vector allocates its
+	// memory from 'resource', so the request-scoped arena releases it
+	// at once. Members of models, like strings, use their own
+	// allocators.
+	[[nodiscard]]
+	inline std::pmr::vector<ModelType> all_vector(std::pmr::memory_resource* resource) const
+	{
+		std::pmr::vector<ModelType> models(resource);
+		this->all_into(models);
+		return models;
+	}
+
+	// Maximum number of models which 'all_into' reserves for 'limit'.
+	static constexpr size_t MAX_RESERVED_MODELS = 1024;
+
+	// Acts like 'all()', but appends selected models to 'container'.
+	// Each model is hydrated in place of the new element, so it is
+	// never copied. If the container is able to reserve memory, it is
+	// reserved for the number of rows when the driver reports it with
+	// the first row. Otherwise it is reserved for 'limit' models, but
+	// not more than 'MAX_RESERVED_MODELS', because the limit can be
+	// much greater than the result.
+	//
+	// Throws 'QueryError' when driver is not set.
+	template <typename ContainerT>
+	requires std::is_same_v<typename ContainerT::value_type, ModelType>
+	inline void all_into(ContainerT& container) const
+	{
+		constexpr bool is_reservable = requires { container.reserve(container.size()); };
+		if constexpr (is_reservable)
+		{
+			if (this->q_limit > 0)
+			{
+				container.reserve(container.size() + std::min<size_t>(this->q_limit, MAX_RESERVED_MODELS));
+			}
+		}
+
+		db::RowHydrator<ModelType> hydrate;
+		std::uint64_t generation = 0;
+		auto build = [this](auto* parameters) -> auto { return this->build_sql(parameters); };
+		this->run_typed_query(build, [&](const db::Row& row) -> bool {
+			if constexpr (is_reservable)
+			{
+				const auto& columns = row.columns();
+				if (columns.generation() != generation)
+				{
+					generation = columns.generation();
+					if (columns.rows_count() != db::Columns::npos)
+					{
+						container.reserve(container.size() + columns.rows_count());
+					}
+				}
+			}
+
+			auto& model = container.emplace_back();
+			try
+			{
+				hydrate(model, row);
+			}
+			catch (...)
+			{
+				container.pop_back();
+				throw;
+			}
+
+			for (auto& callable : this->relations)
+			{
+				callable(model);
+			}
+
+			return true;
+		}, false);
 	}
 
 	template <typename To>
 	inline std::list<To> all(const std::function<To(const ModelType&)>& transform) const
 	{
 		std::pair<std::list<To>, std::list<relation_callable>> collection{{}, this->relations};
-		require_non_null(
-			this->db_connection, "SQL Database connection is not initialized", _ERROR_DETAILS_
-		)->run_query(this->to_sql(), [&collection, &transform](const auto& map) -> void {
+		db::RowHydrator<ModelType> hydrate;
+		auto build = [this](auto* parameters) -> auto { return this->build_sql(parameters); };
+		this->run_typed_query(build, [&collection, &transform, &hydrate](const db::Row& row) -> bool {
 			ModelType model;
-			model.from_map(map);
+			hydrate(model, row);
 			if constexpr (std::is_same_v<To, ModelType>)
 			{
 				for (auto& callable : collection.second)
@@ -543,45 +727,228 @@ public:
 			{
 				if constexpr (std::is_same_v<To, ModelType>)
 				{
-					collection.first.push_back(model);
+					collection.first.push_back(std::move(model));
 				}
 			}
-		}, nullptr);
 
-		return collection.first;
+			return true;
+		}, false);
+
+		return std::move(collection.first);
+	}
+
+	// Acts like 'all()', but does not block the calling thread if the
+	// connection supports asynchronous queries, check
+	// 'IAsyncSQLConnection' for details. 'callback' receives selected
+	// models or the error. The query object can be destroyed right
+	// after the call, but the connection should stay alive until
+	// 'callback' is called.
+	inline void all_async(
+		std::function<void(std::list<ModelType> /* models */, std::exception_ptr /* error */)> callback
+	) const
+	{
+		auto models = std::make_shared<std::list<ModelType>>();
+		auto build = [this](auto* parameters) -> auto { return this->build_sql(parameters); };
+		this->run_query_async(
+			build,
+			[models, relations = this->relations, hydrate = db::RowHydrator<ModelType>()](
+				const db::Row& row
+			) mutable -> bool {
+				ModelType model;
+				hydrate(model, row);
+				for (auto& callable : relations)
+				{
+					callable(model);
+				}
+
+				models->push_back(std::move(model));
+				return true;
+			},
+			[models, callback = std::move(callback)](std::exception_ptr error) -> void {
+				callback(error ? std::list<ModelType>() : std::move(*models), error);
+			}
+		);
+	}
+
+	// Returns the future of 'all()' which is run asynchronously,
+	// check 'all_async' above for details.
+	[[nodiscard]]
+	inline std::future<std::list<ModelType>> all_async() const
+	{
+		auto promise = std::make_shared<std::promise<std::list<ModelType>>>();
+		auto future = promise->get_future();
+		this->all_async([promise](std::list<ModelType> models, std::exception_ptr error) -> void {
+			if (error)
+			{
+				promise->set_exception(error);
+			}
+			else
+			{
+				promise->set_value(std::move(models));
+			}
+		});
+		return future;
+	}
+
+	// Returns the awaitable result of 'all()' which is run
+	// asynchronously, check 'all_async' above for details.
+	[[nodiscard]]
+	inline Awaitable<std::list<ModelType>> co_all() const
+	{
+		return Awaitable<std::list<ModelType>>([this](auto handler) -> void {
+			this->all_async(std::move(handler));
+		});
+	}
+
+	// Returns the awaitable result of 'first()' which is run
+	// asynchronously, check 'all_async' above for details.
+	[[nodiscard]]
+	inline Awaitable<ModelType> co_first()
+	{
+		this->limit(1);
+		return Awaitable<ModelType>([this](auto handler) -> void {
+			this->all_async([handler](std::list<ModelType> models, std::exception_ptr error) -> void {
+				ModelType model;
+				if (models.empty())
+				{
+					model.mark_as_null();
+				}
+				else
+				{
+					model = std::move(models.front());
+				}
+
+				handler(std::move(model), error);
+			});
+		});
+	}
+
+	// TESTME: for_each
+	// Performs an access to database and passes selected models to
+	// 'handler' one by one as rows are received, so the result is
+	// never held in memory as a whole. Return false from 'handler'
+	// to stop receiving of the rest rows.
+	//
+	// Throws 'QueryError' when driver is not set.
+	inline void for_each(const std::function<bool(ModelType&)>& handler) const
+	{
+		db::RowHydrator<ModelType> hydrate;
+		auto build = [this](auto* parameters) -> auto { return this->build_sql(parameters); };
+		this->run_typed_query(build, [this, &handler, &hydrate](const db::Row& row) -> bool {
+			ModelType model;
+			hydrate(model, row);
+			for (auto& callable : this->relations)
+			{
+				callable(model);
+			}
+
+			return handler(model);
+		}, true);
+	}
+
+	// Builds the query once with values replaced by placeholders, so
+	// it can be run again with other values without any string work,
+	// check 'CompiledSelect' for details. 'limit' and 'offset' are
+	// inlined into the query.
+	//
+	// Throws 'QueryError' if relations are set, because they are bound
+	// to the connection of this query.
+	[[nodiscard]]
+	inline CompiledSelect<ModelType> compile() const
+	{
+		if (!this->relations.empty())
+		{
+			throw QueryError("Select: unable to compile query with relations", _ERROR_DETAILS_);
+		}
+
+		std::vector<db::Parameter> parameters;
+		auto query = this->build_sql(&parameters);
+		return CompiledSelect<ModelType>(std::move(query), std::move(parameters));
+	}
+
+	// Performs an access to database and returns the range over
+	// selected models which are read from the cursor as the range is
+	// iterated, check 'SelectStream' for details.
+	//
+	// Throws 'QueryError' if the connection is not able to open cursor.
+	[[nodiscard]]
+	inline SelectStream<ModelType> stream() const
+	{
+		if (!this->sql_connection)
+		{
+			throw QueryError("Select: connection is not able to open cursor", _ERROR_DETAILS_);
+		}
+
+		std::vector<db::Parameter> parameters;
+		auto query = this->build_sql(&parameters);
+		if (parameters.size() > this->sql_connection->max_parameters())
+		{
+			query = this->build_sql(nullptr);
+			parameters.clear();
+		}
+
+		return SelectStream<ModelType>(this->sql_connection->open_cursor(query, parameters), this->relations);
 	}
 
 	// TESTME: delete_
 	// Deletes selected rows without retrieving them from the database.
+	// Runs on the writing connection, check the constructor.
 	inline void delete_() const
 	{
+		if (this->write_connection)
+		{
+			auto* connection = this->write_connection();
+			if (connection != this->db_connection)
+			{
+				auto query = *this;
+				query.use_connection(connection);
+				query.write_connection = nullptr;
+				query.delete_();
+				return;
+			}
+		}
+
 		auto pk_col = util::quote_str(this->table_name) + "." + util::quote_str(this->pk_name);
-		auto where_condition = this->q_where.has_value() ? this->q_where.value() : Condition("");
-		auto having_condition = this->q_having.has_value() ? this->q_having.value() : Condition("");
-		auto select_query = require_non_null(
+		const auto& where_condition = condition_or_empty(this->q_where);
+		const auto& having_condition = condition_or_empty(this->q_having);
+		auto* builder = require_non_null(
 			this->query_builder, "SQL query builder is not initialized", _ERROR_DETAILS_
-		)->sql_select_(
-			this->table_name,
-			pk_col,
-			this->q_distinct,
-			this->joins,
-			where_condition,
-			this->q_order_by,
-			this->q_limit,
-			this->q_offset,
-			this->q_group_by,
-			having_condition
 		);
-		select_query.pop_back();
-		auto query = this->query_builder->sql_delete(
-			this->table_name, Condition(pk_col + " IN (" + select_query + ")")
+		this->run_query(
+			[&](auto* parameters) -> auto {
+				auto select_query = builder->sql_select_(
+					this->table_name,
+					pk_col,
+					this->q_distinct,
+					this->joins,
+					where_condition,
+					this->q_order_by,
+					this->q_limit,
+					this->q_offset,
+					this->q_group_by,
+					having_condition,
+					parameters
+				);
+				select_query.pop_back();
+
+				// Values of sub-query are already in 'parameters'.
+				return builder->sql_delete(
+					this->table_name, Condition(pk_col + " IN (" + select_query + ")"), parameters
+				);
+			},
+			nullptr, nullptr
 		);
-		require_non_null(
-			this->db_connection, "SQL Database connection is not initialized", _ERROR_DETAILS_
-		)->run_query(query, nullptr, nullptr);
 	}
 
 protected:
+	// Returns the value of 'condition' if it is set, otherwise the
+	// empty condition, so the builder receives it without copying.
+	static inline const Condition& condition_or_empty(const std::optional<Condition>& condition)
+	{
+		static const Condition empty_condition;
+		return condition.has_value() ? condition.value() : empty_condition;
+	}
+
 	// Retrieves automatically, check the default constructor.
 	std::string table_name;
 
@@ -614,12 +981,79 @@ protected:
 	// Holds a list of conditions for SQL 'JOIN' statement.
 	std::list<q::Join> joins;
 
+	// Provides the connection for statements which modify the
+	// database, check the constructor.
+	connection_provider write_connection;
+
 	typedef std::function<void(ModelType& model)> relation_callable;
 
 	// Holds a list of lambda-functions which must be
 	// called for each selected object to set lazy
 	// initializers.
 	std::list<relation_callable> relations;
+
+	// Returns the list of selected columns of the model which is
+	// built by 'builder' once per type of the builder. Applications
+	// usually use a single type of the builder, so its entry is read
+	// without locking, the lock is taken only when the type changes.
+	static inline const std::string& select_columns(const ISQLQueryBuilder* builder)
+	{
+		struct Entry
+		{
+			std::type_index type;
+			std::string columns;
+		};
+
+		std::type_index type = typeid(*builder);
+		static std::atomic<const Entry*> last_entry = nullptr;
+		auto* entry = last_entry.load(std::memory_order_acquire);
+		if (entry && entry->type == type)
+		{
+			return entry->columns;
+		}
+
+		// Entries are never removed, so references to them stay valid.
+		static std::mutex mutex;
+		static std::list<Entry> entries;
+		std::lock_guard lock(mutex);
+		auto it = std::find_if(entries.begin(), entries.end(), [&type](const Entry& entry)
+		{
+			return entry.type == type;
+		});
+		if (it == entries.end())
+		{
+			it = entries.insert(entries.end(), Entry{type, builder->sql_select_columns(
+				db::get_table_name<ModelType>(), db::get_column_names<ModelType>()
+			)});
+		}
+
+		last_entry.store(&*it, std::memory_order_release);
+		return it->columns;
+	}
+
+	// Throws 'QueryError' when driver is not set.
+	[[nodiscard]]
+	inline std::string build_sql(std::vector<db::Parameter>* parameters) const override
+	{
+		const auto& where_condition = condition_or_empty(this->q_where);
+		const auto& having_condition = condition_or_empty(this->q_having);
+		auto* builder = require_non_null(
+			this->query_builder, "SQL query builder is not initialized", _ERROR_DETAILS_
+		);
+		return builder->sql_select_(
+			this->table_name,
+			select_columns(builder),
+			this->q_distinct,
+			this->joins,
+			where_condition,
+			this->q_order_by,
+			this->q_limit,
+			this->q_offset,
+			this->q_group_by,
+			having_condition,
+			parameters
+		);
+	}
 };
 
 __ORM_Q_END__
@@ -0,0 +1,152 @@
+/**
+ * queries/stream.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Input range over models which are read from the database cursor
+ * one by one.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <list>
+#include <memory>
+#include <iterator>
+#include <functional>
+
+// Module definitions.
+#include "./_def_.h"
+
+// Orm libraries.
+#include "../interfaces.h"
+#include "../db/model.h"
+
+
+__ORM_Q_BEGIN__
+
+// Range which is returned by 'Select::stream()'. Each step of the
+// iterator reads the next row from the cursor and sets fields of the
+// single model which is kept by the stream, so scanning of the whole
+// table uses constant memory. Copy the model if it is needed after
+// the next step.
+//
+// The query is in progress until the last row is read or the stream
+// is destroyed, so the connection must not run other queries while
+// iterating. Leaving the loop early destroys the temporary stream and
+// the rest rows are discarded.
+template <db::model_based_type ModelType>
+class SelectStream final
+{
+public:
+	using relation_callable = std::function<void(ModelType& /* model */)>;
+
+	class iterator final
+	{
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = ModelType;
+		using difference_type = std::ptrdiff_t;
+		using pointer = ModelType*;
+		using reference = ModelType&;
+
+		iterator() = default;
+
+		inline explicit iterator(SelectStream* stream) : _stream(stream)
+		{
+		}
+
+		inline reference operator* () const
+		{
+			return this->_stream->_model;
+		}
+
+		inline pointer operator-> () const
+		{
+			return &this->_stream->_model;
+		}
+
+		inline iterator& operator++ ()
+		{
+			if (!this->_stream->advance())
+			{
+				this->_stream = nullptr;
+			}
+
+			return *this;
+		}
+
+		inline void operator++ (int)
+		{
+			++*this;
+		}
+
+		inline bool operator== (const iterator& other) const
+		{
+			return this->_stream == other._stream;
+		}
+
+	private:
+		SelectStream* _stream = nullptr;
+	};
+
+	inline SelectStream(std::unique_ptr<ISQLCursor> cursor, std::list<relation_callable> relations) :
+		_cursor(std::move(cursor)), _relations(std::move(relations)), _hydrate(true)
+	{
+	}
+
+	// Reads the first row on the first call. The stream can be iterated
+	// only once, later calls continue from the current model.
+	inline iterator begin()
+	{
+		if (!this->_is_started)
+		{
+			this->_is_started = true;
+			this->advance();
+		}
+
+		return this->_cursor ? iterator(this) : iterator();
+	}
+
+	inline iterator end()
+	{
+		return iterator();
+	}
+
+	// Discards the rest rows and frees the connection for other queries.
+	inline void close()
+	{
+		this->_cursor.reset();
+	}
+
+private:
+	std::unique_ptr<ISQLCursor> _cursor;
+	std::list<relation_callable> _relations;
+	db::RowHydrator<ModelType> _hydrate;
+	ModelType _model;
+	bool _is_started = false;
+
+	// Returns false when there are no more rows.
+	inline bool advance()
+	{
+		const db::Row* row = this->_cursor ? this->_cursor->next() : nullptr;
+		if (!row)
+		{
+			this->close();
+			return false;
+		}
+
+		// The model is reused for each row, so strings keep their
+		// memory. Mapped fields which are NULL in the row are reset
+		// by the hydrator instead of keeping the previous values.
+		this->_hydrate(this->_model, *row);
+		for (auto& callable : this->_relations)
+		{
+			callable(this->_model);
+		}
+
+		return true;
+	}
+};
+
+__ORM_Q_END__
@@ -30,18 +30,6 @@ public:
 		this->table_name = db::get_table_name<ModelType>();
 	};
 
-	// Throws 'QueryError' when driver is not set.
-	[[nodiscard]]
-	inline std::string to_sql() const override
-	{
-		require_non_null(this->query_builder, "SQL query builder is not initialized", _ERROR_DETAILS_);
-		return str::join(
-			" ", this->rows.begin(), this->rows.end(), [this](const auto& row) -> std::string {
-				return this->query_builder->sql_update(this->table_name, row.first, row.second);
-			}
-		);
-	}
-
 	// Throws 'QueryError' if model is null.
 	inline Update& model(const ModelType& model)
 	{
@@ -57,22 +45,88 @@ public:
 			throw QueryError("Trying to update one model, but multiple models were set", _ERROR_DETAILS_);
 		}
 
-		this->db_connection->run_query(this->to_sql(), nullptr, nullptr);
+		this->run_query(
+			[this](auto* parameters) -> auto { return this->build_sql(parameters); }, nullptr, nullptr
+		);
 	}
 
 	// Updates multiple rows in database.
+	//
+	// Rows are updated by separate statements, so each of them
+	// can reuse the same prepared statement. Statements are sent
+	// as a single batch if the connection supports it.
 	inline void commit_batch() const
 	{
-		if (!this->in_transaction)
+		std::vector<typename AbstractQuery<ModelType>::sql_function> statements;
+		statements.reserve(this->rows.size());
+		for (const auto& row : this->rows)
 		{
-			this->db_connection->begin_transaction();
+			statements.emplace_back(
+				[this, &row](auto* parameters) -> auto { return this->build_row_sql(row, parameters); }
+			);
 		}
 
-		this->db_connection->run_query(this->to_sql(), nullptr, nullptr);
-		if (!this->in_transaction)
+		this->run_batch(statements, this->in_transaction);
+	}
+
+	// Acts like 'commit_one()', but does not block the calling thread
+	// if the connection supports asynchronous queries, check
+	// 'IAsyncSQLConnection' for details.
+	//
+	// Throws 'QueryError' if more than one model was set.
+	inline void commit_one_async(IAsyncSQLConnection::completion_handler completion) const
+	{
+		if (this->rows.size() > 1)
+		{
+			throw QueryError("Trying to update one model, but multiple models were set", _ERROR_DETAILS_);
+		}
+
+		this->run_query_async(
+			[this](auto* parameters) -> auto { return this->build_sql(parameters); }, nullptr, std::move(completion)
+		);
+	}
+
+	[[nodiscard]]
+	inline std::future<void> commit_one_async() const
+	{
+		return this->as_future([this](auto completion) { this->commit_one_async(std::move(completion)); });
+	}
+
+	// Awaitable version of 'commit_one_async'.
+	[[nodiscard]]
+	inline Awaitable<> co_commit_one() const
+	{
+		return this->as_awaitable([this](auto completion) { this->commit_one_async(std::move(completion)); });
+	}
+
+	// Acts like 'commit_batch()', but does not block the calling
+	// thread if the connection supports asynchronous queries, check
+	// 'AbstractQuery::run_batch_async' for details.
+	inline void commit_batch_async(IAsyncSQLConnection::completion_handler completion) const
+	{
+		std::vector<typename AbstractQuery<ModelType>::sql_function> statements;
+		statements.reserve(this->rows.size());
+		for (const auto& row : this->rows)
 		{
-			this->db_connection->end_transaction();
+			statements.emplace_back(
+				[this, &row](auto* parameters) -> auto { return this->build_row_sql(row, parameters); }
+			);
 		}
+
+		this->run_batch_async(statements, this->in_transaction, std::move(completion));
+	}
+
+	[[nodiscard]]
+	inline std::future<void> commit_batch_async() const
+	{
+		return this->as_future([this](auto completion) { this->commit_batch_async(std::move(completion)); });
+	}
+
+	// Awaitable version of 'commit_batch_async'.
+	[[nodiscard]]
+	inline Awaitable<> co_commit_batch() const
+	{
+		return this->as_awaitable([this](auto completion) { this->commit_batch_async(std::move(completion)); });
 	}
 
 protected:
@@ -91,7 +145,41 @@ protected:
 	//
 	// `second`: condition for 'WHERE' statement.
 	//	Indicates what rows should be updated.
-	std::vector<std::pair<std::string, q::Condition>> rows;
+	std::vector<std::pair<q::Condition, q::Condition>> rows;
+
+	// Throws 'QueryError' when driver is not set.
+	[[nodiscard]]
+	inline std::string build_sql(std::vector<db::Parameter>* parameters) const override
+	{
+		return str::join(
+			" ", this->rows.begin(), this->rows.end(), [this, parameters](const auto& row) -> std::string {
+				return this->build_row_sql(row, parameters);
+			}
+		);
+	}
+
+	[[nodiscard]]
+	inline std::string build_row_sql(
+		const std::pair<q::Condition, q::Condition>& row, std::vector<db::Parameter>* parameters
+	) const
+	{
+		auto* builder = require_non_null(
+			this->query_builder, "SQL query builder is not initialized", _ERROR_DETAILS_
+		);
+		std::string columns_data;
+		if (parameters)
+		{
+			columns_data = row.first.to_sql(
+				[builder](size_t index) -> auto { return builder->sql_placeholder(index); }, *parameters
+			);
+		}
+		else
+		{
+			columns_data = (std::string)row.first;
+		}
+
+		return builder->sql_update(this->table_name, columns_data, row.second, parameters);
+	}
 
 	inline void append_model(const ModelType& model)
 	{
@@ -100,16 +188,14 @@ protected:
 			throw QueryError("Unable to update null model", _ERROR_DETAILS_);
 		}
 
-		std::string pk_name, pk_val;
-		std::pair<std::string, q::Condition> row_data;
+		std::string pk_name;
+		db::Parameter pk_val;
+		std::pair<q::Condition, q::Condition> row_data;
 		util::tuple_for_each(ModelType::meta_columns, [model, &pk_name, &pk_val, &row_data](auto& column)
 		{
-			using field_type = typename std::remove_reference<decltype(column)>::type;
-			using T = typename field_type::field_type;
-
 			if (column.is_pk)
 			{
-				pk_val = column.as_string(model);
+				pk_val = column.as_parameter(model);
 				pk_name = column.name;
 
 				if constexpr (ModelType::meta_omit_pk)
@@ -118,12 +204,16 @@ protected:
 				}
 			}
 
-			row_data.first += column.name + " = " + column.as_string(model) + ", ";
+			if (!row_data.first.empty())
+			{
+				row_data.first.append(", ");
+			}
+
+			row_data.first.append(std::string(column.name) + " = ").append(column.as_parameter(model));
 			return true;
 		});
 
-		row_data.first = str::rtrim(row_data.first, ", ");
-		row_data.second = q::ColumnCondition(this->table_name, pk_name, "= " + pk_val);
+		row_data.second = q::ColumnCondition(this->table_name, pk_name, q::Condition("= ").append(pk_val));
 		this->rows.push_back(row_data);
 	}
 };
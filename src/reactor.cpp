@@ -0,0 +1,269 @@
+/**
+ * reactor.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./reactor.h"
+
+// C++ libraries.
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// POSIX
+#include <unistd.h>
+#include <fcntl.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#else
+#include <poll.h>
+#endif
+
+// Base libraries.
+#include <xalwart.base/exceptions.h>
+
+
+__ORM_BEGIN__
+
+Reactor::Reactor(size_t resume_threads_count) : _resume_pool(resume_threads_count)
+{
+#ifdef __linux__
+	this->_epoll = epoll_create1(EPOLL_CLOEXEC);
+	this->_wake_descriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	epoll_event event{};
+	event.events = EPOLLIN;
+	event.data.fd = this->_wake_descriptor;
+	if (
+		this->_epoll < 0 || this->_wake_descriptor < 0 ||
+		epoll_ctl(this->_epoll, EPOLL_CTL_ADD, this->_wake_descriptor, &event) != 0
+	)
+	{
+		auto message = std::string(std::strerror(errno));
+		close(this->_epoll);
+		close(this->_wake_descriptor);
+		throw RuntimeError("Unable to create the reactor: " + message, _ERROR_DETAILS_);
+	}
+#else
+	if (pipe(this->_wake_descriptors) != 0)
+	{
+		throw RuntimeError("Unable to create the reactor: " + std::string(std::strerror(errno)), _ERROR_DETAILS_);
+	}
+
+	for (auto descriptor : this->_wake_descriptors)
+	{
+		fcntl(descriptor, F_SETFL, fcntl(descriptor, F_GETFL) | O_NONBLOCK);
+		fcntl(descriptor, F_SETFD, FD_CLOEXEC);
+	}
+#endif
+
+	this->_thread = std::thread(&Reactor::_run, this);
+}
+
+Reactor::~Reactor()
+{
+	this->_is_stopped = true;
+	this->_wake();
+	this->_thread.join();
+#ifdef __linux__
+	close(this->_wake_descriptor);
+	close(this->_epoll);
+#else
+	close(this->_wake_descriptors[0]);
+	close(this->_wake_descriptors[1]);
+#endif
+}
+
+void Reactor::watch(int descriptor, unsigned events, Handler handler)
+{
+	std::lock_guard<std::mutex> lock(this->_mutex);
+#ifdef __linux__
+	epoll_event event{};
+	event.events = EPOLLONESHOT | (events & Readable ? (unsigned)EPOLLIN : 0u) | (events & Writable ? (unsigned)EPOLLOUT : 0u);
+	event.data.fd = descriptor;
+
+	// Descriptor number can be reused after closing, so the
+	// registration is checked by the kernel as well.
+	auto operation = this->_registered.contains(descriptor) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+	auto result = epoll_ctl(this->_epoll, operation, descriptor, &event);
+	if (result != 0 && (errno == ENOENT || errno == EEXIST))
+	{
+		operation = operation == EPOLL_CTL_MOD ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+		result = epoll_ctl(this->_epoll, operation, descriptor, &event);
+	}
+
+	if (result != 0)
+	{
+		throw RuntimeError(
+			"Unable to watch descriptor " + std::to_string(descriptor) + ": " + std::strerror(errno),
+			_ERROR_DETAILS_
+		);
+	}
+
+	this->_registered.insert(descriptor);
+	this->_watchers[descriptor] = {events, std::move(handler)};
+#else
+	this->_watchers[descriptor] = {events, std::move(handler)};
+
+	// The thread waits for the previous set of descriptors.
+	if (!this->is_reactor_thread())
+	{
+		this->_wake();
+	}
+#endif
+}
+
+void Reactor::unwatch(int descriptor)
+{
+	std::unique_lock<std::mutex> lock(this->_mutex);
+	this->_watchers.erase(descriptor);
+#ifdef __linux__
+	if (this->_registered.erase(descriptor))
+	{
+		epoll_ctl(this->_epoll, EPOLL_CTL_DEL, descriptor, nullptr);
+	}
+#endif
+
+	if (!this->is_reactor_thread())
+	{
+		this->_handler_finished.wait(lock, [this, descriptor] {
+			return this->_running_descriptor != descriptor;
+		});
+	}
+}
+
+void Reactor::_run()
+{
+	// Handlers complete awaitables, which must not resume
+	// coroutines on this thread.
+	event_loop_executor() = this->_resume_pool.executor();
+#ifdef __linux__
+	constexpr int MAX_EVENTS = 64;
+	epoll_event events[MAX_EVENTS];
+	while (!this->_is_stopped)
+	{
+		auto count = epoll_wait(this->_epoll, events, MAX_EVENTS, -1);
+		for (auto i = 0; i < count && !this->_is_stopped; i++)
+		{
+			if (events[i].data.fd == this->_wake_descriptor)
+			{
+				uint64_t value;
+				while (read(this->_wake_descriptor, &value, sizeof(value)) > 0);
+				continue;
+			}
+
+			unsigned ready = 0;
+			if (events[i].events & (EPOLLERR | EPOLLHUP))
+			{
+				ready = Readable | Writable;
+			}
+			else
+			{
+				ready = (events[i].events & EPOLLIN ? (unsigned)Readable : 0u) | (events[i].events & EPOLLOUT ? (unsigned)Writable : 0u);
+			}
+
+			this->_dispatch(events[i].data.fd, ready);
+		}
+	}
+#else
+	std::vector<pollfd> descriptors;
+	while (!this->_is_stopped)
+	{
+		descriptors.clear();
+		descriptors.push_back({this->_wake_descriptors[0], POLLIN, 0});
+		{
+			std::lock_guard<std::mutex> lock(this->_mutex);
+			for (const auto& [descriptor, watcher] : this->_watchers)
+			{
+				descriptors.push_back({descriptor, (short)(
+					(watcher.events & Readable ? POLLIN : 0) | (watcher.events & Writable ? POLLOUT : 0)
+				), 0});
+			}
+		}
+
+		if (poll(descriptors.data(), descriptors.size(), -1) < 0)
+		{
+			continue;
+		}
+
+		if (descriptors[0].revents)
+		{
+			char buffer[64];
+			while (read(this->_wake_descriptors[0], buffer, sizeof(buffer)) > 0);
+		}
+
+		for (size_t i = 1; i < descriptors.size() && !this->_is_stopped; i++)
+		{
+			const auto& descriptor = descriptors[i];
+			if (!descriptor.revents)
+			{
+				continue;
+			}
+
+			unsigned ready = 0;
+			if (descriptor.revents & (POLLERR | POLLHUP | POLLNVAL))
+			{
+				ready = Readable | Writable;
+			}
+			else
+			{
+				ready = (descriptor.revents & POLLIN ? (unsigned)Readable : 0u) | (descriptor.revents & POLLOUT ? (unsigned)Writable : 0u);
+			}
+
+			this->_dispatch(descriptor.fd, ready);
+		}
+	}
+#endif
+}
+
+void Reactor::_dispatch(int descriptor, unsigned events)
+{
+	Handler handler;
+	{
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		auto watcher = this->_watchers.find(descriptor);
+		if (watcher == this->_watchers.end())
+		{
+			return;
+		}
+
+		handler = std::move(watcher->second.handler);
+		this->_watchers.erase(watcher);
+		this->_running_descriptor = descriptor;
+	}
+
+	try
+	{
+		handler(events);
+	}
+	catch (...)
+	{
+		// Handlers report errors by themselves, the thread
+		// keeps serving other descriptors.
+	}
+
+	// State captured by the handler is released before
+	// 'unwatch' is allowed to return.
+	handler = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		this->_running_descriptor = -1;
+	}
+
+	this->_handler_finished.notify_all();
+}
+
+void Reactor::_wake()
+{
+#ifdef __linux__
+	uint64_t value = 1;
+	[[maybe_unused]] auto result = write(this->_wake_descriptor, &value, sizeof(value));
+#else
+	char value = 1;
+	[[maybe_unused]] auto result = write(this->_wake_descriptors[1], &value, 1);
+#endif
+}
+
+__ORM_END__
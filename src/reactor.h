@@ -0,0 +1,124 @@
+/**
+ * reactor.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Background thread which waits for readiness of sockets.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+// Module definitions.
+#include "./_def_.h"
+
+// Orm libraries.
+#include "./coroutine.h"
+
+
+__ORM_BEGIN__
+
+// Runs handlers of file descriptors when they become ready. All
+// handlers are called from a single background thread, so they
+// should not block. Uses epoll on Linux and poll on other systems.
+class Reactor final
+{
+public:
+	enum Event : unsigned
+	{
+		Readable = 1 << 0, Writable = 1 << 1
+	};
+
+	// Receives events which are ready. Errors and hang-ups are
+	// reported as both events, so the handler finds them on
+	// the next read or write.
+	using Handler = std::function<void(unsigned /* events */)>;
+
+	// Starts the thread of the reactor and 'resume_threads_count'
+	// threads, at least one, which resume coroutines awaiting results
+	// of handlers.
+	//
+	// Throws 'RuntimeError' if the system does not provide
+	// resources for waiting.
+	explicit Reactor(size_t resume_threads_count=2);
+
+	Reactor(const Reactor&) = delete;
+
+	Reactor& operator= (const Reactor&) = delete;
+
+	// Stops the thread. Handlers which are waiting are dropped.
+	~Reactor();
+
+	// Calls 'handler' once when 'descriptor' is ready for some of
+	// 'events'. Replaces the previous handler of 'descriptor', so
+	// the handler watches the descriptor again if needed.
+	//
+	// Throws 'RuntimeError' if the descriptor can not be watched.
+	void watch(int descriptor, unsigned events, Handler handler);
+
+	// Drops the handler of 'descriptor'. Must be called before the
+	// descriptor is closed. If the handler is running in other thread,
+	// waits until it finishes.
+	void unwatch(int descriptor);
+
+	[[nodiscard]]
+	inline bool is_reactor_thread() const
+	{
+		return std::this_thread::get_id() == this->_thread.get_id();
+	}
+
+private:
+	struct Watcher
+	{
+		unsigned events;
+		Handler handler;
+	};
+
+	std::mutex _mutex;
+	std::condition_variable _handler_finished;
+	std::unordered_map<int, Watcher> _watchers;
+
+	// Descriptor which handler is running, -1 if none.
+	int _running_descriptor = -1;
+
+#ifdef __linux__
+	int _epoll = -1;
+
+	// Descriptors which are added to epoll. One-shot descriptors stay
+	// there after firing, so they are modified on the next watch.
+	std::unordered_set<int> _registered;
+
+	// 'eventfd' which wakes the thread to stop.
+	int _wake_descriptor = -1;
+#else
+	// Pipe which wakes the thread to rebuild the set of descriptors.
+	int _wake_descriptors[2] = {-1, -1};
+#endif
+
+	std::atomic<bool> _is_stopped = false;
+
+	// Resumes coroutines instead of the thread of the reactor, check
+	// 'event_loop_executor'. Outlives the thread, so coroutines
+	// which are resumed last are not dropped.
+	ThreadPool _resume_pool;
+
+	std::thread _thread;
+
+	void _run();
+
+	// Takes the handler of 'descriptor' and calls it. Handlers are
+	// called without the lock, so they can watch descriptors again.
+	void _dispatch(int descriptor, unsigned events);
+
+	void _wake();
+};
+
+__ORM_END__
@@ -0,0 +1,274 @@
+/**
+ * replica_pool.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./replica_pool.h"
+
+// C++ libraries.
+#include <algorithm>
+#include <exception>
+#include <numeric>
+#include <optional>
+
+// Orm libraries.
+#include "./exceptions.h"
+
+
+__ORM_BEGIN__
+
+static void add_histogram(DurationHistogram& to, const DurationHistogram& from)
+{
+	for (size_t i = 0; i < DurationHistogram::BUCKETS_COUNT; i++)
+	{
+		to.buckets[i] += from.buckets[i];
+	}
+
+	to.count += from.count;
+	to.total += from.total;
+	to.max = std::max(to.max, from.max);
+}
+
+ReplicaPool::ReplicaPool(
+	std::vector<std::unique_ptr<IConnectionPool>> pools, ReplicaRouting routing,
+	std::chrono::milliseconds failure_backoff
+) : _pools(std::move(pools)), _routing(routing), _failure_backoff(failure_backoff), _failed_until(_pools.size())
+{
+	if (this->_pools.empty())
+	{
+		throw ValueError("Replica pool requires at least one pool", _ERROR_DETAILS_);
+	}
+
+	if (std::any_of(this->_pools.begin(), this->_pools.end(), [](const auto& pool) { return !pool; }))
+	{
+		throw ValueError("Pool of replica is nullptr", _ERROR_DETAILS_);
+	}
+}
+
+void ReplicaPool::create()
+{
+	auto now = std::chrono::steady_clock::now();
+	std::exception_ptr error = nullptr;
+	size_t failures_count = 0;
+	for (size_t i = 0; i < this->_pools.size(); i++)
+	{
+		try
+		{
+			this->_pools[i]->create();
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+			failures_count++;
+			this->_failed_until[i].store(
+				(now + this->_failure_backoff).time_since_epoch().count(), std::memory_order_relaxed
+			);
+		}
+	}
+
+	if (failures_count == this->_pools.size())
+	{
+		std::rethrow_exception(error);
+	}
+}
+
+std::shared_ptr<IDatabaseConnection> ReplicaPool::acquire()
+{
+	return this->_acquire([](IConnectionPool* pool) { return pool->acquire(); });
+}
+
+std::shared_ptr<IDatabaseConnection> ReplicaPool::acquire(std::chrono::milliseconds timeout)
+{
+	return this->_acquire([timeout](IConnectionPool* pool) { return pool->acquire(timeout); });
+}
+
+std::shared_ptr<IDatabaseConnection> ReplicaPool::try_acquire()
+{
+	std::optional<size_t> exhausted_index;
+	std::exception_ptr error = nullptr;
+	if (auto connection = this->_try_acquire(exhausted_index, error))
+	{
+		return connection;
+	}
+
+	if (exhausted_index.has_value())
+	{
+		return nullptr;
+	}
+
+	std::rethrow_exception(error);
+}
+
+void ReplicaPool::release(const std::shared_ptr<IDatabaseConnection>& connection)
+{
+	size_t index;
+	{
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		auto owner = this->_owners.find(connection.get());
+		if (owner == this->_owners.end())
+		{
+			throw ValueError("Connection does not belong to the pool", _ERROR_DETAILS_);
+		}
+
+		index = owner->second;
+		this->_owners.erase(owner);
+	}
+
+	this->_pools[index]->release(connection);
+}
+
+void ReplicaPool::evict_idle_connections()
+{
+	for (auto& pool : this->_pools)
+	{
+		pool->evict_idle_connections();
+	}
+}
+
+size_t ReplicaPool::connections_count()
+{
+	size_t count = 0;
+	for (auto& pool : this->_pools)
+	{
+		count += pool->connections_count();
+	}
+
+	return count;
+}
+
+size_t ReplicaPool::idle_connections_count()
+{
+	size_t count = 0;
+	for (auto& pool : this->_pools)
+	{
+		count += pool->idle_connections_count();
+	}
+
+	return count;
+}
+
+PoolMetrics ReplicaPool::metrics()
+{
+	PoolMetrics result;
+	for (auto& pool : this->_pools)
+	{
+		auto metrics = pool->metrics();
+		result.connections_count += metrics.connections_count;
+		result.used_connections_count += metrics.used_connections_count;
+		result.idle_connections_count += metrics.idle_connections_count;
+		result.waiters_count += metrics.waiters_count;
+		result.created_count += metrics.created_count;
+		result.creation_failures_count += metrics.creation_failures_count;
+		result.timeouts_count += metrics.timeouts_count;
+		result.evicted_count += metrics.evicted_count;
+		add_histogram(result.acquire_wait_time, metrics.acquire_wait_time);
+		add_histogram(result.hold_time, metrics.hold_time);
+	}
+
+	return result;
+}
+
+std::vector<size_t> ReplicaPool::_order()
+{
+	std::vector<size_t> order(this->_pools.size());
+	if (this->_routing == ReplicaRouting::RoundRobin)
+	{
+		auto first = this->_next_index.fetch_add(1, std::memory_order_relaxed);
+		for (size_t i = 0; i < order.size(); i++)
+		{
+			order[i] = (first + i) % order.size();
+		}
+
+		return order;
+	}
+
+	std::vector<size_t> used(this->_pools.size());
+	for (size_t i = 0; i < this->_pools.size(); i++)
+	{
+		auto count = this->_pools[i]->connections_count();
+		used[i] = count - std::min(count, this->_pools[i]->idle_connections_count());
+	}
+
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&used](size_t left, size_t right)
+	{
+		return used[left] < used[right];
+	});
+	return order;
+}
+
+template <typename AcquireFunc>
+std::shared_ptr<IDatabaseConnection> ReplicaPool::_acquire(AcquireFunc acquire)
+{
+	std::optional<size_t> exhausted_index;
+	std::exception_ptr error = nullptr;
+	if (auto connection = this->_try_acquire(exhausted_index, error))
+	{
+		return connection;
+	}
+
+	if (exhausted_index.has_value())
+	{
+		return this->_own(acquire(this->_pools[exhausted_index.value()].get()), exhausted_index.value());
+	}
+
+	std::rethrow_exception(error);
+}
+
+std::shared_ptr<IDatabaseConnection> ReplicaPool::_try_acquire(
+	std::optional<size_t>& exhausted_index, std::exception_ptr& error
+)
+{
+	auto now = std::chrono::steady_clock::now();
+	auto order = this->_order();
+	auto backed_off = std::stable_partition(order.begin(), order.end(), [this, &now](size_t index)
+	{
+		return this->_failed_until[index].load(std::memory_order_relaxed) <= now.time_since_epoch().count();
+	});
+	for (auto it = order.begin(); it != order.end(); it++)
+	{
+		// Backed off pools are probed only if other pools failed,
+		// otherwise it is better to wait for the exhausted one.
+		if (it == backed_off && exhausted_index.has_value())
+		{
+			break;
+		}
+
+		auto index = *it;
+		try
+		{
+			auto connection = this->_pools[index]->try_acquire();
+			if (!connection)
+			{
+				if (!exhausted_index.has_value())
+				{
+					exhausted_index = index;
+				}
+
+				continue;
+			}
+
+			this->_failed_until[index].store(0, std::memory_order_relaxed);
+			return this->_own(std::move(connection), index);
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+			this->_failed_until[index].store(
+				(now + this->_failure_backoff).time_since_epoch().count(), std::memory_order_relaxed
+			);
+		}
+	}
+
+	return nullptr;
+}
+
+std::shared_ptr<IDatabaseConnection> ReplicaPool::_own(std::shared_ptr<IDatabaseConnection> connection, size_t index)
+{
+	std::lock_guard<std::mutex> lock(this->_mutex);
+	this->_owners[connection.get()] = index;
+	return connection;
+}
+
+__ORM_END__
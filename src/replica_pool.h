@@ -0,0 +1,140 @@
+/**
+ * replica_pool.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Pool which distributes connections between several databases.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <exception>
+#include <optional>
+#include <vector>
+#include <unordered_map>
+
+// Module definitions.
+#include "./_def_.h"
+
+// Orm libraries.
+#include "./pool.h"
+
+
+__ORM_BEGIN__
+
+enum class ReplicaRouting
+{
+	// Pools are tried in turn starting from the next one for
+	// each request.
+	RoundRobin,
+
+	// Pools are tried in ascending order of used connections.
+	LeastLoaded
+};
+
+// Combines pools of replicas of the same database. The request is
+// served by the first pool in order of 'routing' which has a free
+// connection. If all pools are exhausted, the request waits for the
+// first of them. Pools which fail to open connections are skipped,
+// so a replica which is down does not fail reads while others work.
+//
+// A pool which fails is not tried again during 'failure_backoff',
+// unless all other pools fail too, so requests do not pay for
+// connecting to the replica which is down.
+class ReplicaPool final : public IConnectionPool
+{
+public:
+	static constexpr std::chrono::milliseconds DEFAULT_FAILURE_BACKOFF = std::chrono::seconds(1);
+
+	// Throws 'ValueError' if 'pools' is empty or contains nullptr.
+	ReplicaPool(
+		std::vector<std::unique_ptr<IConnectionPool>> pools, ReplicaRouting routing,
+		std::chrono::milliseconds failure_backoff=DEFAULT_FAILURE_BACKOFF
+	);
+
+	// Pools which fail to open connections are backed off like on
+	// acquiring, so the replica which is down does not fail startup.
+	//
+	// Rethrows the last error if all pools fail.
+	void create() override;
+
+	// Waits during 'acquire_timeout' of the pool which is chosen
+	// to wait.
+	std::shared_ptr<IDatabaseConnection> acquire() override;
+
+	std::shared_ptr<IDatabaseConnection> acquire(std::chrono::milliseconds timeout) override;
+
+	// Returns nullptr if all pools which work are exhausted.
+	std::shared_ptr<IDatabaseConnection> try_acquire() override;
+
+	// Throws 'ValueError' if the connection does not belong to
+	// the pool.
+	void release(const std::shared_ptr<IDatabaseConnection>& connection) override;
+
+	void evict_idle_connections() override;
+
+	[[nodiscard]]
+	size_t connections_count() override;
+
+	[[nodiscard]]
+	size_t idle_connections_count() override;
+
+	// Sum of metrics of all pools. 'max' of histograms is the
+	// maximum of all pools.
+	[[nodiscard]]
+	PoolMetrics metrics() override;
+
+	[[nodiscard]]
+	inline size_t pools_count() const
+	{
+		return this->_pools.size();
+	}
+
+	// Returns metrics of the pool with 'index' in order of
+	// construction.
+	[[nodiscard]]
+	inline PoolMetrics metrics(size_t index)
+	{
+		return this->_pools.at(index)->metrics();
+	}
+
+private:
+	std::vector<std::unique_ptr<IConnectionPool>> _pools;
+	const ReplicaRouting _routing;
+	std::atomic<size_t> _next_index = 0;
+
+	const std::chrono::milliseconds _failure_backoff;
+
+	// Time until which each pool is skipped after the failure, zero
+	// if the pool works.
+	std::vector<std::atomic<std::chrono::steady_clock::rep>> _failed_until;
+
+	// Index of the pool which provided each used connection.
+	std::mutex _mutex;
+	std::unordered_map<const IDatabaseConnection*, size_t> _owners;
+
+	// Returns indices of pools in order of trying.
+	std::vector<size_t> _order();
+
+	// Calls 'acquire' for pools in order of routing, waits only in
+	// the first pool which is exhausted.
+	template <typename AcquireFunc>
+	std::shared_ptr<IDatabaseConnection> _acquire(AcquireFunc acquire);
+
+	// Probes pools in order of routing without waiting. Pools which
+	// are backed off are probed only if all other pools fail. Sets
+	// 'exhausted_index' to the first exhausted pool and 'error' to
+	// the last failure.
+	std::shared_ptr<IDatabaseConnection> _try_acquire(
+		std::optional<size_t>& exhausted_index, std::exception_ptr& error
+	);
+
+	std::shared_ptr<IDatabaseConnection> _own(std::shared_ptr<IDatabaseConnection> connection, size_t index);
+};
+
+__ORM_END__
@@ -15,7 +15,7 @@ __ORM_BEGIN__
 
 void Repository::transaction(const std::function<void(Transaction&)>& func)
 {
-	this->ensure_connection();
+	this->ensure_write_connection();
 	this->wrap([&](auto*)
 	{
 		auto tr = Transaction(this->connection.get(), this->sql_backend->sql_builder());
@@ -21,6 +21,7 @@
 // Orm libraries.
 #include "./backend.h"
 #include "./transaction.h"
+#include "./coroutine.h"
 
 
 __ORM_BEGIN__
@@ -31,10 +32,21 @@ __ORM_BEGIN__
 // reuses it and returns it back on object destruction.
 // Also, the connection can be returned manually by
 // calling 'free_connection()' method.
+//
+// If the backend has a pool of read connections, 'select'
+// uses a separate connection from it, other queries and
+// transactions use the main one. Selects run on the main
+// connection while it has a transaction in progress or after
+// some query which modifies the database was created on it
+// until the connection is freed, so reads never miss writes of
+// the repository because of replication lag. Statements of
+// 'select' which modify the database, like 'delete_', always
+// run on the main connection.
 class Repository
 {
 public:
-	inline Repository() noexcept : sql_backend(nullptr), connection(nullptr)
+	inline Repository() noexcept :
+		sql_backend(nullptr), connection(nullptr), read_connection(nullptr), is_written(false)
 	{
 	}
 
@@ -91,33 +103,98 @@ public:
 			this->sql_backend->release_connection(this->connection);
 			this->connection = nullptr;
 		}
+
+		this->is_written = false;
+
+		if (this->read_connection)
+		{
+			dynamic_cast<DefaultSQLBackend*>(this->sql_backend)->release_read_connection(this->read_connection);
+			this->read_connection = nullptr;
+		}
+	}
+
+	// Requests the database connection without blocking of the calling
+	// thread if the backend supports it, check
+	// 'DefaultSQLBackend::get_connection_async' for details. If the
+	// backend has a pool of read connections, the read connection is
+	// requested the same way after the main one. Queries which are
+	// created after awaiting use the received connections, so they do
+	// not block the coroutine.
+	[[nodiscard]]
+	inline Awaitable<> co_connect()
+	{
+		return Awaitable<>([this](auto handler) -> void {
+			auto* backend = dynamic_cast<DefaultSQLBackend*>(this->sql_backend);
+			if (!backend)
+			{
+				this->ensure_connection();
+				handler({}, nullptr);
+				return;
+			}
+
+			auto connect_read = [this, backend, handler](std::exception_ptr error) -> void {
+				if (error || this->read_connection || !backend->has_read_pool())
+				{
+					handler({}, error);
+					return;
+				}
+
+				backend->get_read_connection_async([this, handler](auto connection, auto read_error) -> void {
+					this->read_connection = std::move(connection);
+					handler({}, read_error);
+				});
+			};
+			if (this->connection)
+			{
+				connect_read(nullptr);
+				return;
+			}
+
+			backend->get_connection_async([this, connect_read](auto connection, auto error) -> void {
+				this->connection = std::move(connection);
+				connect_read(error);
+			});
+		});
 	}
 
 	template <class T>
 	inline q::Insert<T> insert()
 	{
-		this->ensure_connection();
+		this->ensure_write_connection();
 		return q::Insert<T>(this->connection.get(), this->sql_backend->sql_builder());
 	}
 
 	template <class T>
 	inline q::Select<T> select()
 	{
-		this->ensure_connection();
-		return q::Select<T>(this->connection.get(), this->sql_backend->sql_builder());
+		return q::Select<T>(
+			this->ensure_read_connection(), this->sql_backend->sql_builder(),
+			[this]() -> const IDatabaseConnection* {
+				this->ensure_write_connection();
+				return this->connection.get();
+			}
+		);
+	}
+
+	// Runs 'query' which was compiled by 'select<T>().compile()'
+	// with 'parameters' bound, check 'q::CompiledSelect' for details.
+	template <class T>
+	inline std::list<T> select(const q::CompiledSelect<T>& query, const std::vector<db::Parameter>& parameters)
+	{
+		return query.all(this->ensure_read_connection(), parameters);
 	}
 
 	template <class T>
 	inline q::Update<T> update()
 	{
-		this->ensure_connection();
+		this->ensure_write_connection();
 		return q::Update<T>(this->connection.get(), this->sql_backend->sql_builder());
 	}
 
 	template <class T>
 	inline q::Delete<T> delete_()
 	{
-		this->ensure_connection();
+		this->ensure_write_connection();
 		return q::Delete<T>(this->connection.get(), this->sql_backend->sql_builder());
 	}
 
@@ -130,6 +207,13 @@ protected:
 	ISQLBackend* sql_backend = nullptr;
 	std::shared_ptr<IDatabaseConnection> connection = nullptr;
 
+	// Connection from the pool of read connections of the backend.
+	std::shared_ptr<IDatabaseConnection> read_connection = nullptr;
+
+	// Set when the query which modifies the database is created on
+	// the main connection, reset when the connection is freed.
+	bool is_written = false;
+
 	inline void check_state() const
 	{
 		require_non_null(
@@ -148,11 +232,52 @@ protected:
 		}
 	}
 
+	// Acts like 'ensure_connection', but marks the main connection
+	// as written, so 'select' reads it later.
+	inline void ensure_write_connection()
+	{
+		this->ensure_connection();
+		this->is_written = true;
+	}
+
+	// Returns true if the main connection is acquired and has
+	// the transaction in progress.
+	[[nodiscard]]
+	inline bool is_in_transaction() const
+	{
+		auto* sql_connection = dynamic_cast<const ISQLConnection*>(this->connection.get());
+		return sql_connection && sql_connection->is_in_transaction();
+	}
+
+	// Returns the read connection if the backend has a pool of
+	// them, otherwise the main one. The main one is returned also
+	// after writing or while it has the transaction in progress,
+	// so the repository reads its own changes.
+	inline IDatabaseConnection* ensure_read_connection()
+	{
+		this->check_state();
+		auto* backend = dynamic_cast<DefaultSQLBackend*>(this->sql_backend);
+		if (!backend || !backend->has_read_pool() || this->is_written || this->is_in_transaction())
+		{
+			this->ensure_connection();
+			return this->connection.get();
+		}
+
+		if (!this->read_connection)
+		{
+			this->read_connection = backend->get_read_connection();
+		}
+
+		return this->read_connection.get();
+	}
+
 private:
 	inline void _copy_from(const Repository& other) noexcept
 	{
 		this->sql_backend = other.sql_backend;
 		this->connection = other.connection;
+		this->read_connection = other.read_connection;
+		this->is_written = other.is_written;
 	}
 
 	inline void _move_from(Repository&& other) noexcept
@@ -161,6 +286,10 @@ private:
 		other.sql_backend = nullptr;
 		this->connection = std::move(other.connection);
 		other.connection = nullptr;
+		this->read_connection = std::move(other.read_connection);
+		other.read_connection = nullptr;
+		this->is_written = other.is_written;
+		other.is_written = false;
 	}
 };
 
@@ -0,0 +1,429 @@
+/**
+ * sharded_pool.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./sharded_pool.h"
+
+// C++ libraries.
+#include <algorithm>
+#include <thread>
+#include <string>
+#include <vector>
+
+// Orm libraries.
+#include "./exceptions.h"
+
+
+__ORM_BEGIN__
+
+void ShardedConnectionPool::SlotStack::push(Slot* slots, slot_ref ref)
+{
+	auto head = this->head.load();
+	uint64_t new_head;
+	do
+	{
+		slots[ref - 1].next.store((slot_ref)head, std::memory_order_relaxed);
+		new_head = (((head >> 32) + 1) << 32) | ref;
+	}
+	while (!this->head.compare_exchange_weak(head, new_head));
+}
+
+ShardedConnectionPool::slot_ref ShardedConnectionPool::SlotStack::pop(Slot* slots)
+{
+	auto head = this->head.load();
+	while ((slot_ref)head)
+	{
+		auto next = slots[(slot_ref)head - 1].next.load(std::memory_order_relaxed);
+		uint64_t new_head = (((head >> 32) + 1) << 32) | next;
+		if (this->head.compare_exchange_weak(head, new_head))
+		{
+			return (slot_ref)head;
+		}
+	}
+
+	return 0;
+}
+
+ShardedConnectionPool::ShardedConnectionPool(const PoolOptions& options, ConnectionBuilder builder) :
+	_options(options), _connection_builder(std::move(builder))
+{
+	this->_slots = std::make_unique<Slot[]>(options.max_connections);
+	for (auto ref = (slot_ref)options.max_connections; ref > 0; ref--)
+	{
+		this->_empty_slots.push(this->_slots.get(), ref);
+	}
+
+	// Shard caches only one connection, so there is no sense
+	// to have more shards than connections.
+	this->_shards_count = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, options.max_connections);
+	this->_shards = std::make_unique<Shard[]>(this->_shards_count);
+	this->_metrics = std::make_unique<PoolMetricsCollector>(this->_shards_count);
+}
+
+void ShardedConnectionPool::create()
+{
+	for (size_t i = 0; i < this->_options.min_connections; i++)
+	{
+		auto ref = this->_empty_slots.pop(this->_slots.get());
+		if (!ref)
+		{
+			break;
+		}
+
+		auto connection = this->_open_connection(ref);
+		this->release(connection);
+	}
+}
+
+std::shared_ptr<IDatabaseConnection> ShardedConnectionPool::acquire()
+{
+	return this->_acquire(this->_options.acquire_timeout);
+}
+
+std::shared_ptr<IDatabaseConnection> ShardedConnectionPool::acquire(std::chrono::milliseconds timeout)
+{
+	return this->_acquire(timeout);
+}
+
+std::shared_ptr<IDatabaseConnection> ShardedConnectionPool::try_acquire()
+{
+	auto requested_at = std::chrono::steady_clock::now();
+	auto shard_index = this->_current_shard_index();
+	while (true)
+	{
+		auto eviction_sequence = this->_eviction_sequence.load();
+		if (auto ref = this->_take_free_slot(shard_index))
+		{
+			return this->_provide(ref, false, shard_index, requested_at);
+		}
+
+		if (auto ref = this->_empty_slots.pop(this->_slots.get()))
+		{
+			return this->_provide(ref, true, shard_index, requested_at);
+		}
+
+		if (eviction_sequence % 2 == 0 && this->_eviction_sequence.load() == eviction_sequence)
+		{
+			return nullptr;
+		}
+
+		// Free connections could be held by the eviction pass, which
+		// returns them before releasing the lock.
+		std::lock_guard<std::mutex> lock(this->_mutex);
+	}
+}
+
+void ShardedConnectionPool::release(const std::shared_ptr<IDatabaseConnection>& connection)
+{
+	auto* deleter = std::get_deleter<SlotDeleter>(connection);
+	if (
+		!deleter || deleter->ref > this->_options.max_connections ||
+		this->_slot(deleter->ref).connection != connection
+	)
+	{
+		throw ValueError("Connection does not belong to the pool", _ERROR_DETAILS_);
+	}
+
+	auto ref = deleter->ref;
+	auto& slot = this->_slot(ref);
+	auto released_at = std::chrono::steady_clock::now().time_since_epoch().count();
+	auto shard_index = this->_current_shard_index();
+
+	// Connections which are opened by 'create' were not acquired.
+	if (auto acquired_at = slot.acquired_at.exchange(0, std::memory_order_relaxed))
+	{
+		this->_metrics->record_release(shard_index, std::chrono::steady_clock::duration(released_at - acquired_at));
+	}
+
+	slot.released_at.store(released_at, std::memory_order_relaxed);
+	slot.state.store(SlotState::Idle);
+
+	// The shard keeps the connection for the next request of the
+	// same thread, if it is already occupied, the connection is
+	// shared with all threads.
+	slot_ref expected = 0;
+	if (!this->_shards[shard_index].cached.compare_exchange_strong(expected, ref))
+	{
+		this->_free_slots.push(this->_slots.get(), ref);
+	}
+
+	this->_notify_waiters(false);
+}
+
+void ShardedConnectionPool::evict_idle_connections()
+{
+	if (!this->_options.idle_timeout.has_value())
+	{
+		return;
+	}
+
+	// Acquirers which find the pool empty take the lock before
+	// waiting, so they see free connections after the pass returns
+	// them instead of failing. Connections are closed after the
+	// lock is released.
+	std::vector<std::shared_ptr<IDatabaseConnection>> evicted_connections;
+	std::unique_lock<std::mutex> lock(this->_mutex);
+	this->_eviction_sequence++;
+	std::vector<slot_ref> free_slots;
+	for (size_t i = 0; i < this->_shards_count; i++)
+	{
+		if (auto ref = this->_shards[i].cached.exchange(0))
+		{
+			free_slots.push_back(ref);
+		}
+	}
+
+	while (auto ref = this->_free_slots.pop(this->_slots.get()))
+	{
+		free_slots.push_back(ref);
+	}
+
+	// The least recently used connections are closed first, the
+	// most recently used ones are returned to the top of the stack.
+	std::sort(free_slots.begin(), free_slots.end(), [this](slot_ref left, slot_ref right) -> bool {
+		return this->_slot(left).released_at.load(std::memory_order_relaxed) <
+			this->_slot(right).released_at.load(std::memory_order_relaxed);
+	});
+	auto expiration_time = (
+		std::chrono::steady_clock::now() - this->_options.idle_timeout.value()
+	).time_since_epoch().count();
+	auto connections_count = this->connections_count();
+	size_t evicted_count = 0;
+	for (auto ref : free_slots)
+	{
+		auto& slot = this->_slot(ref);
+		if (
+			connections_count > this->_options.min_connections &&
+			slot.released_at.load(std::memory_order_relaxed) < expiration_time
+		)
+		{
+			evicted_connections.push_back(std::move(slot.connection));
+			slot.connection = nullptr;
+			slot.state.store(SlotState::Empty);
+			this->_empty_slots.push(this->_slots.get(), ref);
+			connections_count--;
+			evicted_count++;
+		}
+		else
+		{
+			this->_free_slots.push(this->_slots.get(), ref);
+		}
+	}
+
+	this->_eviction_sequence++;
+	lock.unlock();
+	evicted_connections.clear();
+	if (evicted_count)
+	{
+		this->_metrics->record_eviction(this->_current_shard_index(), evicted_count);
+	}
+
+	this->_notify_waiters(true);
+}
+
+size_t ShardedConnectionPool::connections_count()
+{
+	size_t count = 0;
+	for (size_t i = 0; i < this->_options.max_connections; i++)
+	{
+		count += this->_slots[i].state.load(std::memory_order_relaxed) != SlotState::Empty;
+	}
+
+	return count;
+}
+
+size_t ShardedConnectionPool::idle_connections_count()
+{
+	size_t count = 0;
+	for (size_t i = 0; i < this->_options.max_connections; i++)
+	{
+		count += this->_slots[i].state.load(std::memory_order_relaxed) == SlotState::Idle;
+	}
+
+	return count;
+}
+
+PoolMetrics ShardedConnectionPool::metrics()
+{
+	size_t connections_count = 0;
+	size_t idle_connections_count = 0;
+	for (size_t i = 0; i < this->_options.max_connections; i++)
+	{
+		auto state = this->_slots[i].state.load(std::memory_order_relaxed);
+		connections_count += state != SlotState::Empty;
+		idle_connections_count += state == SlotState::Idle;
+	}
+
+	return this->_metrics->snapshot(connections_count, idle_connections_count);
+}
+
+size_t ShardedConnectionPool::_current_shard_index()
+{
+	// Threads are numbered in order of the first request, so
+	// they are spread over shards evenly.
+	static std::atomic<size_t> threads_count = 0;
+	static thread_local size_t thread_number = threads_count++;
+	return thread_number % this->_shards_count;
+}
+
+ShardedConnectionPool::slot_ref ShardedConnectionPool::_take_free_slot(size_t shard_index)
+{
+	auto& shard = this->_shards[shard_index];
+	if (shard.cached.load(std::memory_order_relaxed))
+	{
+		if (auto ref = shard.cached.exchange(0))
+		{
+			return ref;
+		}
+	}
+
+	if (auto ref = this->_free_slots.pop(this->_slots.get()))
+	{
+		return ref;
+	}
+
+	// Connections which are cached by other shards are used
+	// before opening a new one.
+	for (size_t i = 1; i < this->_shards_count; i++)
+	{
+		auto& other_shard = this->_shards[(shard_index + i) % this->_shards_count];
+		if (other_shard.cached.load(std::memory_order_relaxed))
+		{
+			if (auto ref = other_shard.cached.exchange(0))
+			{
+				return ref;
+			}
+		}
+	}
+
+	return 0;
+}
+
+std::shared_ptr<IDatabaseConnection> ShardedConnectionPool::_acquire(
+	const std::optional<std::chrono::milliseconds>& timeout
+)
+{
+	auto requested_at = std::chrono::steady_clock::now();
+	auto shard_index = this->_current_shard_index();
+	slot_ref ref = this->_take_free_slot(shard_index);
+	bool is_empty = false;
+	if (!ref)
+	{
+		ref = this->_empty_slots.pop(this->_slots.get());
+		is_empty = ref != 0;
+	}
+
+	if (!ref)
+	{
+		// Waiter is registered before checking the pool again, so
+		// the connection released after the check wakes it up.
+		std::unique_lock<std::mutex> lock(this->_mutex);
+		this->_metrics->add_waiter();
+		std::optional<std::chrono::steady_clock::time_point> deadline;
+		if (timeout.has_value())
+		{
+			deadline = requested_at + timeout.value();
+		}
+
+		bool is_expired = false;
+		while (!(ref = this->_take_free_slot(shard_index)))
+		{
+			if ((ref = this->_empty_slots.pop(this->_slots.get())))
+			{
+				is_empty = true;
+				break;
+			}
+
+			if (is_expired)
+			{
+				break;
+			}
+
+			if (deadline.has_value())
+			{
+				is_expired = this->_condition.wait_until(lock, deadline.value()) == std::cv_status::timeout;
+			}
+			else
+			{
+				this->_condition.wait(lock);
+			}
+		}
+
+		this->_metrics->remove_waiter();
+	}
+
+	if (!ref)
+	{
+		this->_metrics->record_timeout(shard_index);
+		throw PoolTimeoutError(
+			"Timed out after " + std::to_string(timeout.value().count()) + " ms waiting for a free connection",
+			_ERROR_DETAILS_
+		);
+	}
+
+	return this->_provide(ref, is_empty, shard_index, requested_at);
+}
+
+std::shared_ptr<IDatabaseConnection> ShardedConnectionPool::_provide(
+	slot_ref ref, bool is_empty, size_t shard_index, std::chrono::steady_clock::time_point requested_at
+)
+{
+	auto& slot = this->_slot(ref);
+	auto connection = is_empty ? this->_open_connection(ref) : slot.connection;
+	auto acquired_at = std::chrono::steady_clock::now();
+	this->_metrics->record_acquire(shard_index, acquired_at - requested_at);
+	slot.acquired_at.store(acquired_at.time_since_epoch().count(), std::memory_order_relaxed);
+	slot.state.store(SlotState::Used);
+	return connection;
+}
+
+std::shared_ptr<IDatabaseConnection> ShardedConnectionPool::_open_connection(slot_ref ref)
+{
+	auto& slot = this->_slot(ref);
+	slot.state.store(SlotState::Used);
+	try
+	{
+		auto connection = this->_connection_builder();
+		auto* pointer = connection.get();
+		slot.connection = std::shared_ptr<IDatabaseConnection>(pointer, SlotDeleter{ref, std::move(connection)});
+		this->_metrics->record_creation(this->_current_shard_index(), true);
+		return slot.connection;
+	}
+	catch (...)
+	{
+		this->_metrics->record_creation(this->_current_shard_index(), false);
+		slot.state.store(SlotState::Empty);
+		this->_empty_slots.push(this->_slots.get(), ref);
+
+		// Other thread can be waiting for the slot.
+		this->_notify_waiters(false);
+		throw;
+	}
+}
+
+void ShardedConnectionPool::_notify_waiters(bool notify_all)
+{
+	if (this->_metrics->waiters_count() == 0)
+	{
+		return;
+	}
+
+	// Waiter checks the pool under the lock, so after taking it the
+	// waiter is either waiting already or has seen the change.
+	{
+		std::lock_guard<std::mutex> lock(this->_mutex);
+	}
+
+	if (notify_all)
+	{
+		this->_condition.notify_all();
+	}
+	else
+	{
+		this->_condition.notify_one();
+	}
+}
+
+__ORM_END__
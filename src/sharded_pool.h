@@ -0,0 +1,185 @@
+/**
+ * sharded_pool.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Connection pool with low contention between threads.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <chrono>
+#include <optional>
+
+// Module definitions.
+#include "./_def_.h"
+
+// Orm libraries.
+#include "./pool.h"
+
+
+__ORM_BEGIN__
+
+// Pool which does not take the shared lock while there are free
+// connections. Each thread is assigned to a shard which caches
+// one recently released connection, the rest free connections are
+// kept in a lock-free stack. The mutex is taken only by threads
+// which wait for a connection because the pool is exhausted.
+//
+// Idle connections are evicted only by 'evict_idle_connections',
+// so it should be called periodically if 'idle_timeout' is set.
+class ShardedConnectionPool final : public IConnectionPool
+{
+public:
+	ShardedConnectionPool(const PoolOptions& options, ConnectionBuilder builder);
+
+	void create() override;
+
+	std::shared_ptr<IDatabaseConnection> acquire() override;
+
+	std::shared_ptr<IDatabaseConnection> acquire(std::chrono::milliseconds timeout) override;
+
+	std::shared_ptr<IDatabaseConnection> try_acquire() override;
+
+	// Throws 'ValueError' if the connection was not provided
+	// by this pool.
+	void release(const std::shared_ptr<IDatabaseConnection>& connection) override;
+
+	// Takes free connections out of the pool, closes expired ones
+	// and returns the rest back. Acquirers which find the pool empty
+	// meanwhile wait until the rest are returned.
+	void evict_idle_connections() override;
+
+	[[nodiscard]]
+	size_t connections_count() override;
+
+	[[nodiscard]]
+	size_t idle_connections_count() override;
+
+	// Counters are recorded to the shard of the current thread,
+	// so collecting of metrics does not add contention.
+	[[nodiscard]]
+	PoolMetrics metrics() override;
+
+private:
+	// One-based index of the slot, zero means no slot.
+	using slot_ref = uint32_t;
+
+	enum SlotState : uint8_t
+	{
+		Empty, Used, Idle
+	};
+
+	struct Slot
+	{
+		// Connection which is provided to users. It owns the
+		// connection through 'SlotDeleter'.
+		std::shared_ptr<IDatabaseConnection> connection;
+
+		std::atomic<SlotState> state = SlotState::Empty;
+
+		// Next slot in the stack which contains this one.
+		std::atomic<slot_ref> next = 0;
+
+		std::atomic<std::chrono::steady_clock::rep> released_at = 0;
+
+		std::atomic<std::chrono::steady_clock::rep> acquired_at = 0;
+	};
+
+	// Keeps the reference to the slot inside of the provided
+	// connection, so it is found on release without search.
+	struct SlotDeleter
+	{
+		slot_ref ref;
+
+		std::shared_ptr<IDatabaseConnection> connection;
+
+		// Connection is closed when the deleter is destroyed.
+		inline void operator()(IDatabaseConnection*) const
+		{
+		}
+	};
+
+	// Lock-free stack of slots. The high half of the head counts
+	// modifications, so the slot which was popped and pushed back
+	// by other threads does not break the comparison (ABA problem).
+	class SlotStack
+	{
+	public:
+		void push(Slot* slots, slot_ref ref);
+
+		slot_ref pop(Slot* slots);
+
+	private:
+		std::atomic<uint64_t> head = 0;
+	};
+
+	// Aligned to the cache line, so threads of different
+	// shards do not invalidate the cache of each other.
+	struct alignas(64) Shard
+	{
+		std::atomic<slot_ref> cached = 0;
+	};
+
+	const PoolOptions _options;
+	ConnectionBuilder _connection_builder;
+
+	std::unique_ptr<Slot[]> _slots;
+
+	std::unique_ptr<Shard[]> _shards;
+	size_t _shards_count;
+
+	// Slots with free connections.
+	SlotStack _free_slots;
+
+	// Slots without connections.
+	SlotStack _empty_slots;
+
+	// Used only by threads which wait for a connection and by
+	// the eviction pass.
+	std::mutex _mutex;
+	std::condition_variable _condition;
+
+	// Odd while the eviction pass holds free connections, so
+	// 'try_acquire' knows that the pool only looks empty.
+	std::atomic<size_t> _eviction_sequence = 0;
+
+	// Has the same shards as the pool. Counts waiters too.
+	std::unique_ptr<PoolMetricsCollector> _metrics;
+
+	inline Slot& _slot(slot_ref ref)
+	{
+		return this->_slots[ref - 1];
+	}
+
+	// Returns the index of the shard of the current thread.
+	size_t _current_shard_index();
+
+	// Takes a free connection from the shard of the current thread,
+	// from the stack or from other shards. Returns zero if there
+	// are no free connections.
+	slot_ref _take_free_slot(size_t shard_index);
+
+	std::shared_ptr<IDatabaseConnection> _acquire(const std::optional<std::chrono::milliseconds>& timeout);
+
+	// Marks the slot as used and returns its connection, opening it
+	// if the slot is empty.
+	std::shared_ptr<IDatabaseConnection> _provide(
+		slot_ref ref, bool is_empty, size_t shard_index, std::chrono::steady_clock::time_point requested_at
+	);
+
+	// Opens a connection in the empty slot. The slot is returned to
+	// the empty ones if opening fails.
+	std::shared_ptr<IDatabaseConnection> _open_connection(slot_ref ref);
+
+	// Wakes threads which wait for a connection if there are any.
+	void _notify_waiters(bool notify_all);
+};
+
+__ORM_END__
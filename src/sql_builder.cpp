@@ -9,6 +9,22 @@
 
 __ORM_BEGIN__
 
+void DefaultSQLBuilder::append_condition(
+	std::string& sql, const q::Condition& condition, std::vector<db::Parameter>* parameters
+) const
+{
+	if (!parameters)
+	{
+		condition.append_to(sql);
+	}
+	else
+	{
+		condition.append_sql_to(
+			sql, [this](size_t index) -> auto { return this->sql_placeholder(index); }, *parameters
+		);
+	}
+}
+
 std::string DefaultSQLBuilder::sql_insert(
 	const std::string& table_name, const std::string& columns, const std::list<std::string>& rows
 ) const
@@ -23,13 +39,34 @@ std::string DefaultSQLBuilder::sql_insert(
 		this->_throw_empty_arg("columns", _ERROR_DETAILS_);
 	}
 
-	auto values = str::join("), (", rows.begin(), rows.end());
-	if (values.empty())
+	if (rows.empty() || (rows.size() == 1 && rows.front().empty()))
 	{
 		this->_throw_empty_arg("rows", _ERROR_DETAILS_);
 	}
 
-	return "INSERT INTO " + util::quote_str(table_name) + " (" + columns + ") VALUES (" + values + ");";
+	size_t size = 32 + table_name.size() + columns.size();
+	for (const auto& row : rows)
+	{
+		size += row.size() + 4;
+	}
+
+	std::string query;
+	query.reserve(size);
+	query.append("INSERT INTO ");
+	util::append_quoted(query, table_name);
+	query.append(" (").append(columns).append(") VALUES (");
+	for (auto row = rows.begin(); row != rows.end(); row++)
+	{
+		if (row != rows.begin())
+		{
+			query.append("), (");
+		}
+
+		query.append(*row);
+	}
+
+	query.append(");");
+	return query;
 }
 
 std::string DefaultSQLBuilder::sql_select_(
@@ -42,7 +79,8 @@ std::string DefaultSQLBuilder::sql_select_(
 	long int limit,
 	long int offset,
 	const std::list<std::string>& group_by_cols,
-	const q::Condition& having_cond
+	const q::Condition& having_cond,
+	std::vector<db::Parameter>* parameters
 ) const
 {
 	if (table_name.empty())
@@ -55,75 +93,105 @@ std::string DefaultSQLBuilder::sql_select_(
 		this->_throw_empty_arg("columns", _ERROR_DETAILS_);
 	}
 
-	auto query = std::string("SELECT") + (distinct ? " DISTINCT" : "") + " " + columns +
-		" FROM " + util::quote_str(table_name);
+	if (offset > 0 && limit < 0)
+	{
+		throw QueryError("xw::orm::DefaultSQLBuilder: 'offset' is used without 'limit'", _ERROR_DETAILS_);
+	}
+
+	if (!having_cond.empty() && group_by_cols.empty())
+	{
+		throw QueryError("xw::orm::DefaultSQLBuilder: 'having' is used without 'group by'", _ERROR_DETAILS_);
+	}
 
+	// The statement is written to the single buffer, so it is
+	// reserved for all parts at once.
+	size_t size = 64 + columns.size() + table_name.size() + where_cond.size_hint() + having_cond.size_hint();
 	for (const auto& join_row : joins)
 	{
-		query += " " + (std::string)join_row;
+		size += join_row.type.size() + join_row.table_name.size() + join_row.condition.size_hint() + 16;
 	}
 
-	auto where_str = (std::string)where_cond;
-	if (!where_str.empty())
+	for (const auto& ordering : order_by_cols)
 	{
-		query += " WHERE " + where_str;
+		size += ordering.size_hint() + 6;
+	}
+
+	for (const auto& gb_col : group_by_cols)
+	{
+		size += table_name.size() + gb_col.size() + 8;
+	}
+
+	std::string query;
+	query.reserve(size);
+	query.append(distinct ? "SELECT DISTINCT " : "SELECT ").append(columns).append(" FROM ");
+	util::append_quoted(query, table_name);
+	for (const auto& join_row : joins)
+	{
+		query.append(1, ' ').append(join_row.type).append(" JOIN \"").append(join_row.table_name).append("\" ON ");
+		this->append_condition(query, join_row.condition, parameters);
+	}
+
+	if (!where_cond.empty())
+	{
+		query.append(" WHERE ");
+		this->append_condition(query, where_cond, parameters);
 	}
 
 	if (!order_by_cols.empty())
 	{
-		query += " ORDER BY " + str::join(
-			", ", order_by_cols.begin(), order_by_cols.end(),
-			[](const auto& ob_column) -> auto
+		query.append(" ORDER BY ");
+		for (auto ordering = order_by_cols.begin(); ordering != order_by_cols.end(); ordering++)
+		{
+			if (ordering != order_by_cols.begin())
 			{
-				return (std::string)ob_column;
+				query.append(", ");
 			}
-		);
+
+			ordering->append_to(query);
+		}
 	}
 
 	if (limit > -1)
 	{
-		query += " LIMIT " + std::to_string(limit);
+		query.append(" LIMIT ").append(std::to_string(limit));
 	}
 
 	if (offset > 0)
 	{
-		if (limit < 0)
-		{
-			throw QueryError("xw::orm::DefaultSQLBuilder: 'offset' is used without 'limit'", _ERROR_DETAILS_);
-		}
-
-		query += " OFFSET " + std::to_string(offset);
+		query.append(" OFFSET ").append(std::to_string(offset));
 	}
 
 	if (!group_by_cols.empty())
 	{
-		auto prefix = util::quote_str(table_name) + ".";
-		query += " GROUP BY " + str::join(
-			", ", group_by_cols.begin(), group_by_cols.end(),
-			[prefix](const auto& gb_col) -> auto
+		query.append(" GROUP BY ");
+		for (auto gb_col = group_by_cols.begin(); gb_col != group_by_cols.end(); gb_col++)
+		{
+			if (gb_col != group_by_cols.begin())
 			{
-				if (gb_col.find('.') == std::string::npos)
-				{
-					return prefix + util::quote_str(gb_col);
-				}
+				query.append(", ");
+			}
 
-				return gb_col;
+			if (gb_col->find('.') == std::string::npos)
+			{
+				util::append_quoted(query, table_name);
+				query.append(1, '.');
+				util::append_quoted(query, *gb_col);
 			}
-		);
+			else
+			{
+				query.append(*gb_col);
+			}
+		}
 	}
 
-	auto having_str = (std::string)having_cond;
-	if (!having_str.empty())
+	if (!having_cond.empty())
 	{
-		if (group_by_cols.empty())
-		{
-			throw QueryError("xw::orm::DefaultSQLBuilder: 'having' is used without 'group by'", _ERROR_DETAILS_);
-		}
-
-		query += " HAVING " + having_str;
+		query.append(" HAVING ");
+		this->append_condition(query, having_cond, parameters);
 	}
 
-	return query + ";";
+	query.append(1, ';');
+	return query;
 }
 
 std::string DefaultSQLBuilder::sql_select(
@@ -136,30 +204,19 @@ std::string DefaultSQLBuilder::sql_select(
 	long int limit,
 	long int offset,
 	const std::list<std::string>& group_by_cols,
-	const q::Condition& having_cond
+	const q::Condition& having_cond,
+	std::vector<db::Parameter>* parameters
 ) const
 {
-	auto raw_prefix = table_name + ".";
-	auto prefix = util::quote_str(table_name) + ".";
-	std::string columns_str;
-	for (auto column = columns.begin(); column != columns.end(); column++)
-	{
-		auto column_str = std::string(*column);
-		columns_str += prefix + util::quote_str(column_str);
-		columns_str += " AS " + util::quote_str(column_str);
-		if (std::next(column) != columns.end())
-		{
-			columns_str += ", ";
-		}
-	}
-
 	return this->sql_select_(
-		table_name, columns_str, distinct, joins, where_cond, order_by_cols, limit, offset, group_by_cols, having_cond
+		table_name, this->sql_select_columns(table_name, columns), distinct, joins, where_cond,
+		order_by_cols, limit, offset, group_by_cols, having_cond, parameters
 	);
 }
 
 std::string DefaultSQLBuilder::sql_update(
-	const std::string& table_name, const std::string& columns_data, const q::Condition& condition
+	const std::string& table_name, const std::string& columns_data, const q::Condition& condition,
+	std::vector<db::Parameter>* parameters
 ) const
 {
 	if (table_name.empty())
@@ -172,31 +229,42 @@ std::string DefaultSQLBuilder::sql_update(
 		this->_throw_empty_arg("columns_data", _ERROR_DETAILS_);
 	}
 
-	std::string query = "UPDATE " + util::quote_str(table_name) + " SET " + columns_data;
-	auto cond_str = (std::string)condition;
-	if (!cond_str.empty())
+	std::string query;
+	query.reserve(32 + table_name.size() + columns_data.size() + condition.size_hint());
+	query.append("UPDATE ");
+	util::append_quoted(query, table_name);
+	query.append(" SET ").append(columns_data);
+	if (!condition.empty())
 	{
-		query += " WHERE " + cond_str;
+		query.append(" WHERE ");
+		this->append_condition(query, condition, parameters);
 	}
 
-	return query + ";";
+	query.append(1, ';');
+	return query;
 }
 
-std::string DefaultSQLBuilder::sql_delete(const std::string& table_name, const q::Condition& where_cond) const
+std::string DefaultSQLBuilder::sql_delete(
+	const std::string& table_name, const q::Condition& where_cond, std::vector<db::Parameter>* parameters
+) const
 {
 	if (table_name.empty())
 	{
 		this->_throw_empty_arg("table_name", _ERROR_DETAILS_);
 	}
 
-	std::string query = "DELETE FROM " + util::quote_str(table_name);
-	auto where_str = (std::string)where_cond;
-	if (!where_str.empty())
+	std::string query;
+	query.reserve(32 + table_name.size() + where_cond.size_hint());
+	query.append("DELETE FROM ");
+	util::append_quoted(query, table_name);
+	if (!where_cond.empty())
 	{
-		query += " WHERE " + where_str;
+		query.append(" WHERE ");
+		this->append_condition(query, where_cond, parameters);
 	}
 
-	return query + ";";
+	query.append(1, ';');
+	return query;
 }
 
 __ORM_END__
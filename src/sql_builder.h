@@ -31,6 +31,23 @@ private:
 		throw QueryError("xw::orm::DefaultSQLBuilder: '" + arg + "' is required", line, function, file);
 	}
 
+protected:
+
+	// Writes the condition to the end of 'sql' with placeholders if
+	// 'parameters' is not nullptr, otherwise with inlined values.
+	void append_condition(
+		std::string& sql, const q::Condition& condition, std::vector<db::Parameter>* parameters
+	) const;
+
+public:
+
+	// Returns '?' placeholder for each index.
+	[[nodiscard]]
+	inline std::string sql_placeholder(size_t /* index */) const override
+	{
+		return "?";
+	}
+
 public:
 
 	// Generates 'INSERT' query as string.
@@ -60,7 +77,8 @@ public:
 		long int limit,
 		long int offset,
 		const std::list<std::string>& group_by_cols,
-		const q::Condition& having_cond
+		const q::Condition& having_cond,
+		std::vector<db::Parameter>* parameters=nullptr
 	) const override;
 
 	// Generates 'SELECT' query as string.
@@ -78,7 +96,8 @@ public:
 		long int limit,
 		long int offset,
 		const std::list<std::string>& group_by_cols,
-		const q::Condition& having_cond
+		const q::Condition& having_cond,
+		std::vector<db::Parameter>* parameters=nullptr
 	) const override;
 
 	// Generates 'UPDATE' query as string.
@@ -88,14 +107,17 @@ public:
 	// example: "column1 = data1, column2 = data2, ..."
 	[[nodiscard]]
 	std::string sql_update(
-		const std::string& table_name, const std::string& columns_data, const q::Condition& condition
+		const std::string& table_name, const std::string& columns_data, const q::Condition& condition,
+		std::vector<db::Parameter>* parameters=nullptr
 	) const override;
 
 	// Generates 'DELETE' query as string.
 	//
 	// 'table_name' must be non-empty string.
 	[[nodiscard]]
-	std::string sql_delete(const std::string& table_name, const q::Condition& where_cond) const override;
+	std::string sql_delete(
+		const std::string& table_name, const q::Condition& where_cond, std::vector<db::Parameter>* parameters=nullptr
+	) const override;
 };
 
 __ORM_END__
@@ -10,6 +10,8 @@
 
 // C++ libraries.
 #include <memory>
+#include <string>
+#include <vector>
 
 // Base libraries.
 #include <xalwart.base/interfaces/orm.h>
@@ -21,13 +23,78 @@
 
 __ORM_SQLITE3_BEGIN__
 
-Backend::Backend(size_t pool_size, const char* filename) : DefaultSQLBackend(
-	pool_size, [filename]() -> std::shared_ptr<IDatabaseConnection>
+// Pool of the single connection which is opened by 'create_pool'.
+static PoolOptions make_writer_pool_options(const PoolOptions& pool_options)
+{
+	auto writer_options = PoolOptions(1);
+	writer_options.acquire_timeout = pool_options.acquire_timeout;
+	return writer_options;
+}
+
+Backend::Backend(
+	const PoolOptions& pool_options, const char* filename, size_t statements_cache_size, bool is_wal
+) : DefaultSQLBackend(
+	is_wal ? make_writer_pool_options(pool_options) : pool_options,
+
+	// Connections can be opened at any time later, so the
+	// file name is copied instead of referring to the caller's
+	// buffer.
+	[filename = std::string(filename), statements_cache_size, is_wal]() -> std::shared_ptr<IDatabaseConnection>
 	{
-		return std::make_shared<SQLite3Connection>(filename);
+		if (!is_wal)
+		{
+			return std::make_shared<SQLite3Connection>(filename.c_str(), statements_cache_size);
+		}
+
+		// The pool never shares a connection between threads at the
+		// same time, so the mutex of the connection is not needed.
+		auto connection = std::make_shared<SQLite3Connection>(
+			filename.c_str(), statements_cache_size, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX
+		);
+
+		// The mode is stored in the database file, so readers which
+		// are opened later use it too.
+		std::string journal_mode;
+		connection->run_query("PRAGMA journal_mode=WAL;", nullptr, [&journal_mode](const std::vector<char*>& data)
+		{
+			journal_mode = data[0] ? data[0] : "";
+		});
+		if (journal_mode != "wal")
+		{
+			throw DatabaseError(
+				"unable to switch sqlite3 database to WAL mode, journal mode is '" + journal_mode + "'",
+				_ERROR_DETAILS_
+			);
+		}
+
+		return connection;
 	}
-)
+), _is_wal(is_wal)
+{
+	if (is_wal)
+	{
+		this->set_read_pool(
+			pool_options,
+			[filename = std::string(filename), statements_cache_size]() -> std::shared_ptr<IDatabaseConnection>
+			{
+				return std::make_shared<SQLite3Connection>(
+					filename.c_str(), statements_cache_size, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX
+				);
+			}
+		);
+	}
+}
+
+void Backend::use_profile(const Profile& profile)
 {
+	this->add_connection_initializer([profile, is_wal = this->_is_wal](IDatabaseConnection& connection) -> void
+	{
+		auto& sqlite3_connection = dynamic_cast<SQLite3Connection&>(connection);
+		for (const auto& pragma : profile.pragmas(is_wal || sqlite3_connection.is_read_only()))
+		{
+			sqlite3_connection.run_query(pragma, nullptr, nullptr);
+		}
+	});
 }
 
 db::ISchemaEditor* Backend::schema_editor() const
@@ -46,7 +113,7 @@ std::vector<std::string> Backend::get_table_names(const IDatabaseConnection* con
 	std::shared_ptr<IDatabaseConnection> local_connection = nullptr;
 	if (!connection)
 	{
-		local_connection = this->get_connection();
+		local_connection = this->get_read_connection();
 		if (!local_connection)
 		{
 			throw DatabaseError("Received nullptr connection", _ERROR_DETAILS_);
@@ -62,7 +129,7 @@ std::vector<std::string> Backend::get_table_names(const IDatabaseConnection* con
 	});
 	if (local_connection)
 	{
-		this->release_connection(local_connection);
+		this->release_read_connection(local_connection);
 	}
 
 	return tables;
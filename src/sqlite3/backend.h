@@ -19,6 +19,7 @@
 
 // Orm libraries.
 #include "../backend.h"
+#include "./profile.h"
 
 
 __ORM_SQLITE3_BEGIN__
@@ -27,7 +28,19 @@ __ORM_SQLITE3_BEGIN__
 class Backend : public DefaultSQLBackend
 {
 public:
-	explicit Backend(size_t pool_size, const char* filename);
+	// 'statements_cache_size' is passed to each connection,
+	// check 'SQLite3Connection' for details.
+	//
+	// If 'is_wal' is true, the database is switched to write-ahead
+	// logging, so readers do not wait for the writer. All changes go
+	// through a single writer connection, which does not collide with
+	// others on the database lock, and 'pool_options' describe the
+	// pool of read-only connections which are provided by
+	// 'get_read_connection'. 'acquire_timeout' applies to both.
+	explicit Backend(
+		const PoolOptions& pool_options, const char* filename,
+		size_t statements_cache_size=32, bool is_wal=false
+	);
 
 	[[nodiscard]]
 	inline std::string dbms_name() const override
@@ -35,6 +48,11 @@ public:
 		return "sqlite";
 	}
 
+	// Applies PRAGMA statements of 'profile' to each connection which
+	// is opened later, so it should be called before 'create_pool'.
+	// In WAL mode the journal mode of 'profile' is ignored.
+	void use_profile(const Profile& profile);
+
 	// Instantiates SQLite3 schema editor if it was not
 	// done yet and returns it.
 	[[nodiscard]]
@@ -42,6 +60,9 @@ public:
 
 	[[nodiscard]]
 	std::vector<std::string> get_table_names(const IDatabaseConnection* connection) override;
+
+private:
+	bool _is_wal;
 };
 
 __ORM_SQLITE3_END__
@@ -8,6 +8,9 @@
 
 #ifdef USE_SQLITE3
 
+// C++ libraries.
+#include <optional>
+
 // Base libraries.
 #include <xalwart.base/exceptions.h>
 #include <xalwart.base/path.h>
@@ -29,13 +32,26 @@ void YAMLSQLite3Component::initialize(const YAML::Node& node) const
 		);
 	}
 
-	if (this->pool_size < 1)
+	if (this->statements_cache_size < 0)
 	{
 		throw ImproperlyConfigured(
-			"'connections' should be positive integer", _ERROR_DETAILS_
+			"'statements_cache' should be non-negative integer", _ERROR_DETAILS_
 		);
 	}
 
+	std::optional<Profile> profile;
+	if (!this->profile.empty())
+	{
+		try
+		{
+			profile = Profile::from_name(this->profile);
+		}
+		catch (const ValueError& exc)
+		{
+			throw ImproperlyConfigured(exc.what(), _ERROR_DETAILS_);
+		}
+	}
+
 	auto full_filepath = path::Path(this->filename);
 	if (!path::Path(full_filepath).is_absolute())
 	{
@@ -43,8 +59,16 @@ void YAMLSQLite3Component::initialize(const YAML::Node& node) const
 	}
 
 	auto string_filename = full_filepath.to_string();
-	this->backend = std::make_shared<sqlite3::Backend>(this->pool_size, string_filename.c_str());
-	this->backend->create_pool();
+	auto sqlite3_backend = std::make_shared<sqlite3::Backend>(
+		this->pool_options, string_filename.c_str(), this->statements_cache_size, this->is_wal
+	);
+	if (profile.has_value())
+	{
+		sqlite3_backend->use_profile(profile.value());
+	}
+
+	sqlite3_backend->create_pool();
+	this->backend = sqlite3_backend;
 }
 
 __ORM_SQLITE3_END__
@@ -23,11 +23,19 @@
 // Module definitions.
 #include "../_def_.h"
 
+// Orm libraries.
+#include "../../config/yaml.h"
+
 
 __ORM_SQLITE3_BEGIN__
 
 // TESTME: YAMLSQLite3Component
 // TODO: docs for 'YAMLSQLite3Component'
+//
+// With 'wal: true' the database is opened in WAL mode with a single
+// writer connection, and 'connections' describe the pool of readers,
+// check 'sqlite3::Backend' for details. 'profile' selects PRAGMA
+// statements for connections, check 'sqlite3::Profile::from_name'.
 class YAMLSQLite3Component : public xw::config::YAMLMapComponent
 {
 public:
@@ -36,7 +44,14 @@ public:
 	) : base_directory(std::move(base_directory)), backend(backend)
 	{
 		this->register_component("file", std::make_unique<xw::config::YAMLScalarComponent>(this->filename));
-		this->register_component("connections", std::make_unique<xw::config::YAMLScalarComponent>(this->pool_size));
+		this->register_component(
+			"connections", std::make_unique<orm::config::YAMLPoolComponent>(this->pool_options)
+		);
+		this->register_component(
+			"statements_cache", std::make_unique<xw::config::YAMLScalarComponent>(this->statements_cache_size)
+		);
+		this->register_component("wal", std::make_unique<xw::config::YAMLScalarComponent>(this->is_wal));
+		this->register_component("profile", std::make_unique<xw::config::YAMLScalarComponent>(this->profile));
 	}
 
 	void initialize(const YAML::Node& node) const override;
@@ -46,7 +61,18 @@ protected:
 	std::shared_ptr<IBackend>& backend;
 
 	std::string filename;
-	long pool_size = 3;
+	// Check 'YAMLPoolComponent' for details.
+	PoolOptions pool_options = PoolOptions(3);
+
+	// Maximum number of prepared statements cached by each
+	// connection, zero disables caching.
+	long statements_cache_size = 32;
+
+	// Single writer and multiple read-only connections.
+	bool is_wal = false;
+
+	// Name of the profile, empty keeps defaults of SQLite.
+	std::string profile;
 };
 
 __ORM_SQLITE3_END__
@@ -8,10 +8,117 @@
 
 #ifdef USE_SQLITE3
 
+// C++ libraries.
+#include <cstring>
+
 
 __ORM_SQLITE3_BEGIN__
 
-SQLite3Connection::SQLite3Connection(const char* filename) : in_transaction(false)
+class SQLite3Connection::Cursor final : public ISQLCursor
+{
+public:
+	inline Cursor(
+		const SQLite3Connection* connection, std::string query, std::vector<db::Parameter> parameters
+	) : connection(connection), query(std::move(query)), parameters(std::move(parameters)), row(columns, nullptr)
+	{
+		this->statement = connection->prepare_single_statement(this->query);
+		try
+		{
+			size_t offset = 0;
+			connection->bind_parameters(this->statement, this->parameters, offset);
+			if (offset != this->parameters.size())
+			{
+				throw QueryError(
+					"Query has fewer placeholders than passed parameters: " +
+						std::to_string(this->parameters.size()),
+					_ERROR_DETAILS_
+				);
+			}
+		}
+		catch (const std::exception& exc)
+		{
+			this->release();
+			throw;
+		}
+	}
+
+	inline ~Cursor() override
+	{
+		this->release();
+	}
+
+	const db::Row* next() override
+	{
+		if (!this->statement)
+		{
+			return nullptr;
+		}
+
+		auto result = sqlite3_step(this->statement);
+		if (result == SQLITE_ROW)
+		{
+			if (!this->has_columns)
+			{
+				this->columns = columns_of(this->statement);
+				this->has_columns = true;
+			}
+
+			read_values(this->statement, this->values);
+			this->row = db::Row(this->columns, this->values.data());
+			return &this->row;
+		}
+
+		if (result != SQLITE_DONE)
+		{
+			auto message = std::string(sqlite3_errmsg(this->connection->db));
+			this->release();
+			this->connection->rollback_transaction();
+			throw SQLError(message, _ERROR_DETAILS_);
+		}
+
+		this->release();
+		return nullptr;
+	}
+
+private:
+	const SQLite3Connection* connection;
+	std::string query;
+	std::vector<db::Parameter> parameters;
+	::sqlite3_stmt* statement = nullptr;
+	bool has_columns = false;
+	db::Columns columns;
+	std::vector<db::Value> values;
+	db::Row row;
+
+	// Returns the statement to the cache, so the next cursor or
+	// query with the same SQL reuses it.
+	inline void release()
+	{
+		if (!this->statement)
+		{
+			return;
+		}
+
+		if (this->connection->statements.capacity())
+		{
+			sqlite3_reset(this->statement);
+			sqlite3_clear_bindings(this->statement);
+			this->connection->statements.put(this->query, this->statement);
+		}
+		else
+		{
+			sqlite3_finalize(this->statement);
+		}
+
+		this->statement = nullptr;
+	}
+};
+
+SQLite3Connection::SQLite3Connection(const char* filename, size_t statements_cache_size, int flags) :
+	in_transaction(false), statements(statements_cache_size, [](const std::string&, ::sqlite3_stmt*& statement)
+	{
+		sqlite3_finalize(statement);
+	})
 {
 	if (!filename)
 	{
@@ -19,13 +126,11 @@ SQLite3Connection::SQLite3Connection(const char* filename) : in_transaction(fals
 	}
 
 	::sqlite3* driver;
-	if (sqlite3_open_v2(filename, &driver, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr))
-//	if (sqlite3_open(filename, &driver))
+	if (sqlite3_open_v2(filename, &driver, flags, nullptr))
 	{
-		throw DatabaseError(
-			"error while opening sqlite3 database: " + std::string(sqlite3_errmsg(driver)),
-			_ERROR_DETAILS_
-		);
+		auto message = std::string(sqlite3_errmsg(driver));
+		sqlite3_close(driver);
+		throw DatabaseError("error while opening sqlite3 database: " + message, _ERROR_DETAILS_);
 	}
 
 	this->db = driver;
@@ -33,13 +138,15 @@ SQLite3Connection::SQLite3Connection(const char* filename) : in_transaction(fals
 
 SQLite3Connection::~SQLite3Connection()
 {
-	if (!this->db)
+	if (this->db)
 	{
 		if (this->in_transaction)
 		{
 			this->rollback_transaction();
 		}
 
+		// All statements must be finalized before closing the database.
+		this->statements.clear();
 		sqlite3_close(this->db);
 	}
 }
@@ -52,7 +159,7 @@ void SQLite3Connection::run_query(
 {
 	try
 	{
-		this->run_query_unsafe(sql_query, row_handler, vector_handler);
+		this->run_query_unsafe(sql_query, make_row_reader(row_handler, vector_handler));
 	}
 	catch (const std::exception& exc)
 	{
@@ -63,17 +170,115 @@ void SQLite3Connection::run_query(
 
 void SQLite3Connection::run_query(const std::string& sql_query, std::string& last_row_id) const
 {
-	auto extended_query = "BEGIN TRANSACTION; " + sql_query + " SELECT last_insert_rowid(); COMMIT TRANSACTION;";
-	this->run_query(extended_query, nullptr, [&last_row_id](const std::vector<char*>& values)
+	this->run_query(sql_query, nullptr, nullptr);
+	last_row_id = std::to_string(sqlite3_last_insert_rowid(this->db));
+}
+
+void SQLite3Connection::run_query(
+	const std::string& sql_query,
+	const std::vector<db::Parameter>& parameters,
+	const std::function<void(const std::map<std::string, char*>& /* columns */)>& map_handler,
+	const std::function<void(const std::vector<char*>& /* columns */)>& vector_handler
+) const
+{
+	try
 	{
-		last_row_id = values.front();
-	});
+		this->run_query_unsafe(sql_query, make_row_reader(map_handler, vector_handler), parameters);
+	}
+	catch (const std::exception& exc)
+	{
+		this->rollback_transaction();
+		throw;
+	}
+}
+
+void SQLite3Connection::run_query(
+	const std::string& sql_query, const std::vector<db::Parameter>& parameters, std::string& last_row_id
+) const
+{
+	this->run_query(sql_query, parameters, nullptr, nullptr);
+	last_row_id = std::to_string(sqlite3_last_insert_rowid(this->db));
+}
+
+void SQLite3Connection::run_typed_query(
+	const std::string& sql_query,
+	const std::vector<db::Parameter>& parameters,
+	const db::RowHandler& row_handler,
+	[[maybe_unused]] bool is_streamed
+) const
+{
+	db::Columns columns;
+	std::vector<db::Value> values;
+	try
+	{
+		this->run_query_unsafe(sql_query, [&](::sqlite3_stmt* statement, bool is_first_row) -> bool
+		{
+			if (!row_handler)
+			{
+				return true;
+			}
+
+			if (is_first_row)
+			{
+				columns = columns_of(statement);
+			}
+
+			read_values(statement, values);
+			return row_handler(db::Row(columns, values.data()));
+		}, parameters);
+	}
+	catch (const std::exception& exc)
+	{
+		this->rollback_transaction();
+		throw;
+	}
+}
+
+std::unique_ptr<ISQLCursor> SQLite3Connection::open_cursor(
+	const std::string& sql_query, const std::vector<db::Parameter>& parameters
+) const
+{
+	try
+	{
+		return std::make_unique<Cursor>(this, sql_query, parameters);
+	}
+	catch (const std::exception& exc)
+	{
+		this->rollback_transaction();
+		throw;
+	}
+}
+
+std::vector<size_t> SQLite3Connection::run_batch(const std::vector<db::Statement>& statements) const
+{
+	std::vector<size_t> affected_rows;
+	affected_rows.reserve(statements.size());
+	auto is_own_transaction = !this->in_transaction;
+	try
+	{
+		this->begin_transaction();
+		for (const auto& statement : statements)
+		{
+			this->run_query_unsafe(statement.sql, nullptr, statement.parameters);
+			affected_rows.push_back(sqlite3_changes(this->db));
+		}
+
+		if (is_own_transaction)
+		{
+			this->end_transaction();
+		}
+	}
+	catch (const std::exception& exc)
+	{
+		this->rollback_transaction();
+		throw;
+	}
+
+	return affected_rows;
 }
 
 void SQLite3Connection::run_query_unsafe(
-	const std::string& query,
-	std::function<void(const std::map<std::string, char*>&)> map_handler,
-	std::function<void(const std::vector<char*>&)> vector_handler
+	const std::string& query, const row_reader& reader, const std::vector<db::Parameter>& parameters
 ) const
 {
 	if (query.empty())
@@ -81,63 +286,282 @@ void SQLite3Connection::run_query_unsafe(
 		this->throw_empty_arg("query", _ERROR_DETAILS_);
 	}
 
-	char* message_error;
-	int ret_val = SQLITE_OK;
-	if (map_handler)
+	auto cached_statement = this->statements.take(query);
+	if (cached_statement.has_value())
 	{
-		using function_type = std::function<void(const std::map<std::string, char*>&)>;
-		ret_val = sqlite3_exec(
-			this->db,
-			query.c_str(),
-			[](void* data, int argc, char** argv, char** column_names) -> int {
-				auto& handler = *(function_type*)data;
-				std::map<std::string, char*> map;
-				for (int i = 0; i < argc; i++)
-				{
-					// TODO: check what if column value is nullptr!
-					map[column_names[i]] = argv[i];
-				}
-
-				handler(map);
-				return 0;
-			},
-			&map_handler,
-			&message_error
+		this->cache_hits++;
+		auto* statement = cached_statement.value();
+		try
+		{
+			size_t offset = 0;
+			this->bind_parameters(statement, parameters, offset);
+			if (offset != parameters.size())
+			{
+				throw QueryError(
+					"Query has fewer placeholders than passed parameters: " + std::to_string(parameters.size()),
+					_ERROR_DETAILS_
+				);
+			}
+
+			this->execute_statement(statement, reader);
+		}
+		catch (const std::exception& exc)
+		{
+			sqlite3_reset(statement);
+			sqlite3_clear_bindings(statement);
+			this->statements.put(query, statement);
+			throw;
+		}
+
+		sqlite3_reset(statement);
+		sqlite3_clear_bindings(statement);
+		this->statements.put(query, statement);
+		return;
+	}
+
+	this->cache_misses++;
+
+	// The query can contain several statements, only a single
+	// statement query is cached. Only the first statement can be
+	// cached, so the rest are not prepared as persistent ones.
+	const char* tail = query.c_str();
+	bool is_first = true;
+	size_t offset = 0;
+	while (*tail)
+	{
+		::sqlite3_stmt* statement = nullptr;
+		auto flags = is_first && this->statements.capacity() ? SQLITE_PREPARE_PERSISTENT : 0;
+		if (sqlite3_prepare_v3(this->db, tail, -1, flags, &statement, &tail) != SQLITE_OK)
+		{
+			this->throw_sql_error(_ERROR_DETAILS_);
+		}
+
+		if (!statement)
+		{
+			// Whitespace or comment.
+			continue;
+		}
+
+		bool is_cacheable = is_first && std::strspn(tail, " \t\r\n") == std::strlen(tail);
+		is_first = false;
+		bool is_completed;
+		try
+		{
+			this->bind_parameters(statement, parameters, offset);
+			is_completed = this->execute_statement(statement, reader);
+		}
+		catch (const std::exception& exc)
+		{
+			sqlite3_finalize(statement);
+			throw;
+		}
+
+		if (is_cacheable && this->statements.capacity())
+		{
+			sqlite3_reset(statement);
+			sqlite3_clear_bindings(statement);
+			this->statements.put(query, statement);
+		}
+		else
+		{
+			sqlite3_finalize(statement);
+		}
+
+		if (!is_completed)
+		{
+			// Reading was stopped by the row reader.
+			return;
+		}
+	}
+
+	if (offset != parameters.size())
+	{
+		throw QueryError(
+			"Query has fewer placeholders than passed parameters: " + std::to_string(parameters.size()),
+			_ERROR_DETAILS_
 		);
 	}
-	else if (vector_handler)
-	{
-		using function_type = std::function<void(const std::vector<char*>&)>;
-		ret_val = sqlite3_exec(
-			this->db,
-			query.c_str(),
-			[](void* data, int argc, char** argv, char** column_names) -> int {
-				auto& handler = *(function_type*)data;
-				std::vector<char*> vector;
-				vector.reserve(argc);
-				for (int i = 0; i < argc; i++)
-				{
-					// TODO: check what if column value is nullptr!
-					vector.emplace_back(argv[i]);
-				}
-
-				handler(vector);
-				return 0;
-			},
-			&vector_handler,
-			&message_error
+}
+
+::sqlite3_stmt* SQLite3Connection::prepare_single_statement(const std::string& query) const
+{
+	if (query.empty())
+	{
+		this->throw_empty_arg("query", _ERROR_DETAILS_);
+	}
+
+	auto cached_statement = this->statements.take(query);
+	if (cached_statement.has_value())
+	{
+		this->cache_hits++;
+		return cached_statement.value();
+	}
+
+	this->cache_misses++;
+	::sqlite3_stmt* statement = nullptr;
+	const char* tail = nullptr;
+	auto flags = this->statements.capacity() ? SQLITE_PREPARE_PERSISTENT : 0;
+	if (sqlite3_prepare_v3(this->db, query.c_str(), -1, flags, &statement, &tail) != SQLITE_OK)
+	{
+		this->throw_sql_error(_ERROR_DETAILS_);
+	}
+
+	if (!statement || std::strspn(tail, " \t\r\n") != std::strlen(tail))
+	{
+		sqlite3_finalize(statement);
+		throw QueryError("Query should contain a single statement", _ERROR_DETAILS_);
+	}
+
+	return statement;
+}
+
+void SQLite3Connection::bind_parameters(
+	::sqlite3_stmt* statement, const std::vector<db::Parameter>& parameters, size_t& offset
+) const
+{
+	auto count = (size_t)sqlite3_bind_parameter_count(statement);
+	if (offset + count > parameters.size())
+	{
+		throw QueryError(
+			"Query has more placeholders than passed parameters: " + std::to_string(parameters.size()),
+			_ERROR_DETAILS_
 		);
 	}
-	else
+
+	for (int i = 1; i <= (int)count; i++)
 	{
-		ret_val = sqlite3_exec(this->db, query.c_str(), nullptr, nullptr, &message_error);
+		const auto& value = parameters[offset++].value;
+		int result;
+		if (auto integer = std::get_if<long long>(&value))
+		{
+			result = sqlite3_bind_int64(statement, i, *integer);
+		}
+		else if (auto real = std::get_if<double>(&value))
+		{
+			result = sqlite3_bind_double(statement, i, *real);
+		}
+		else if (auto text = std::get_if<std::string>(&value))
+		{
+			result = sqlite3_bind_text(statement, i, text->c_str(), (int)text->size(), SQLITE_STATIC);
+		}
+		else
+		{
+			result = sqlite3_bind_null(statement, i);
+		}
+
+		if (result != SQLITE_OK)
+		{
+			this->throw_sql_error(_ERROR_DETAILS_);
+		}
 	}
+}
 
-	if (ret_val != SQLITE_OK)
+bool SQLite3Connection::execute_statement(::sqlite3_stmt* statement, const row_reader& reader) const
+{
+	int result;
+	bool is_first_row = true;
+	while ((result = sqlite3_step(statement)) == SQLITE_ROW)
+	{
+		if (reader && !reader(statement, is_first_row))
+		{
+			return false;
+		}
+
+		is_first_row = false;
+	}
+
+	if (result != SQLITE_DONE)
+	{
+		this->throw_sql_error(_ERROR_DETAILS_);
+	}
+
+	return true;
+}
+
+SQLite3Connection::row_reader SQLite3Connection::make_row_reader(
+	const std::function<void(const std::map<std::string, char*>&)>& map_handler,
+	const std::function<void(const std::vector<char*>&)>& vector_handler
+)
+{
+	if (map_handler)
 	{
-		auto message = std::string(message_error);
-		sqlite3_free(message_error);
-		throw SQLError(message, _ERROR_DETAILS_);
+		return [&map_handler](::sqlite3_stmt* statement, bool) -> bool
+		{
+			map_handler(row_as_map(statement));
+			return true;
+		};
+	}
+
+	if (vector_handler)
+	{
+		return [&vector_handler](::sqlite3_stmt* statement, bool) -> bool
+		{
+			auto columns_count = sqlite3_column_count(statement);
+			std::vector<char*> vector;
+			vector.reserve(columns_count);
+			for (int i = 0; i < columns_count; i++)
+			{
+				vector.emplace_back((char*)sqlite3_column_text(statement, i));
+			}
+
+			vector_handler(vector);
+			return true;
+		};
+	}
+
+	return nullptr;
+}
+
+std::map<std::string, char*> SQLite3Connection::row_as_map(::sqlite3_stmt* statement)
+{
+	auto columns_count = sqlite3_column_count(statement);
+	std::map<std::string, char*> map;
+	for (int i = 0; i < columns_count; i++)
+	{
+		map[sqlite3_column_name(statement, i)] = (char*)sqlite3_column_text(statement, i);
+	}
+
+	return map;
+}
+
+db::Columns SQLite3Connection::columns_of(::sqlite3_stmt* statement)
+{
+	auto columns_count = sqlite3_column_count(statement);
+	std::vector<std::string> names;
+	names.reserve(columns_count);
+	for (int i = 0; i < columns_count; i++)
+	{
+		names.emplace_back(sqlite3_column_name(statement, i));
+	}
+
+	return db::Columns(std::move(names));
+}
+
+void SQLite3Connection::read_values(::sqlite3_stmt* statement, std::vector<db::Value>& values)
+{
+	auto columns_count = sqlite3_column_count(statement);
+	values.resize(columns_count);
+	for (int i = 0; i < columns_count; i++)
+	{
+		auto& value = values[i];
+		switch (sqlite3_column_type(statement, i))
+		{
+			case SQLITE_INTEGER:
+				value = db::Value((long long)sqlite3_column_int64(statement, i));
+				break;
+			case SQLITE_FLOAT:
+				value = db::Value(sqlite3_column_double(statement, i));
+				break;
+			case SQLITE_NULL:
+				value = db::Value();
+				break;
+			default:
+			{
+				auto text = (const char*)sqlite3_column_text(statement, i);
+				value = db::Value(std::string_view(text, sqlite3_column_bytes(statement, i)));
+				break;
+			}
+		}
 	}
 }
 
@@ -12,27 +12,32 @@
 
 // C++ libraries.
 #include <string>
+#include <memory>
 #include <functional>
 
 // SQLite
 #include <sqlite3.h>
 
-// Base libraries.
-#include <xalwart.base/interfaces/orm.h>
-
 // Module definitions.
 #include "./_def_.h"
 
 // Orm libraries.
+#include "../interfaces.h"
 #include "../exceptions.h"
+#include "../utility.h"
 
 
 __ORM_SQLITE3_BEGIN__
 
-class SQLite3Connection : public IDatabaseConnection
+class SQLite3Connection : public ISQLConnection
 {
 public:
-	explicit SQLite3Connection(const char* filename);
+	// 'statements_cache_size' is the maximum number of prepared
+	// statements which are kept alive between queries. Zero disables
+	// the cache. 'flags' are passed to 'sqlite3_open_v2'.
+	explicit SQLite3Connection(
+		const char* filename, size_t statements_cache_size=32, int flags=SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE
+	);
 
 	~SQLite3Connection() override;
 
@@ -55,12 +60,54 @@ public:
 
 	void run_query(const std::string& sql_query, std::string& last_row_id) const override;
 
+	// Acts like 'run_query' above, but binds 'parameters' to
+	// placeholders of the statements in the same order.
+	void run_query(
+		const std::string& sql_query,
+		const std::vector<db::Parameter>& parameters,
+		const std::function<void(const std::map<std::string, char*>& /* columns */)>& map_handler,
+		const std::function<void(const std::vector<char*>& /* columns */)>& vector_handler
+	) const override;
+
+	void run_query(
+		const std::string& sql_query, const std::vector<db::Parameter>& parameters, std::string& last_row_id
+	) const override;
+
+	// Integer and real columns are passed as numbers, other
+	// columns as text. Rows are always read one by one, so
+	// 'is_streamed' does not change anything.
+	void run_typed_query(
+		const std::string& sql_query,
+		const std::vector<db::Parameter>& parameters,
+		const db::RowHandler& row_handler,
+		bool is_streamed=false
+	) const override;
+
+	// Statements are run one by one inside of the transaction, which
+	// is started by the batch if it is not in progress yet. Database is
+	// local, so there is nothing to gain from sending them at once.
+	std::vector<size_t> run_batch(const std::vector<db::Statement>& statements) const override;
+
+	// Each call of 'next' steps the prepared statement once, which is
+	// taken from the cache of statements and returned back to it when
+	// the cursor is destroyed.
+	[[nodiscard]]
+	std::unique_ptr<ISQLCursor> open_cursor(
+		const std::string& sql_query, const std::vector<db::Parameter>& parameters
+	) const override;
+
+	[[nodiscard]]
+	inline size_t max_parameters() const override
+	{
+		return sqlite3_limit(this->db, SQLITE_LIMIT_VARIABLE_NUMBER, -1);
+	}
+
 	inline void begin_transaction() const final
 	{
 		if (!this->in_transaction)
 		{
 			this->in_transaction = true;
-			this->run_query_unsafe("BEGIN TRANSACTION;", nullptr, nullptr);
+			this->run_query_unsafe("BEGIN TRANSACTION;", nullptr);
 		}
 	}
 
@@ -71,7 +118,7 @@ public:
 		if (this->in_transaction)
 		{
 			this->in_transaction = false;
-			this->run_query_unsafe("COMMIT TRANSACTION;", nullptr, nullptr);
+			this->run_query_unsafe("COMMIT TRANSACTION;", nullptr);
 		}
 	}
 
@@ -80,15 +127,58 @@ public:
 		if (this->in_transaction)
 		{
 			this->in_transaction = false;
-			this->run_query_unsafe("ROLLBACK TRANSACTION;", nullptr, nullptr);
+			this->run_query_unsafe("ROLLBACK TRANSACTION;", nullptr);
 		}
 	}
 
+	[[nodiscard]]
+	inline bool is_in_transaction() const override
+	{
+		return sqlite3_get_autocommit(this->db) == 0;
+	}
+
+	// Database is local, so the connection is never lost.
+	inline void set_reconnect_handler(reconnect_handler) override
+	{
+	}
+
+	// Returns true if the database was opened with 'SQLITE_OPEN_READONLY'
+	// or the file is not writable.
+	[[nodiscard]]
+	inline bool is_read_only() const
+	{
+		return sqlite3_db_readonly(this->db, "main") == 1;
+	}
+
+	// Number of queries which reused a cached prepared statement.
+	[[nodiscard]]
+	inline size_t statements_cache_hits() const
+	{
+		return this->cache_hits;
+	}
+
+	// Number of queries which were compiled from scratch.
+	[[nodiscard]]
+	inline size_t statements_cache_misses() const
+	{
+		return this->cache_misses;
+	}
+
 protected:
+	class Cursor;
+
 	mutable bool in_transaction;
 
 	::sqlite3* db = nullptr;
 
+	// Prepared statements keyed by SQL text. A statement is taken
+	// out of the cache while it is running, so nested queries with
+	// the same SQL never share the handle.
+	mutable util::LRUCache<std::string, ::sqlite3_stmt*> statements;
+
+	mutable size_t cache_hits = 0;
+	mutable size_t cache_misses = 0;
+
 	// Helper method which throws 'QueryError' with message and
 	// location for 'arg' argument name.
 	inline void throw_empty_arg(const std::string& arg, int line, const char* function, const char* file) const
@@ -96,17 +186,67 @@ protected:
 		throw DatabaseError(this->dbms_name() + ": '" + arg + "' is required", line, function, file);
 	}
 
+	// Reads the current row of the statement. 'is_first_row' is true
+	// for the first row of each statement, so the reader knows when
+	// the result set changes. Returns false to stop reading of the
+	// rest rows.
+	using row_reader = std::function<bool(::sqlite3_stmt* /* statement */, bool /* is_first_row */)>;
+
 	// Executes SQL query which returns rows as a result.
-	// 'row_handler' can be used for building an instance
-	// of the object from columns.
+	// 'reader' is called for each row and can be used for
+	// building an instance of the object from columns.
 	//
 	// 'sql_query' should be a valid SQL statement.
-	// 'row_handler' can be nullptr.
+	// 'reader' can be nullptr.
+	// 'parameters' are bound sequentially to all statements
+	// of 'sql_query'.
 	virtual void run_query_unsafe(
-		const std::string& sql_query,
-		std::function<void(const std::map<std::string, char*>& /* columns_as_map */)> map_handler,
-		std::function<void(const std::vector<char*>& /* columns_as_vector */)> vector_handler
+		const std::string& sql_query, const row_reader& reader, const std::vector<db::Parameter>& parameters={}
 	) const;
+
+	// Returns the prepared statement of 'query' from the cache or
+	// compiles it. The statement is taken out of the cache, so the
+	// caller must put it back or finalize it.
+	//
+	// Throws 'QueryError' if 'query' contains several statements.
+	::sqlite3_stmt* prepare_single_statement(const std::string& query) const;
+
+	// Binds as many values of 'parameters' starting from 'offset'
+	// as the statement has placeholders and moves 'offset' to the
+	// first unused parameter. Text values are not copied, so
+	// 'parameters' must outlive the execution of the statement.
+	void bind_parameters(
+		::sqlite3_stmt* statement, const std::vector<db::Parameter>& parameters, size_t& offset
+	) const;
+
+	// Steps through all rows of the prepared statement and passes
+	// each of them to 'reader'. Does not reset the statement.
+	//
+	// Returns false if reading was stopped by 'reader'.
+	bool execute_statement(::sqlite3_stmt* statement, const row_reader& reader) const;
+
+	// Wraps handlers of 'run_query' into row reader. Returned
+	// reader refers to the handlers, so they must outlive it.
+	static row_reader make_row_reader(
+		const std::function<void(const std::map<std::string, char*>&)>& map_handler,
+		const std::function<void(const std::vector<char*>&)>& vector_handler
+	);
+
+	// Returns columns of the current row keyed by names.
+	static std::map<std::string, char*> row_as_map(::sqlite3_stmt* statement);
+
+	// Returns names of result columns of the statement.
+	static db::Columns columns_of(::sqlite3_stmt* statement);
+
+	// Replaces 'values' with typed columns of the current row,
+	// keeping the memory of the vector.
+	static void read_values(::sqlite3_stmt* statement, std::vector<db::Value>& values);
+
+	// Throws 'SQLError' with the last error message of the database.
+	inline void throw_sql_error(int line, const char* function, const char* file) const
+	{
+		throw SQLError(sqlite3_errmsg(this->db), line, function, file);
+	}
 };
 
 __ORM_SQLITE3_END__
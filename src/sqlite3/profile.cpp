@@ -0,0 +1,109 @@
+/**
+ * sqlite3/profile.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./profile.h"
+
+#ifdef USE_SQLITE3
+
+// Base libraries.
+#include <xalwart.base/exceptions.h>
+
+
+__ORM_SQLITE3_BEGIN__
+
+Profile Profile::durable()
+{
+	Profile profile;
+	profile.journal_mode = "DELETE";
+	profile.synchronous = "FULL";
+	profile.busy_timeout = std::chrono::milliseconds(5000);
+	return profile;
+}
+
+Profile Profile::fast_wal()
+{
+	Profile profile;
+	profile.journal_mode = "WAL";
+	profile.synchronous = "NORMAL";
+	profile.cache_size = -64 * 1024;
+	profile.mmap_size = 256LL * 1024 * 1024;
+	profile.temp_store = "MEMORY";
+	profile.busy_timeout = std::chrono::milliseconds(5000);
+	return profile;
+}
+
+Profile Profile::bulk_load()
+{
+	Profile profile;
+	profile.journal_mode = "MEMORY";
+	profile.synchronous = "OFF";
+	profile.cache_size = -256 * 1024;
+	profile.temp_store = "MEMORY";
+	profile.busy_timeout = std::chrono::milliseconds(5000);
+	return profile;
+}
+
+Profile Profile::from_name(const std::string& name)
+{
+	if (name == "durable")
+	{
+		return durable();
+	}
+
+	if (name == "fast-wal")
+	{
+		return fast_wal();
+	}
+
+	if (name == "bulk-load")
+	{
+		return bulk_load();
+	}
+
+	throw ValueError(
+		"Unknown sqlite3 profile '" + name + "', expected 'durable', 'fast-wal' or 'bulk-load'", _ERROR_DETAILS_
+	);
+}
+
+std::vector<std::string> Profile::pragmas(bool is_read_only) const
+{
+	std::vector<std::string> result;
+	if (this->journal_mode.has_value() && !is_read_only)
+	{
+		result.push_back("PRAGMA journal_mode = " + this->journal_mode.value() + ";");
+	}
+
+	if (this->synchronous.has_value())
+	{
+		result.push_back("PRAGMA synchronous = " + this->synchronous.value() + ";");
+	}
+
+	if (this->cache_size.has_value())
+	{
+		result.push_back("PRAGMA cache_size = " + std::to_string(this->cache_size.value()) + ";");
+	}
+
+	if (this->mmap_size.has_value())
+	{
+		result.push_back("PRAGMA mmap_size = " + std::to_string(this->mmap_size.value()) + ";");
+	}
+
+	if (this->temp_store.has_value())
+	{
+		result.push_back("PRAGMA temp_store = " + this->temp_store.value() + ";");
+	}
+
+	if (this->busy_timeout.has_value())
+	{
+		result.push_back("PRAGMA busy_timeout = " + std::to_string(this->busy_timeout.value().count()) + ";");
+	}
+
+	return result;
+}
+
+__ORM_SQLITE3_END__
+
+#endif // USE_SQLITE3
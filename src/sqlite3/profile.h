@@ -0,0 +1,77 @@
+/**
+ * sqlite3/profile.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Named sets of PRAGMA statements which tune connections.
+ */
+
+#pragma once
+
+#ifdef USE_SQLITE3
+
+// C++ libraries.
+#include <string>
+#include <vector>
+#include <chrono>
+#include <optional>
+
+// Module definitions.
+#include "./_def_.h"
+
+
+__ORM_SQLITE3_BEGIN__
+
+// Settings which are applied to each connection after it is opened.
+// Values which are not set keep defaults of SQLite.
+struct Profile final
+{
+	// "DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL" or "OFF". The mode
+	// is stored in the database file, so it is not applied to read-only
+	// connections.
+	std::optional<std::string> journal_mode;
+
+	// "OFF", "NORMAL", "FULL" or "EXTRA".
+	std::optional<std::string> synchronous;
+
+	// Number of pages if positive, kibibytes if negative.
+	std::optional<long long> cache_size;
+
+	// Number of bytes of the database file which are memory-mapped.
+	std::optional<long long> mmap_size;
+
+	// "DEFAULT", "FILE" or "MEMORY".
+	std::optional<std::string> temp_store;
+
+	// How long the connection waits for a lock which is held by
+	// another one before failing with 'SQLITE_BUSY'.
+	std::optional<std::chrono::milliseconds> busy_timeout;
+
+	// Rollback journal with full synchronization, committed transactions
+	// survive a power loss.
+	static Profile durable();
+
+	// Write-ahead logging with normal synchronization and larger caches.
+	// The database stays consistent, but the last transactions can be
+	// lost on a power loss.
+	static Profile fast_wal();
+
+	// Journal in memory without synchronization for one-time imports.
+	// The database can be corrupted if the process crashes.
+	static Profile bulk_load();
+
+	// Returns the profile with 'name': "durable", "fast-wal" or
+	// "bulk-load".
+	//
+	// Throws 'ValueError' if the name is unknown.
+	static Profile from_name(const std::string& name);
+
+	// Returns statements which apply the profile in order of fields.
+	// 'journal_mode' is skipped if 'is_read_only' is true.
+	[[nodiscard]]
+	std::vector<std::string> pragmas(bool is_read_only=false) const;
+};
+
+__ORM_SQLITE3_END__
+
+#endif // USE_SQLITE3
@@ -8,6 +8,15 @@
 
 #pragma once
 
+// C++ libraries.
+#include <cstring>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <optional>
+#include <functional>
+
 // Base libraries.
 #include <xalwart.base/datetime.h>
 
@@ -20,25 +29,229 @@
 
 __ORM_UTILITY_BEGIN__
 
+// ISO-8601 layouts which are parsed and formatted by hand instead of
+// 'strptime' and 'strftime'. They match 'db::DEFAULT_*_FORMAT'.
+inline constexpr const char* ISO_DATE_FORMAT = "%Y-%m-%d";
+inline constexpr const char* ISO_TIME_FORMAT = "%H:%M:%S";
+inline constexpr const char* ISO_DATETIME_FORMAT = "%Y-%m-%d %H:%M:%S";
+
+// Reads 'count' decimal digits from 'text' starting at 'pos'.
+inline bool read_digits(std::string_view text, size_t pos, size_t count, int& result)
+{
+	if (pos + count > text.size())
+	{
+		return false;
+	}
+
+	result = 0;
+	for (size_t i = pos; i < pos + count; i++)
+	{
+		auto digit = text[i] - '0';
+		if (digit < 0 || digit > 9)
+		{
+			return false;
+		}
+
+		result = result * 10 + digit;
+	}
+
+	return true;
+}
+
+// Writes 'value' into 'count' decimal digits, padded with zeros.
+inline void write_digits(char* buffer, int value, size_t count)
+{
+	for (size_t i = count; i > 0; i--)
+	{
+		buffer[i - 1] = (char)('0' + value % 10);
+		value /= 10;
+	}
+}
+
+// TESTME: parse_iso_date
+// Parses 'YYYY-MM-DD' at the beginning of 'text'. Returns false
+// if text has another layout or values are out of range.
+inline bool parse_iso_date(std::string_view text, dt::Date& date)
+{
+	int year, month, day;
+	if (
+		text.size() < 10 ||
+		!read_digits(text, 0, 4, year) || text[4] != '-' ||
+		!read_digits(text, 5, 2, month) || text[7] != '-' ||
+		!read_digits(text, 8, 2, day) ||
+		month < 1 || month > 12 || day < 1 || day > 31
+	)
+	{
+		return false;
+	}
+
+	date = dt::Date(year, month, day);
+	return true;
+}
+
+// TESTME: parse_iso_time
+// Parses 'HH:MM:SS' at the beginning of 'text' with optional
+// fraction of the second up to microseconds, which is sent by
+// PostgreSQL. The time zone suffix is ignored like 'strptime' does.
+// Returns false if text has another layout or values are out of range.
+inline bool parse_iso_time(std::string_view text, dt::Time& time)
+{
+	int hour, minute, second;
+	if (
+		text.size() < 8 ||
+		!read_digits(text, 0, 2, hour) || text[2] != ':' ||
+		!read_digits(text, 3, 2, minute) || text[5] != ':' ||
+		!read_digits(text, 6, 2, second) ||
+		hour > 23 || minute > 59 || second > 59
+	)
+	{
+		return false;
+	}
+
+	int microsecond = 0;
+	if (text.size() > 8 && text[8] == '.')
+	{
+		int scale = 100000;
+		for (size_t i = 9; i < text.size() && text[i] >= '0' && text[i] <= '9'; i++)
+		{
+			microsecond += (text[i] - '0') * scale;
+			scale /= 10;
+		}
+	}
+
+	time = dt::Time(hour, minute, second, microsecond);
+	return true;
+}
+
+// TESTME: parse_iso_datetime
+// Parses 'YYYY-MM-DD HH:MM:SS' at the beginning of 'text', 'T' is
+// accepted as the separator too. Fraction of the second is handled
+// like in 'parse_iso_time'.
+inline bool parse_iso_datetime(std::string_view text, dt::Datetime& datetime)
+{
+	dt::Date date;
+	dt::Time time;
+	if (
+		text.size() < 19 || (text[10] != ' ' && text[10] != 'T') ||
+		!parse_iso_date(text, date) || !parse_iso_time(text.substr(11), time)
+	)
+	{
+		return false;
+	}
+
+	datetime = dt::Datetime(
+		date.year(), date.month(), date.day(), time.hour(), time.minute(), time.second(), time.microsecond()
+	);
+	return true;
+}
+
 // TESTME: as_date
-// TODO: docs for 'as_date'
-inline dt::Date as_date(const void* data, const char* format)
+// Parses the date with 'format'. The ISO layout is parsed by hand,
+// other formats and unexpected text are passed to 'strptime'.
+inline dt::Date as_date(std::string_view text, const char* format)
 {
-	return dt::Datetime::strptime((const char*)data, format).date();
+	dt::Date date;
+	if (std::strcmp(format, ISO_DATE_FORMAT) == 0 && parse_iso_date(text, date))
+	{
+		return date;
+	}
+
+	return dt::Datetime::strptime(std::string(text).c_str(), format).date();
 }
 
 // TESTME: as_time
-// TODO: docs for 'as_time'
-inline dt::Time as_time(const void* data, const char* format)
+// Acts like 'as_date', but for the time.
+inline dt::Time as_time(std::string_view text, const char* format)
 {
-	return dt::Datetime::strptime((const char*)data, format).time_tz();
+	dt::Time time;
+	if (std::strcmp(format, ISO_TIME_FORMAT) == 0 && parse_iso_time(text, time))
+	{
+		return time;
+	}
+
+	return dt::Datetime::strptime(std::string(text).c_str(), format).time_tz();
 }
 
 // TESTME: as_datetime
-// TODO: docs for 'as_datetime'
+// Acts like 'as_date', but for the date and time.
+inline dt::Datetime as_datetime(std::string_view text, const char* format)
+{
+	dt::Datetime datetime;
+	if (std::strcmp(format, ISO_DATETIME_FORMAT) == 0 && parse_iso_datetime(text, datetime))
+	{
+		return datetime;
+	}
+
+	return dt::Datetime::strptime(std::string(text).c_str(), format);
+}
+
+inline dt::Date as_date(const void* data, const char* format)
+{
+	return as_date(std::string_view((const char*)data), format);
+}
+
+inline dt::Time as_time(const void* data, const char* format)
+{
+	return as_time(std::string_view((const char*)data), format);
+}
+
 inline dt::Datetime as_datetime(const void* data, const char* format)
 {
-	return dt::Datetime::strptime((const char*)data, format);
+	return as_datetime(std::string_view((const char*)data), format);
+}
+
+// TESTME: format_date
+// Formats the date with 'format'. The ISO layout is written by hand
+// for years from 0 to 9999, other dates and formats are passed to
+// 'strftime'.
+inline std::string format_date(const dt::Date& date, const char* format)
+{
+	if (std::strcmp(format, ISO_DATE_FORMAT) != 0 || date.year() < 0 || date.year() > 9999)
+	{
+		return date.strftime(format);
+	}
+
+	char buffer[10] = {0, 0, 0, 0, '-', 0, 0, '-', 0, 0};
+	write_digits(buffer, date.year(), 4);
+	write_digits(buffer + 5, date.month(), 2);
+	write_digits(buffer + 8, date.day(), 2);
+	return {buffer, sizeof(buffer)};
+}
+
+// TESTME: format_time
+// Acts like 'format_date', but for the time. Like 'strftime' with
+// the ISO layout, microseconds are not written.
+inline std::string format_time(const dt::Time& time, const char* format)
+{
+	if (std::strcmp(format, ISO_TIME_FORMAT) != 0)
+	{
+		return time.strftime(format);
+	}
+
+	char buffer[8] = {0, 0, ':', 0, 0, ':', 0, 0};
+	write_digits(buffer, time.hour(), 2);
+	write_digits(buffer + 3, time.minute(), 2);
+	write_digits(buffer + 6, time.second(), 2);
+	return {buffer, sizeof(buffer)};
+}
+
+// TESTME: format_datetime
+// Acts like 'format_date', but for the date and time.
+inline std::string format_datetime(const dt::Datetime& datetime, const char* format)
+{
+	if (std::strcmp(format, ISO_DATETIME_FORMAT) != 0 || datetime.year() < 0 || datetime.year() > 9999)
+	{
+		return datetime.strftime(format);
+	}
+
+	char buffer[19] = {0, 0, 0, 0, '-', 0, 0, '-', 0, 0, ' ', 0, 0, ':', 0, 0, ':', 0, 0};
+	write_digits(buffer, datetime.year(), 4);
+	write_digits(buffer + 5, datetime.month(), 2);
+	write_digits(buffer + 8, datetime.day(), 2);
+	write_digits(buffer + 11, datetime.hour(), 2);
+	write_digits(buffer + 14, datetime.minute(), 2);
+	write_digits(buffer + 17, datetime.second(), 2);
+	return {buffer, sizeof(buffer)};
 }
 
 // TESTME: quote_str
@@ -48,6 +261,20 @@ inline std::string quote_str(const std::string& s)
 	return s.starts_with('"') ? s : '"' + s + '"';
 }
 
+// TESTME: append_quoted
+// Acts like 'quote_str', but writes the result to the end of 'output'.
+inline void append_quoted(std::string& output, std::string_view s)
+{
+	if (s.starts_with('"'))
+	{
+		output.append(s);
+	}
+	else
+	{
+		output.append(1, '"').append(s).append(1, '"');
+	}
+}
+
 // TESTME: tuple_for_each
 // TODO: docs for 'tuple_for_each'
 template <
@@ -57,7 +284,7 @@ template <
 	typename CallableT, // the callable to bo invoked for each tuple item
 	typename... ArgsT   // other arguments to be passed to the callable
 >
-inline void tuple_for_each(TupleT&& tuple, CallableT&& callable, ArgsT&&... args)
+inline constexpr void tuple_for_each(TupleT&& tuple, CallableT&& callable, ArgsT&&... args)
 {
 	if constexpr (Index < Size)
 	{
@@ -109,6 +336,127 @@ inline bool compare_any(const L &lhs, const R &rhs) {
 	return TypedComparator<L, R>()(lhs, rhs);
 }
 
+// Fixed-capacity key-value storage which evicts the least
+// recently used entry when a new one does not fit.
+//
+// Values are moved in and out of the cache: 'take' removes an
+// entry and returns it to the caller, 'put' returns it back as
+// the most recently used one. This allows to hold an external
+// resource (for example, prepared statement) exclusively while
+// it is in use.
+//
+// 'evict' is called for each value which is dropped by the cache
+// itself: when the capacity is exceeded, when the value with the
+// same key is replaced or when the cache is cleared.
+template <typename KeyT, typename ValueT>
+class LRUCache final
+{
+public:
+	using eviction_handler = std::function<void(const KeyT& /* key */, ValueT& /* value */)>;
+
+	explicit inline LRUCache(size_t capacity, eviction_handler evict=nullptr) :
+		_capacity(capacity), _evict(std::move(evict))
+	{
+	}
+
+	LRUCache(const LRUCache&) = delete;
+
+	LRUCache& operator= (const LRUCache&) = delete;
+
+	inline ~LRUCache()
+	{
+		this->clear();
+	}
+
+	// Removes an entry from the cache and returns its value.
+	// Returns 'std::nullopt' if the key is not cached.
+	inline std::optional<ValueT> take(const KeyT& key)
+	{
+		auto it = this->_index.find(key);
+		if (it == this->_index.end())
+		{
+			return std::nullopt;
+		}
+
+		auto value = std::move(it->second->second);
+		this->_entries.erase(it->second);
+		this->_index.erase(it);
+		return value;
+	}
+
+	// Inserts the value as the most recently used one. If the
+	// capacity is zero, the value is evicted immediately.
+	inline void put(const KeyT& key, ValueT value)
+	{
+		auto it = this->_index.find(key);
+		if (it != this->_index.end())
+		{
+			this->_evict_entry(it->second);
+		}
+
+		this->_entries.emplace_front(key, std::move(value));
+		this->_index[key] = this->_entries.begin();
+		while (this->_entries.size() > this->_capacity)
+		{
+			this->_evict_entry(std::prev(this->_entries.end()));
+		}
+	}
+
+	// Evicts all entries.
+	inline void clear()
+	{
+		while (!this->_entries.empty())
+		{
+			this->_evict_entry(this->_entries.begin());
+		}
+	}
+
+	// Drops all entries without calling the eviction handler.
+	// Useful when cached resources are already released externally.
+	inline void discard()
+	{
+		this->_index.clear();
+		this->_entries.clear();
+	}
+
+	[[nodiscard]]
+	inline bool contains(const KeyT& key) const
+	{
+		return this->_index.contains(key);
+	}
+
+	[[nodiscard]]
+	inline size_t size() const
+	{
+		return this->_entries.size();
+	}
+
+	[[nodiscard]]
+	inline size_t capacity() const
+	{
+		return this->_capacity;
+	}
+
+private:
+	using entry_list = std::list<std::pair<KeyT, ValueT>>;
+
+	size_t _capacity;
+	eviction_handler _evict;
+	entry_list _entries;
+	std::unordered_map<KeyT, typename entry_list::iterator> _index;
+
+	inline void _evict_entry(typename entry_list::iterator entry)
+	{
+		auto node = std::move(*entry);
+		this->_index.erase(node.first);
+		this->_entries.erase(entry);
+		if (this->_evict)
+		{
+			this->_evict(node.first, node.second);
+		}
+	}
+};
+
 // TESTME: check_model
 // Checks constraints of the Model.
 //
@@ -22,7 +22,7 @@ protected:
 
 		static constexpr const char* meta_table_name = "test_models";
 
-		inline static const std::tuple meta_columns = {
+		inline static constexpr std::tuple meta_columns = {
 			orm::db::make_pk_column_meta("id", &TestCase_Model_meta::TestModel::id)
 		};
 
@@ -36,6 +36,11 @@ protected:
 TEST_F(TestCase_Model_meta, get_table_name)
 {
 	ASSERT_EQ(orm::db::get_table_name<TestCase_Model_meta::TestModel>(), "test_models");
+	ASSERT_EQ(orm::db::get_table_name<TestCase_Model_meta::TestModel>(true), "\"test_models\"");
+	ASSERT_EQ(
+		&orm::db::get_table_name<TestCase_Model_meta::TestModel>(),
+		&orm::db::get_table_name<TestCase_Model_meta::TestModel>()
+	);
 }
 
 TEST_F(TestCase_Model_meta, get_pk_name)
@@ -55,6 +60,21 @@ TEST_F(TestCase_Model_meta, get_column_name_FoundColumn)
 	ASSERT_EQ(orm::db::get_column_name(&TestCase_Model_meta::TestModel::id), expected);
 }
 
+TEST_F(TestCase_Model_meta, get_column_name_FoundColumnAtCompileTime)
+{
+	const auto& name = orm::db::get_column_name<&TestCase_Model_meta::TestModel::id>();
+	ASSERT_EQ(name, "id");
+	ASSERT_EQ(&name, &orm::db::get_column_name<&TestCase_Model_meta::TestModel::id>());
+	ASSERT_EQ(orm::db::get_column_name<&TestCase_Model_meta::TestModel::id>(true), "\"id\"");
+}
+
+TEST_F(TestCase_Model_meta, get_column_name_ReturnsCachedName)
+{
+	const auto& name = orm::db::get_column_name(&TestCase_Model_meta::TestModel::id);
+	ASSERT_EQ(&name, &orm::db::get_column_name(&TestCase_Model_meta::TestModel::id));
+	ASSERT_EQ(orm::db::get_column_name(&TestCase_Model_meta::TestModel::id, true), "\"id\"");
+}
+
 TEST_F(TestCase_Model_meta, get_column_name_ThrowsColumnNotFound)
 {
 	ASSERT_THROW(
@@ -63,6 +83,32 @@ TEST_F(TestCase_Model_meta, get_column_name_ThrowsColumnNotFound)
 	);
 }
 
+TEST_F(TestCase_Model_meta, find_column_name_IsConstexpr)
+{
+	static_assert(orm::db::find_column_name(&TestCase_Model_meta::TestModel::id) == "id");
+	static_assert(orm::db::find_column_name(&TestCase_Model_meta::TestModel::non_existent_column).empty());
+	static_assert(orm::db::find_pk_name<TestCase_Model_meta::TestModel>() == "id");
+}
+
+TEST_F(TestCase_Model_meta, get_column_names)
+{
+	const auto& names = orm::db::get_column_names<TestCase_Model_meta::TestModel>();
+	ASSERT_EQ(names, std::list<std::string>{"id"});
+	ASSERT_EQ(&names, &orm::db::get_column_names<TestCase_Model_meta::TestModel>());
+}
+
+TEST_F(TestCase_Model_meta, ColumnMeta_Conversions)
+{
+	const auto& column = std::get<0>(TestCase_Model_meta::TestModel::meta_columns);
+	static_assert(std::is_same_v<decltype(column.as_field(nullptr)), int>);
+
+	TestCase_Model_meta::TestModel model;
+	model.id = 17;
+	ASSERT_EQ(column.as_field("42"), 42);
+	ASSERT_EQ(column.as_string(model), "17");
+	ASSERT_EQ(std::get<long long>(column.as_parameter(model).value), 17);
+}
+
 class TestCase_meta_TestM : public orm::db::Model
 {
 public:
@@ -101,3 +147,63 @@ TEST(TestCase_meta, make_fk_ThrowsPkRequired)
 {
 	ASSERT_THROW(orm::db::make_fk<TestModelWithoutPk>(), orm::QueryError);
 }
+
+TEST(TestCase_meta, value_as_field_NumberToArithmetic)
+{
+	ASSERT_EQ(orm::db::value_as_field<int>(orm::db::Value(42LL)), 42);
+	ASSERT_EQ(orm::db::value_as_field<double>(orm::db::Value(1.5)), 1.5);
+	ASSERT_TRUE(orm::db::value_as_field<bool>(orm::db::Value(1LL)));
+}
+
+TEST(TestCase_meta, value_as_field_NumberToString)
+{
+	ASSERT_EQ(orm::db::value_as_field<std::string>(orm::db::Value(42LL)), "42");
+	ASSERT_EQ(orm::db::value_as_field<std::string>(orm::db::Value(1.5)), "1.5");
+}
+
+TEST(TestCase_meta, value_as_field_Text)
+{
+	std::string data = "Steve";
+	ASSERT_EQ(orm::db::value_as_field<std::string>(orm::db::Value(std::string_view(data))), "Steve");
+}
+
+TEST(TestCase_meta, value_as_field_DatetimeToDate)
+{
+	auto value = orm::db::Value(dt::Datetime(2021, 3, 4, 5, 6, 7));
+	ASSERT_EQ(orm::db::value_as_field<dt::Date>(value), dt::Date(2021, 3, 4));
+}
+
+TEST(TestCase_meta, value_as_field_ThrowsDateToNumber)
+{
+	ASSERT_THROW(orm::db::value_as_field<int>(orm::db::Value(dt::Date(2021, 3, 4))), TypeError);
+}
+
+TEST(TestCase_meta, text_as_field_Numbers)
+{
+	ASSERT_EQ(orm::db::text_as_field<int>("-42"), -42);
+	ASSERT_EQ(orm::db::text_as_field<unsigned long>("+17"), 17);
+	ASSERT_EQ(orm::db::text_as_field<long long>(" 12.5"), 12);
+	ASSERT_EQ(orm::db::text_as_field<double>("1.25e2"), 125.0);
+	ASSERT_EQ(orm::db::text_as_field<float>("0.5"), 0.5f);
+}
+
+TEST(TestCase_meta, text_as_field_IsNotNullTerminated)
+{
+	std::string_view data = "12345";
+	ASSERT_EQ(orm::db::text_as_field<int>(data.substr(0, 2)), 12);
+	ASSERT_EQ(orm::db::text_as_field<std::string>(data.substr(1, 3)), "234");
+}
+
+TEST(TestCase_meta, text_as_field_Bool)
+{
+	ASSERT_TRUE(orm::db::text_as_field<bool>("1"));
+	ASSERT_TRUE(orm::db::text_as_field<bool>("t"));
+	ASSERT_FALSE(orm::db::text_as_field<bool>("0"));
+	ASSERT_FALSE(orm::db::text_as_field<bool>("false"));
+}
+
+TEST(TestCase_meta, text_as_field_ThrowsNotNumber)
+{
+	ASSERT_THROW(orm::db::text_as_field<int>("abc"), ValueError);
+	ASSERT_THROW(orm::db::text_as_field<double>(""), ValueError);
+}
@@ -85,3 +85,152 @@ TEST(TestCase_Model, meta_omit_pk_Default_IsTrue)
 //		model, std::get<2>(TestCase_Model_TestModel::meta_columns)
 //	), "'NoNe'");
 //}
+
+TEST(TestCase_Model, from_row_SkipsNull)
+{
+	TestCase_Model_TestModel model;
+	model.name = "John";
+	std::string name = "Steve";
+	orm::db::Columns columns({"id", "name", "info"});
+	std::vector<orm::db::Value> values = {
+		orm::db::Value(10LL), orm::db::Value(std::string_view(name)), orm::db::Value()
+	};
+	orm::db::from_row(model, orm::db::Row(columns, values.data()));
+	ASSERT_EQ(model.id, 10);
+	ASSERT_EQ(model.name, "Steve");
+}
+
+TEST(TestCase_Model, from_row_ThrowsUnknownColumn)
+{
+	TestCase_Model_TestModel model;
+	orm::db::Columns columns({"unknown"});
+	orm::db::Value value(1LL);
+	ASSERT_THROW(orm::db::from_row(model, orm::db::Row(columns, &value)), AttributeError);
+}
+
+TEST(TestCase_Model, Row_FindsColumnByName)
+{
+	orm::db::Columns columns({"id", "name"});
+	std::vector<orm::db::Value> values = {orm::db::Value(1LL), orm::db::Value()};
+	orm::db::Row row(columns, values.data());
+	ASSERT_EQ(row.size(), 2);
+	ASSERT_EQ(row.find("name"), &row[1]);
+	ASSERT_EQ(row.find("unknown"), nullptr);
+	ASSERT_EQ(columns.find("id"), 0);
+	ASSERT_EQ(columns.find("unknown"), orm::db::Columns::npos);
+}
+
+TEST(TestCase_Model, Columns_KeepsRowsCount)
+{
+	ASSERT_EQ(orm::db::Columns({"id"}).rows_count(), orm::db::Columns::npos);
+	ASSERT_EQ(orm::db::Columns({"id"}, 5).rows_count(), 5);
+}
+
+TEST(TestCase_Model, ColumnSetters_find_UnknownColumn)
+{
+	ASSERT_NE(orm::db::ColumnSetters<TestCase_Model_TestModel>::find("name"), nullptr);
+	ASSERT_EQ(orm::db::ColumnSetters<TestCase_Model_TestModel>::find("unknown"), nullptr);
+}
+
+TEST(TestCase_Model, RowHydrator_ReusesBindingForResultSet)
+{
+	orm::db::RowHydrator<TestCase_Model_TestModel> hydrate;
+	orm::db::Columns columns({"name", "id"});
+	std::string first_name = "Steve", second_name = "John";
+	std::vector<orm::db::Value> first = {orm::db::Value(std::string_view(first_name)), orm::db::Value(1LL)};
+	std::vector<orm::db::Value> second = {orm::db::Value(std::string_view(second_name)), orm::db::Value(2LL)};
+
+	TestCase_Model_TestModel first_model, second_model;
+	hydrate(first_model, orm::db::Row(columns, first.data()));
+	hydrate(second_model, orm::db::Row(columns, second.data()));
+	ASSERT_EQ(first_model.id, 1);
+	ASSERT_EQ(first_model.name, "Steve");
+	ASSERT_EQ(second_model.id, 2);
+	ASSERT_EQ(second_model.name, "John");
+}
+
+TEST(TestCase_Model, RowHydrator_BindsAgainWhenColumnsChange)
+{
+	orm::db::RowHydrator<TestCase_Model_TestModel> hydrate;
+	std::string name = "Steve";
+	orm::db::Columns first_columns({"id"});
+	orm::db::Value id(7LL);
+	orm::db::Columns second_columns({"name"});
+	orm::db::Value name_value{std::string_view(name)};
+
+	TestCase_Model_TestModel model;
+	hydrate(model, orm::db::Row(first_columns, &id));
+	hydrate(model, orm::db::Row(second_columns, &name_value));
+	ASSERT_EQ(model.id, 7);
+	ASSERT_EQ(model.name, "Steve");
+}
+
+TEST(TestCase_Model, RowHydrator_BindsAgainWhenColumnsAreReassigned)
+{
+	orm::db::RowHydrator<TestCase_Model_TestModel> hydrate;
+	std::string name = "Steve";
+	orm::db::Columns columns({"id", "name"});
+	std::vector<orm::db::Value> first = {orm::db::Value(7LL), orm::db::Value(std::string_view(name))};
+	orm::db::Value second(8LL);
+
+	TestCase_Model_TestModel first_model, second_model;
+	hydrate(first_model, orm::db::Row(columns, first.data()));
+
+	// Driver reuses the same object for the next result set.
+	columns = orm::db::Columns({"id"});
+	hydrate(second_model, orm::db::Row(columns, &second));
+	ASSERT_EQ(second_model.id, 8);
+	ASSERT_EQ(second_model.name, "");
+}
+
+TEST(TestCase_Model, RowHydrator_ResetsNullsOfReusedModel)
+{
+	orm::db::RowHydrator<TestCase_Model_TestModel> hydrate(true);
+	orm::db::Columns columns({"id", "name"});
+	std::string name = "Steve";
+	std::vector<orm::db::Value> first = {orm::db::Value(1LL), orm::db::Value(std::string_view(name))};
+	std::vector<orm::db::Value> second = {orm::db::Value(2LL), orm::db::Value()};
+
+	TestCase_Model_TestModel model;
+	hydrate(model, orm::db::Row(columns, first.data()));
+	hydrate(model, orm::db::Row(columns, second.data()));
+	ASSERT_EQ(model.id, 2);
+	ASSERT_EQ(model.name, "");
+}
+
+class TestCase_Model_ComputedColumnModel : public TestCase_Model_TestModel
+{
+public:
+	int name_length{};
+
+	inline void __orm_set_column__(const std::string& column_name, const char* data) override
+	{
+		if (column_name == "name_length")
+		{
+			this->name_length = std::stoi(data);
+		}
+		else
+		{
+			TestCase_Model_TestModel::__orm_set_column__(column_name, data);
+		}
+	}
+};
+
+TEST(TestCase_Model, RowHydrator_SetsUnmappedColumnThroughModel)
+{
+	orm::db::RowHydrator<TestCase_Model_ComputedColumnModel> hydrate;
+	std::string name = "Steve";
+	orm::db::Columns columns({"id", "name", "name_length"});
+	std::vector<orm::db::Value> values = {
+		orm::db::Value(1LL), orm::db::Value(std::string_view(name)), orm::db::Value(5LL)
+	};
+
+	TestCase_Model_ComputedColumnModel model;
+	hydrate(model, orm::db::Row(columns, values.data()));
+	ASSERT_EQ(model.id, 1);
+	ASSERT_EQ(model.name, "Steve");
+	ASSERT_EQ(model.name_length, 5);
+
+	columns = orm::db::Columns({"unknown"});
+	ASSERT_THROW(hydrate(model, orm::db::Row(columns, values.data())), AttributeError);
+}
@@ -0,0 +1,61 @@
+/**
+ * tests/exceptions/tests_pool_timeout_error.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <gtest/gtest.h>
+
+#include "../../src/exceptions.h"
+
+using namespace xw;
+
+
+class PoolTimeoutErrorTestCase : public ::testing::Test
+{
+public:
+	const char* WhatErrorMessage = "Test error message from PoolTimeoutErrorTestCase";
+	const char* FullErrorMessage = "xw::orm::PoolTimeoutError: Test error message from PoolTimeoutErrorTestCase";
+	const char* ErrorFunction = "testFunc";
+	const char* ErrorFile = "test_file.cpp";
+	const size_t ErrorLine = 1;
+
+	orm::PoolTimeoutError ConstCharConstructorError;
+	orm::PoolTimeoutError StringConstructorError;
+
+	explicit PoolTimeoutErrorTestCase()
+		: ConstCharConstructorError("Test error message from PoolTimeoutErrorTestCase", this->ErrorLine, this->ErrorFunction, this->ErrorFile),
+		  StringConstructorError(std::string("Test error message from PoolTimeoutErrorTestCase"), this->ErrorLine, this->ErrorFunction, this->ErrorFile)
+	{
+	}
+};
+
+TEST_F(PoolTimeoutErrorTestCase, TestWhat)
+{
+	ASSERT_STREQ(this->ConstCharConstructorError.what(), this->WhatErrorMessage);
+	ASSERT_STREQ(this->StringConstructorError.what(), this->WhatErrorMessage);
+}
+
+TEST_F(PoolTimeoutErrorTestCase, TestLine)
+{
+	ASSERT_EQ(this->ConstCharConstructorError.line(), this->ErrorLine);
+	ASSERT_EQ(this->StringConstructorError.line(), this->ErrorLine);
+}
+
+TEST_F(PoolTimeoutErrorTestCase, TestFunction)
+{
+	ASSERT_EQ(this->ConstCharConstructorError.function(), this->ErrorFunction);
+	ASSERT_EQ(this->StringConstructorError.function(), this->ErrorFunction);
+}
+
+TEST_F(PoolTimeoutErrorTestCase, TestFile)
+{
+	ASSERT_EQ(this->ConstCharConstructorError.file(), this->ErrorFile);
+	ASSERT_EQ(this->StringConstructorError.file(), this->ErrorFile);
+}
+
+TEST_F(PoolTimeoutErrorTestCase, TestGetMessage)
+{
+	ASSERT_EQ(this->ConstCharConstructorError.get_message(), this->FullErrorMessage);
+	ASSERT_EQ(this->StringConstructorError.get_message(), this->FullErrorMessage);
+}
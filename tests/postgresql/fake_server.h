@@ -0,0 +1,201 @@
+/**
+ * postgresql/fake_server.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#pragma once
+
+#ifdef USE_POSTGRESQL
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+
+// Accepts connections on the loopback interface and completes the
+// startup of each one without authentication, then discards all
+// queries. Allows to run code of the connection which does not wait
+// for results without the real server.
+class FakePostgreSQLServer final
+{
+public:
+	inline FakePostgreSQLServer()
+	{
+		this->_listener = socket(AF_INET, SOCK_STREAM, 0);
+		sockaddr_in address{};
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		socklen_t address_length = sizeof(address);
+		if (
+			this->_listener < 0 ||
+			bind(this->_listener, (sockaddr*)&address, address_length) != 0 ||
+			listen(this->_listener, 8) != 0 ||
+			getsockname(this->_listener, (sockaddr*)&address, &address_length) != 0 ||
+			pipe(this->_stop_pipe) != 0
+		)
+		{
+			throw std::runtime_error("FakePostgreSQLServer: unable to listen");
+		}
+
+		this->_port = ntohs(address.sin_port);
+		this->_thread = std::thread([this]() { this->serve(); });
+	}
+
+	inline ~FakePostgreSQLServer()
+	{
+		(void)!write(this->_stop_pipe[1], "x", 1);
+		this->_thread.join();
+		close(this->_stop_pipe[0]);
+		close(this->_stop_pipe[1]);
+		close(this->_listener);
+	}
+
+	[[nodiscard]]
+	inline unsigned int port() const
+	{
+		return this->_port;
+	}
+
+	// Returns the number of connections which were started,
+	// including ones which were started again by reset.
+	[[nodiscard]]
+	inline size_t connections_count() const
+	{
+		return this->_connections_count;
+	}
+
+private:
+	int _listener = -1;
+	int _stop_pipe[2] = {-1, -1};
+	unsigned int _port = 0;
+	std::atomic<size_t> _connections_count = 0;
+	std::thread _thread;
+
+	static constexpr uint32_t SSL_REQUEST_CODE = 80877103;
+	static constexpr uint32_t GSS_REQUEST_CODE = 80877104;
+
+	inline void serve()
+	{
+		std::vector<pollfd> descriptors = {{this->_stop_pipe[0], POLLIN, 0}, {this->_listener, POLLIN, 0}};
+		while (poll(descriptors.data(), descriptors.size(), -1) >= 0)
+		{
+			if (descriptors[0].revents)
+			{
+				break;
+			}
+
+			if (descriptors[1].revents & POLLIN)
+			{
+				auto client = accept(this->_listener, nullptr, nullptr);
+				if (client >= 0 && start(client))
+				{
+					this->_connections_count++;
+					descriptors.push_back({client, POLLIN, 0});
+				}
+				else if (client >= 0)
+				{
+					close(client);
+				}
+			}
+
+			for (size_t i = 2; i < descriptors.size();)
+			{
+				char buffer[4096];
+				if (descriptors[i].revents && read(descriptors[i].fd, buffer, sizeof(buffer)) <= 0)
+				{
+					close(descriptors[i].fd);
+					descriptors.erase(descriptors.begin() + (long)i);
+					continue;
+				}
+
+				i++;
+			}
+		}
+
+		for (size_t i = 2; i < descriptors.size(); i++)
+		{
+			close(descriptors[i].fd);
+		}
+	}
+
+	// Declines encryption and completes the startup of the client.
+	static inline bool start(int client)
+	{
+		while (true)
+		{
+			std::string message;
+			if (!read_message(client, message) || message.size() < 4)
+			{
+				return false;
+			}
+
+			auto code = read_uint32(message.data());
+			if (code != SSL_REQUEST_CODE && code != GSS_REQUEST_CODE)
+			{
+				break;
+			}
+
+			if (write(client, "N", 1) != 1)
+			{
+				return false;
+			}
+		}
+
+		// 'AuthenticationOk' and 'ReadyForQuery' with idle status.
+		const char response[] = {'R', 0, 0, 0, 8, 0, 0, 0, 0, 'Z', 0, 0, 0, 5, 'I'};
+		return write(client, response, sizeof(response)) == sizeof(response);
+	}
+
+	// Reads the startup message: length including itself, then body.
+	static inline bool read_message(int client, std::string& message)
+	{
+		char length_data[4];
+		if (!read_exact(client, length_data, sizeof(length_data)))
+		{
+			return false;
+		}
+
+		auto length = read_uint32(length_data);
+		if (length < 4 || length > 10000)
+		{
+			return false;
+		}
+
+		message.resize(length - 4);
+		return read_exact(client, message.data(), message.size());
+	}
+
+	static inline bool read_exact(int client, char* data, size_t size)
+	{
+		while (size)
+		{
+			auto count = read(client, data, size);
+			if (count <= 0)
+			{
+				return false;
+			}
+
+			data += count;
+			size -= (size_t)count;
+		}
+
+		return true;
+	}
+
+	static inline uint32_t read_uint32(const char* data)
+	{
+		auto* bytes = (const unsigned char*)data;
+		return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | bytes[3];
+	}
+};
+
+#endif // USE_POSTGRESQL
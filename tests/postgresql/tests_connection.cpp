@@ -0,0 +1,138 @@
+/**
+ * postgresql/tests_connection.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#ifdef USE_POSTGRESQL
+
+#include <gtest/gtest.h>
+
+#include "../../src/postgresql/connection.h"
+#include "../../src/backend.h"
+#include "./fake_server.h"
+
+using namespace xw;
+
+
+// Exposes the state which is restored by reset.
+struct TestCase_PostgreSQLConnection_Connection : public orm::postgresql::PostgreSQLConnection
+{
+	using orm::postgresql::PostgreSQLConnection::PostgreSQLConnection;
+	using orm::postgresql::PostgreSQLConnection::in_transaction;
+	using orm::postgresql::PostgreSQLConnection::statements;
+	using orm::postgresql::PostgreSQLConnection::prepare_connection;
+
+	inline void add_statement(const std::string& sql_query, const std::string& name)
+	{
+		this->statements.put(sql_query, PreparedStatement{name});
+	}
+};
+
+#ifdef LIBPQ_HAS_PIPELINING
+TEST(TestCase_PostgreSQLConnection, run_batch_async_ResetsConnectionIfPipelineIsNotExited)
+{
+	FakePostgreSQLServer server;
+	TestCase_PostgreSQLConnection_Connection connection({"test", "test", "test", "127.0.0.1", server.port()});
+	connection.add_statement("SELECT 1 WHERE 1 = $1;", "xw_statement_1");
+	connection.in_transaction = true;
+
+	// The second statement is rejected by libpq after the first one is
+	// queued, so the pipeline can not be exited without its results.
+	std::vector<orm::db::Statement> statements = {
+		{"SELECT 1;", {}}, {"SELECT 2;", std::vector<orm::db::Parameter>(65536)}
+	};
+	std::exception_ptr error;
+	bool is_completed = false;
+	connection.run_batch_async(statements, true, [&error, &is_completed](auto e) -> void {
+		error = e;
+		is_completed = true;
+	});
+
+	ASSERT_TRUE(is_completed);
+	ASSERT_THROW(std::rethrow_exception(error), orm::SQLError);
+	ASSERT_EQ(server.connections_count(), 2);
+	ASSERT_EQ(connection.statements.size(), 0);
+	ASSERT_FALSE(connection.in_transaction);
+}
+#endif
+
+TEST(TestCase_PostgreSQLConnection, reset_CallsReconnectHandler)
+{
+	FakePostgreSQLServer server;
+	TestCase_PostgreSQLConnection_Connection connection({"test", "test", "test", "127.0.0.1", server.port()});
+	size_t calls_count = 0;
+	connection.set_reconnect_handler([&calls_count]() -> void { calls_count++; });
+
+	connection.reset();
+	ASSERT_EQ(server.connections_count(), 2);
+	ASSERT_EQ(calls_count, 1);
+}
+
+TEST(TestCase_PostgreSQLConnection, prepare_connection_ResetsAgainIfReconnectHandlerFailed)
+{
+	FakePostgreSQLServer server;
+	TestCase_PostgreSQLConnection_Connection connection({"test", "test", "test", "127.0.0.1", server.port()});
+	size_t calls_count = 0;
+	connection.set_reconnect_handler([&calls_count]() -> void
+	{
+		if (++calls_count == 1)
+		{
+			throw orm::SQLError("unable to restore the session", _ERROR_DETAILS_);
+		}
+	});
+
+	ASSERT_THROW(connection.reset(), orm::SQLError);
+	connection.prepare_connection("SELECT 1;");
+	ASSERT_EQ(server.connections_count(), 3);
+	ASSERT_EQ(calls_count, 2);
+
+	// The session is restored, so the connection is not reset again.
+	connection.prepare_connection("SELECT 1;");
+	ASSERT_EQ(server.connections_count(), 3);
+}
+
+class TestCase_PostgreSQLConnection_Backend : public orm::DefaultSQLBackend
+{
+public:
+	inline explicit TestCase_PostgreSQLConnection_Backend(unsigned int port) : orm::DefaultSQLBackend(
+		1, [port]() -> std::shared_ptr<orm::IDatabaseConnection>
+		{
+			return std::make_shared<orm::postgresql::PostgreSQLConnection>(
+				orm::postgresql::PostgreSQLCredentials{"test", "test", "test", "127.0.0.1", port}
+			);
+		}
+	)
+	{
+	}
+
+	std::vector<std::string> get_table_names(const orm::IDatabaseConnection*) override
+	{
+		return {};
+	}
+
+	[[nodiscard]]
+	inline std::string dbms_name() const override
+	{
+		return "postgresql";
+	}
+};
+
+TEST(TestCase_PostgreSQLConnection, Backend_RunsInitializersAfterReconnect)
+{
+	FakePostgreSQLServer server;
+	TestCase_PostgreSQLConnection_Backend backend(server.port());
+	std::vector<const orm::IDatabaseConnection*> initialized;
+	backend.add_connection_initializer([&initialized](orm::IDatabaseConnection& connection) -> void
+	{
+		initialized.push_back(&connection);
+	});
+	backend.create_pool();
+
+	auto connection = backend.get_connection();
+	std::dynamic_pointer_cast<orm::postgresql::PostgreSQLConnection>(connection)->reset();
+	ASSERT_EQ(initialized, std::vector<const orm::IDatabaseConnection*>({connection.get(), connection.get()}));
+	backend.release_connection(connection);
+}
+
+#endif // USE_POSTGRESQL
@@ -0,0 +1,87 @@
+/**
+ * postgresql/tests_decoder.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#ifdef USE_POSTGRESQL
+
+#include <gtest/gtest.h>
+
+#include "../../src/postgresql/connection.h"
+#include "../../src/db/meta.h"
+
+using namespace xw;
+
+
+// Exposes protected decoding helpers, the connection itself is not
+// created.
+struct TestCase_PostgreSQLDecoder_Connection : public orm::postgresql::PostgreSQLConnection
+{
+	using orm::postgresql::PostgreSQLConnection::TypeOid;
+	using orm::postgresql::PostgreSQLConnection::has_binary_decoder;
+	using orm::postgresql::PostgreSQLConnection::decode_binary;
+};
+
+class TestCase_PostgreSQLDecoder : public ::testing::Test
+{
+protected:
+	using Connection = TestCase_PostgreSQLDecoder_Connection;
+	using TypeOid = Connection::TypeOid;
+
+	// Returns the value read as text like queries in text format do.
+	template <typename FieldT>
+	static FieldT from_text(const char* text)
+	{
+		return orm::db::value_as_field<FieldT>(orm::db::Value(std::string_view(text)));
+	}
+
+	// Returns the value read from big-endian 'bytes' like queries in
+	// binary format do.
+	template <typename FieldT>
+	static FieldT from_binary(uint64_t bytes, int length, Oid type)
+	{
+		char data[8];
+		for (auto i = 0; i < length; i++)
+		{
+			data[i] = (char)(bytes >> (8 * (length - 1 - i)));
+		}
+
+		return orm::db::value_as_field<FieldT>(Connection::decode_binary(data, length, type));
+	}
+};
+
+TEST_F(TestCase_PostgreSQLDecoder, decode_binary_Timestamp_EqualsText)
+{
+	// 2021-05-04 10:20:30.5 in microseconds since 2000-01-01.
+	auto microseconds = (7794LL * 86400 + 10 * 3600 + 20 * 60 + 30) * 1000000 + 500000;
+	ASSERT_TRUE(Connection::has_binary_decoder(TypeOid::Timestamp, true));
+	ASSERT_EQ(
+		from_binary<dt::Datetime>(microseconds, 8, TypeOid::Timestamp),
+		from_text<dt::Datetime>("2021-05-04 10:20:30.5")
+	);
+}
+
+TEST_F(TestCase_PostgreSQLDecoder, decode_binary_Date_EqualsText)
+{
+	ASSERT_EQ(from_binary<dt::Date>(7794, 4, TypeOid::Date), from_text<dt::Date>("2021-05-04"));
+}
+
+TEST_F(TestCase_PostgreSQLDecoder, has_binary_decoder_TimestampTz_IsReadAsText)
+{
+	// Text keeps the time of the session, so it differs from UTC which
+	// is sent in binary format if the session is not in UTC.
+	ASSERT_FALSE(Connection::has_binary_decoder(TypeOid::TimestampTz, true));
+	ASSERT_EQ(
+		from_text<dt::Datetime>("2021-05-04 13:20:30+03"), dt::Datetime(2021, 5, 4, 13, 20, 30)
+	);
+}
+
+TEST_F(TestCase_PostgreSQLDecoder, has_binary_decoder_FloatDatetimes_IsReadAsText)
+{
+	ASSERT_FALSE(Connection::has_binary_decoder(TypeOid::Timestamp, false));
+	ASSERT_FALSE(Connection::has_binary_decoder(TypeOid::Time, false));
+	ASSERT_TRUE(Connection::has_binary_decoder(TypeOid::Date, false));
+}
+
+#endif // USE_POSTGRESQL
@@ -0,0 +1,32 @@
+/**
+ * postgresql/tests_profile.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#ifdef USE_POSTGRESQL
+
+#include <gtest/gtest.h>
+
+#include <xalwart.base/exceptions.h>
+
+#include "../../src/postgresql/profile.h"
+
+using namespace xw;
+
+
+TEST(TestCase_PostgreSQLProfile, statements_QuotesValues)
+{
+	orm::postgresql::Profile profile{{{"synchronous_commit", "off"}, {"search_path", "it's"}}};
+	ASSERT_EQ(profile.statements(), std::vector<std::string>({
+		"SET synchronous_commit TO 'off';", "SET search_path TO 'it''s';"
+	}));
+}
+
+TEST(TestCase_PostgreSQLProfile, from_name_ThrowsUnknownName)
+{
+	ASSERT_EQ(orm::postgresql::Profile::from_name("bulk-load").settings.size(), 3);
+	ASSERT_THROW(orm::postgresql::Profile::from_name("fast"), ValueError);
+}
+
+#endif // USE_POSTGRESQL
@@ -47,6 +47,58 @@ public:
 };
 
 
+// Keeps the asynchronous query until the test completes it.
+class MockedAsyncConnection : public MockedConnection, public orm::IAsyncSQLConnection
+{
+public:
+	mutable std::string sql_query;
+	mutable std::vector<orm::db::Parameter> parameters;
+
+	// All queries which were sent, the last one is 'sql_query'.
+	mutable std::vector<std::string> sql_queries;
+	mutable orm::db::RowHandler row_handler;
+	mutable completion_handler completion;
+
+	inline void run_query_async(
+		const std::string& sql_query,
+		const std::vector<orm::db::Parameter>& parameters,
+		orm::db::RowHandler row_handler,
+		completion_handler completion
+	) const override
+	{
+		this->sql_query = sql_query;
+		this->sql_queries.push_back(sql_query);
+		this->parameters = parameters;
+		this->row_handler = std::move(row_handler);
+		this->completion = std::move(completion);
+	}
+
+	inline void complete(
+		const std::vector<std::map<std::string, orm::db::Value>>& rows, std::exception_ptr error=nullptr
+	) const
+	{
+		for (const auto& row : rows)
+		{
+			std::vector<std::string> names;
+			std::vector<orm::db::Value> values;
+			for (const auto& [name, value] : row)
+			{
+				names.push_back(name);
+				values.push_back(value);
+			}
+
+			orm::db::Columns columns(std::move(names));
+			if (this->row_handler && !this->row_handler(orm::db::Row(columns, values.data())))
+			{
+				break;
+			}
+		}
+
+		auto handler = std::move(this->completion);
+		handler(error);
+	}
+};
+
 class MockedBackend : public orm::DefaultSQLBackend
 {
 public:
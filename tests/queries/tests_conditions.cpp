@@ -19,7 +19,7 @@ public:
 	std::string name;
 	const char* name_c_str;
 
-	inline static const std::tuple meta_columns = {
+	inline static constexpr std::tuple meta_columns = {
 		orm::db::make_pk_column_meta("id", &TestModel::id),
 		orm::db::make_column_meta("name", &TestModel::name),
 		orm::db::make_column_meta("name_c_str", &TestModel::name_c_str)
@@ -45,6 +45,17 @@ TEST(TestCase_Conditions, Ordering_Descending)
 	ASSERT_EQ(expected, (std::string)actual);
 }
 
+TEST(TestCase_Conditions, Ordering_ColumnAtCompileTime)
+{
+	ASSERT_EQ((std::string)orm::q::asc<&TestModel::id>(), R"("test_model"."id" ASC)");
+	ASSERT_EQ((std::string)orm::q::desc<&TestModel::name>(), R"("test_model"."name" DESC)");
+}
+
+TEST(TestCase_Conditions, equals_ColumnAtCompileTime)
+{
+	ASSERT_EQ((std::string)(orm::q::c<&TestModel::id>() == 1), (std::string)(orm::q::c(&TestModel::id) == 1));
+}
+
 TEST(TestCase_Conditions, equals_Fundamental)
 {
 	std::string expected = R"("test_model"."id" = 1)";
@@ -183,6 +194,19 @@ TEST(TestCase_Conditions, between_CString)
 	ASSERT_EQ(expected, (std::string)actual);
 }
 
+TEST(TestCase_Conditions, between_ToSqlWithPlaceholders)
+{
+	std::string expected = R"("test_model"."id" BETWEEN $3 AND $4)";
+	std::vector<orm::db::Parameter> parameters{orm::db::Parameter(), orm::db::Parameter()};
+	auto actual = orm::q::between<long>(&TestModel::id, 1, 5).to_sql(
+		[](size_t index) -> std::string { return "$" + std::to_string(index); }, parameters
+	);
+	ASSERT_EQ(expected, actual);
+	ASSERT_EQ(parameters.size(), 4);
+	ASSERT_EQ(parameters[2], orm::db::Parameter(1LL));
+	ASSERT_EQ(parameters[3], orm::db::Parameter(5LL));
+}
+
 TEST(TestCase_Conditions, like_Default)
 {
 	auto expected = R"("test_model"."id" LIKE '%Wild%')";
@@ -388,3 +412,13 @@ TEST(TestCase_Conditions, cross_join_on_WithAutoGeneratedFk)
 	auto cond = orm::q::cross_on<TestModel, OtherTestModel>();
 	ASSERT_EQ((std::string)cond, expected);
 }
+
+TEST(TestCase_Conditions, Condition_LiteralIsNotSplitIntoParameters)
+{
+	auto cond = orm::q::c(&TestModel::name) == std::string("O'Brien; DROP TABLE test_model");
+	std::vector<orm::db::Parameter> parameters;
+	auto actual = cond.to_sql([](size_t) -> std::string { return "?"; }, parameters);
+	ASSERT_EQ(R"("test_model"."name" = ?)", actual);
+	ASSERT_EQ(parameters.size(), 1);
+	ASSERT_EQ(parameters.front(), orm::db::Parameter(std::string("O'Brien; DROP TABLE test_model")));
+}
@@ -170,3 +170,47 @@ TEST_F(TestCaseF_Q_insert, commit_batch_NoThrow)
 		w.connection(), this->backend->sql_builder()
 	).model(model_1).model(model_2).commit_batch());
 }
+
+class TestCase_Q_insert_CopyingConnection : public MockedConnection, public orm::IBulkCopyConnection
+{
+public:
+	mutable std::string table_name;
+	mutable std::string columns;
+	mutable size_t rows_count = 0;
+
+	inline void copy_rows(
+		const std::string& table_name,
+		const std::string& columns,
+		const std::list<std::vector<orm::db::Parameter>>& rows
+	) const override
+	{
+		this->table_name = table_name;
+		this->columns = columns;
+		this->rows_count = rows.size();
+	}
+};
+
+TEST(TestCase_Q_insert_Copy, commit_batch_UsesCopyStartingFromThreshold)
+{
+	TestCase_Q_insert_CopyingConnection connection;
+	MockedBackend backend;
+	orm::q::Insert<TestCase_Q_insert_TestModel> query(&connection, backend.sql_builder());
+	query.copy_threshold(3).model(TestCase_Q_insert_TestModel()).model(TestCase_Q_insert_TestModel());
+
+	query.commit_batch();
+	ASSERT_EQ(connection.rows_count, 0);
+
+	query.model(TestCase_Q_insert_TestModel()).commit_batch();
+	ASSERT_EQ(connection.table_name, "test_models");
+	ASSERT_EQ(connection.columns, "name");
+	ASSERT_EQ(connection.rows_count, 3);
+}
+
+TEST(TestCase_Q_insert_Copy, commit_batch_CopyIsDisabledByZeroThreshold)
+{
+	TestCase_Q_insert_CopyingConnection connection;
+	MockedBackend backend;
+	orm::q::Insert<TestCase_Q_insert_TestModel> query(&connection, backend.sql_builder());
+	query.copy_threshold(0).model(TestCase_Q_insert_TestModel()).commit_batch();
+	ASSERT_EQ(connection.rows_count, 0);
+}
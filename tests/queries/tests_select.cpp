@@ -8,6 +8,7 @@
 
 #include "./mocked_backend.h"
 #include "../../src/queries/select.h"
+#include "../../src/sql_builder.h"
 
 using namespace xw;
 
@@ -140,3 +141,76 @@ TEST_F(TestCase_Q_select, having_NoThrow_MultipleCalls)
 	ASSERT_NO_THROW(this->query->having(orm::q::c(&TestCase_Q_TestModel::id) == 1)
 		.having(orm::q::c(&TestCase_Q_TestModel::name) == "John"));
 }
+
+TEST_F(TestCase_Q_select, all_async_IsRunSynchronouslyWithoutAsyncConnection)
+{
+	auto future = this->query->all_async();
+	ASSERT_EQ(future.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+	ASSERT_TRUE(future.get().empty());
+}
+
+TEST(TestCase_Q_select_Async, all_async_ResolvesFutureOnCompletion)
+{
+	MockedBackend backend;
+	MockedAsyncConnection connection;
+	auto future = orm::q::Select<TestCase_Q_TestModel>(&connection, backend.sql_builder())
+		.where(orm::q::c(&TestCase_Q_TestModel::id) > 1).all_async();
+	ASSERT_EQ(
+		connection.sql_query,
+		R"(SELECT "test_model"."id" AS "id", "test_model"."name" AS "name" FROM "test_model" WHERE "test_model"."id" > ?;)"
+	);
+	ASSERT_EQ(connection.parameters.size(), 1);
+	ASSERT_EQ(future.wait_for(std::chrono::seconds(0)), std::future_status::timeout);
+
+	connection.complete({
+		{{"id", orm::db::Value(std::string_view("2"))}, {"name", orm::db::Value(std::string_view("Steve"))}}
+	});
+	auto models = future.get();
+	ASSERT_EQ(models.size(), 1);
+	ASSERT_EQ(models.front().id, 2);
+	ASSERT_EQ(models.front().name, "Steve");
+}
+
+TEST(TestCase_Q_select_Async, all_async_PassesError)
+{
+	MockedBackend backend;
+	MockedAsyncConnection connection;
+	std::exception_ptr error;
+	orm::q::Select<TestCase_Q_TestModel>(&connection, backend.sql_builder()).all_async(
+		[&error](std::list<TestCase_Q_TestModel> /* models */, std::exception_ptr e) { error = e; }
+	);
+	connection.complete({}, std::make_exception_ptr(orm::SQLError("failed", _ERROR_DETAILS_)));
+	ASSERT_THROW(std::rethrow_exception(error), orm::SQLError);
+}
+
+class TestCase_Q_select_StarSQLBuilder : public orm::DefaultSQLBuilder
+{
+public:
+	[[nodiscard]]
+	inline std::string sql_select_columns(
+		const std::string& /* table_name */, const std::list<std::string>& /* columns */
+	) const override
+	{
+		return "*";
+	}
+};
+
+TEST(TestCase_Q_select_Columns, to_sql_CachesColumnsPerTypeOfBuilder)
+{
+	MockedBackend backend;
+	MockedConnection connection;
+	TestCase_Q_select_StarSQLBuilder star_builder;
+	auto select_default = [&]() -> std::string {
+		return orm::q::Select<TestCase_Q_TestModel>(&connection, backend.sql_builder()).to_sql();
+	};
+	auto select_star = [&]() -> std::string {
+		return orm::q::Select<TestCase_Q_TestModel>(&connection, &star_builder).to_sql();
+	};
+
+	auto expected_default = R"(SELECT "test_model"."id" AS "id", "test_model"."name" AS "name" FROM "test_model";)";
+	auto expected_star = R"(SELECT * FROM "test_model";)";
+	ASSERT_EQ(select_default(), expected_default);
+	ASSERT_EQ(select_star(), expected_star);
+	ASSERT_EQ(select_default(), expected_default);
+	ASSERT_EQ(select_star(), expected_star);
+}
@@ -122,3 +122,71 @@ TEST_F(TestCaseF_Q_update, commit_batch_NoThrow)
 		this->conn.get(), this->backend->sql_builder()
 	).model(model_1).model(model_2).commit_batch());
 }
+
+TEST_F(TestCaseF_Q_update, commit_batch_async_SendsStatementsInTransaction)
+{
+	TestCase_Q_update_TestModel model_1;
+	model_1.id = 1;
+	model_1.name = "John";
+
+	TestCase_Q_update_TestModel model_2;
+	model_2.id = 2;
+	model_2.name = "Steve";
+
+	MockedAsyncConnection connection;
+	auto future = orm::q::Update<TestCase_Q_update_TestModel>(&connection, this->backend->sql_builder())
+		.model(model_1).model(model_2).commit_batch_async();
+	ASSERT_EQ(connection.sql_query, "BEGIN;");
+
+	connection.complete({});
+	ASSERT_EQ(connection.parameters.size(), 2);
+	ASSERT_EQ(std::get<std::string>(connection.parameters.front().value), "John");
+	auto statement_sql = connection.sql_query;
+
+	connection.complete({});
+	ASSERT_EQ(connection.sql_query, statement_sql);
+	ASSERT_EQ(std::get<std::string>(connection.parameters.front().value), "Steve");
+
+	connection.complete({});
+	ASSERT_EQ(connection.sql_query, "COMMIT;");
+	ASSERT_EQ(future.wait_for(std::chrono::seconds(0)), std::future_status::timeout);
+
+	connection.complete({});
+	ASSERT_NO_THROW(future.get());
+	ASSERT_EQ(connection.sql_queries.size(), 4);
+}
+
+TEST_F(TestCaseF_Q_update, commit_batch_async_RollsBackOnError)
+{
+	TestCase_Q_update_TestModel model_1;
+	model_1.id = 1;
+
+	TestCase_Q_update_TestModel model_2;
+	model_2.id = 2;
+
+	MockedAsyncConnection connection;
+	auto future = orm::q::Update<TestCase_Q_update_TestModel>(&connection, this->backend->sql_builder())
+		.model(model_1).model(model_2).commit_batch_async();
+	connection.complete({});
+	connection.complete({}, std::make_exception_ptr(orm::SQLError("failed", _ERROR_DETAILS_)));
+	ASSERT_EQ(connection.sql_query, "ROLLBACK;");
+
+	connection.complete({});
+	ASSERT_THROW(future.get(), orm::SQLError);
+	ASSERT_EQ(connection.sql_queries.size(), 3);
+}
+
+TEST_F(TestCaseF_Q_update, commit_batch_async_DoesNotBeginTransactionInTransaction)
+{
+	TestCase_Q_update_TestModel model;
+	model.id = 1;
+
+	MockedAsyncConnection connection;
+	auto future = orm::q::Update<TestCase_Q_update_TestModel>(&connection, this->backend->sql_builder(), true)
+		.model(model).commit_batch_async();
+	ASSERT_EQ(connection.parameters.size(), 2);
+
+	connection.complete({});
+	ASSERT_NO_THROW(future.get());
+	ASSERT_EQ(connection.sql_queries.size(), 1);
+}
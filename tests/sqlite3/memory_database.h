@@ -0,0 +1,81 @@
+/**
+ * sqlite3/memory_database.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#pragma once
+
+#ifdef USE_SQLITE3
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../../src/sqlite3/connection.h"
+#include "../../src/sql_builder.h"
+#include "../../src/queries/select.h"
+
+using namespace xw;
+
+
+struct SQLite3MemoryDatabase_Model : public orm::db::Model
+{
+	static constexpr const char* meta_table_name = "test_models";
+
+	int id{};
+	std::string name;
+	int age{};
+
+	inline static const std::tuple meta_columns = {
+		orm::db::make_pk_column_meta("id", &SQLite3MemoryDatabase_Model::id),
+		orm::db::make_column_meta("name", &SQLite3MemoryDatabase_Model::name),
+		orm::db::make_column_meta("age", &SQLite3MemoryDatabase_Model::age)
+	};
+
+	inline void __orm_set_column__(const std::string& column_name, const char* data) override
+	{
+		this->__orm_set_column_data__(SQLite3MemoryDatabase_Model::meta_columns, column_name, data);
+	}
+};
+
+// Creates the in-memory database with the table of 'Model' which
+// contains three rows: (1, 'John', 17), (2, NULL, 25), (3, 'Bob', 40).
+class SQLite3MemoryDatabase : public ::testing::Test
+{
+protected:
+	using Model = SQLite3MemoryDatabase_Model;
+
+	std::unique_ptr<orm::sqlite3::SQLite3Connection> connection;
+	orm::DefaultSQLBuilder builder;
+
+	void SetUp() override
+	{
+		this->connection = std::make_unique<orm::sqlite3::SQLite3Connection>(":memory:");
+		this->connection->run_query(
+			"CREATE TABLE test_models (id INTEGER PRIMARY KEY, name TEXT, age INTEGER);"
+			"INSERT INTO test_models VALUES (1, 'John', 17), (2, NULL, 25), (3, 'Bob', 40);",
+			nullptr, nullptr
+		);
+	}
+
+	[[nodiscard]]
+	orm::q::Select<Model> select()
+	{
+		return orm::q::Select<Model>(this->connection.get(), &this->builder);
+	}
+
+	template <typename ContainerT>
+	static std::vector<int> ids_of(const ContainerT& models)
+	{
+		std::vector<int> ids;
+		for (const auto& model : models)
+		{
+			ids.push_back(model.id);
+		}
+
+		return ids;
+	}
+};
+
+#endif // USE_SQLITE3
@@ -0,0 +1,103 @@
+/**
+ * sqlite3/tests_backend.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#ifdef USE_SQLITE3
+
+#include <cstdio>
+
+#include <gtest/gtest.h>
+
+#include "../../src/sqlite3/backend.h"
+#include "../../src/repository.h"
+#include "./memory_database.h"
+
+
+// Creates the database file in WAL mode with the table of 'Model'
+// and removes its files after the test.
+class TestCase_SQLite3WalBackend : public ::testing::Test
+{
+protected:
+	using Model = SQLite3MemoryDatabase_Model;
+
+	std::string filename = testing::TempDir() + "xw_orm_sqlite3_wal.db";
+	std::unique_ptr<orm::sqlite3::Backend> backend;
+
+	void SetUp() override
+	{
+		this->remove_files();
+		this->backend = std::make_unique<orm::sqlite3::Backend>(2, this->filename.c_str(), 32, true);
+		this->backend->create_pool();
+		auto connection = this->backend->get_connection();
+		connection->run_query(
+			"CREATE TABLE test_models (id INTEGER PRIMARY KEY, name TEXT, age INTEGER);", nullptr, nullptr
+		);
+		this->backend->release_connection(connection);
+	}
+
+	void TearDown() override
+	{
+		this->backend = nullptr;
+		this->remove_files();
+	}
+
+	void remove_files() const
+	{
+		std::remove(this->filename.c_str());
+		std::remove((this->filename + "-wal").c_str());
+		std::remove((this->filename + "-shm").c_str());
+	}
+
+	static Model make_model(const std::string& name, int age)
+	{
+		Model model;
+		model.name = name;
+		model.age = age;
+		return model;
+	}
+};
+
+TEST_F(TestCase_SQLite3WalBackend, Repository_WritesThroughWriter)
+{
+	orm::Repository repository(this->backend.get());
+	repository.insert<Model>().model(make_model("John", 17)).commit_one();
+	repository.insert<Model>().model(make_model("Bob", 40)).commit_one();
+	repository.free_connection();
+
+	auto models = repository.select<Model>().order_by({orm::q::asc(&Model::id)}).all();
+	ASSERT_EQ(models.size(), 2);
+	ASSERT_EQ(models.front().name, "John");
+	ASSERT_EQ(this->backend->read_pool_metrics().used_connections_count, 1);
+	ASSERT_EQ(this->backend->pool_metrics().used_connections_count, 0);
+
+	// The read-only connection rejects writes.
+	ASSERT_NO_THROW(repository.select<Model>().where(orm::q::c(&Model::age) > 20).delete_());
+	ASSERT_EQ(this->backend->pool_metrics().used_connections_count, 1);
+	repository.free_connection();
+
+	models = repository.select<Model>().all();
+	ASSERT_EQ(models.size(), 1);
+	ASSERT_EQ(models.front().name, "John");
+}
+
+TEST_F(TestCase_SQLite3WalBackend, Repository_ReadsThroughWriterInTransaction)
+{
+	orm::Repository repository(this->backend.get());
+	repository.insert<Model>().model(make_model("John", 17)).commit_one();
+	repository.free_connection();
+
+	size_t count = 0;
+	repository.transaction([&](orm::Transaction& transaction)
+	{
+		transaction.insert<Model>().model(make_model("Bob", 40)).commit_one();
+		count = repository.select<Model>().count();
+	});
+
+	// The transaction is rolled back.
+	ASSERT_EQ(count, 2);
+	ASSERT_EQ(repository.select<Model>().count(), 1);
+}
+
+#endif // USE_SQLITE3
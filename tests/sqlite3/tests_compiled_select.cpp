@@ -0,0 +1,68 @@
+/**
+ * sqlite3/tests_compiled_select.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#ifdef USE_SQLITE3
+
+#include "./memory_database.h"
+
+
+class TestCase_CompiledSelect : public SQLite3MemoryDatabase
+{
+};
+
+TEST_F(TestCase_CompiledSelect, compile_KeepsPlaceholdersAndValues)
+{
+	auto select = this->select().where(orm::q::c(&Model::age) >= 18);
+	auto query = select.compile();
+	ASSERT_NE(query.sql().find("?"), std::string::npos);
+	ASSERT_EQ(query.sql().find("18"), std::string::npos);
+	ASSERT_NE(select.to_sql().find("18"), std::string::npos);
+	ASSERT_EQ(query.parameters().size(), 1);
+	ASSERT_EQ(std::get<long long>(query.parameters().front().value), 18);
+}
+
+TEST_F(TestCase_CompiledSelect, all_RunsWithCompiledValues)
+{
+	auto query = this->select().where(orm::q::c(&Model::age) >= 18).order_by({orm::q::asc(&Model::id)}).compile();
+	auto models = query.all(this->connection.get());
+	ASSERT_EQ(ids_of(models), std::vector<int>({2, 3}));
+	ASSERT_EQ(models.back().name, "Bob");
+}
+
+TEST_F(TestCase_CompiledSelect, all_RunsWithNewValues)
+{
+	auto query = this->select().where(orm::q::c(&Model::age) >= 18).order_by({orm::q::asc(&Model::id)}).compile();
+
+	auto models = query.all(this->connection.get(), {orm::db::Parameter(30LL)});
+	ASSERT_EQ(models.size(), 1);
+	ASSERT_EQ(models.front().name, "Bob");
+	ASSERT_EQ(models.front().age, 40);
+
+	models = query.all(this->connection.get(), {orm::db::Parameter(0LL)});
+	ASSERT_EQ(ids_of(models), std::vector<int>({1, 2, 3}));
+	ASSERT_EQ(models.front().name, "John");
+}
+
+TEST_F(TestCase_CompiledSelect, for_each_StopsOnFalse)
+{
+	auto query = this->select().where(orm::q::c(&Model::age) >= 18).compile();
+	size_t count = 0;
+	query.for_each(this->connection.get(), {orm::db::Parameter(0LL)}, [&count](Model&) -> bool {
+		count++;
+		return false;
+	});
+	ASSERT_EQ(count, 1);
+}
+
+TEST_F(TestCase_CompiledSelect, all_ThrowsParametersCountMismatch)
+{
+	auto query = this->select().where(orm::q::c(&Model::age) >= 18).compile();
+	ASSERT_THROW(
+		(void)query.all(this->connection.get(), {orm::db::Parameter(1LL), orm::db::Parameter(2LL)}), orm::QueryError
+	);
+}
+
+#endif // USE_SQLITE3
@@ -0,0 +1,50 @@
+/**
+ * sqlite3/tests_connection.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#ifdef USE_SQLITE3
+
+#include "./memory_database.h"
+
+
+class TestCase_SQLite3Connection : public SQLite3MemoryDatabase
+{
+};
+
+TEST_F(TestCase_SQLite3Connection, run_query_ReusesCachedStatement)
+{
+	auto hits = this->connection->statements_cache_hits();
+	auto misses = this->connection->statements_cache_misses();
+	std::vector<std::string> names;
+	auto handler = [&names](const std::map<std::string, char*>& columns) -> void
+	{
+		names.emplace_back(columns.at("name"));
+	};
+
+	const std::string query = "SELECT name FROM test_models WHERE id = ?;";
+	this->connection->run_query(query, {orm::db::Parameter(1LL)}, handler, nullptr);
+	ASSERT_EQ(this->connection->statements_cache_misses(), misses + 1);
+	ASSERT_EQ(this->connection->statements_cache_hits(), hits);
+
+	this->connection->run_query(query, {orm::db::Parameter(3LL)}, handler, nullptr);
+	ASSERT_EQ(this->connection->statements_cache_misses(), misses + 1);
+	ASSERT_EQ(this->connection->statements_cache_hits(), hits + 1);
+
+	ASSERT_EQ(names, std::vector<std::string>({"John", "Bob"}));
+}
+
+TEST_F(TestCase_SQLite3Connection, run_query_DoesNotCacheMultipleStatements)
+{
+	auto hits = this->connection->statements_cache_hits();
+	auto misses = this->connection->statements_cache_misses();
+
+	const std::string query = "SELECT 1; SELECT 2;";
+	this->connection->run_query(query, nullptr, nullptr);
+	this->connection->run_query(query, nullptr, nullptr);
+	ASSERT_EQ(this->connection->statements_cache_misses(), misses + 2);
+	ASSERT_EQ(this->connection->statements_cache_hits(), hits);
+}
+
+#endif // USE_SQLITE3
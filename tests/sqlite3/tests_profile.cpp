@@ -0,0 +1,78 @@
+/**
+ * sqlite3/tests_profile.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#ifdef USE_SQLITE3
+
+#include <cstdio>
+
+#include <gtest/gtest.h>
+
+#include "../../src/sqlite3/backend.h"
+
+using namespace xw;
+
+
+TEST(TestCase_SQLite3Profile, pragmas_ReturnsSetValues)
+{
+	orm::sqlite3::Profile profile;
+	profile.journal_mode = "WAL";
+	profile.cache_size = -2000;
+	profile.busy_timeout = std::chrono::milliseconds(100);
+	ASSERT_EQ(profile.pragmas(), std::vector<std::string>({
+		"PRAGMA journal_mode = WAL;", "PRAGMA cache_size = -2000;", "PRAGMA busy_timeout = 100;"
+	}));
+}
+
+TEST(TestCase_SQLite3Profile, pragmas_SkipsJournalModeForReadOnly)
+{
+	auto pragmas = orm::sqlite3::Profile::fast_wal().pragmas(true);
+	ASSERT_FALSE(pragmas.empty());
+	for (const auto& pragma : pragmas)
+	{
+		ASSERT_EQ(pragma.find("journal_mode"), std::string::npos);
+	}
+}
+
+TEST(TestCase_SQLite3Profile, from_name_ThrowsUnknownName)
+{
+	ASSERT_NO_THROW(orm::sqlite3::Profile::from_name("durable"));
+	ASSERT_NO_THROW(orm::sqlite3::Profile::from_name("fast-wal"));
+	ASSERT_NO_THROW(orm::sqlite3::Profile::from_name("bulk-load"));
+	ASSERT_THROW(orm::sqlite3::Profile::from_name("fast"), ValueError);
+}
+
+TEST(TestCase_SQLite3Profile, use_profile_AppliesPragmasToConnections)
+{
+	auto filename = testing::TempDir() + "xw_orm_sqlite3_profile.db";
+	std::remove(filename.c_str());
+	{
+		orm::sqlite3::Backend backend(1, filename.c_str());
+		backend.use_profile(orm::sqlite3::Profile::fast_wal());
+		backend.create_pool();
+
+		auto connection = backend.get_connection();
+		std::string journal_mode, synchronous;
+		connection->run_query("PRAGMA journal_mode;", nullptr, [&](const std::vector<char*>& data)
+		{
+			journal_mode = data[0];
+		});
+		connection->run_query("PRAGMA synchronous;", nullptr, [&](const std::vector<char*>& data)
+		{
+			synchronous = data[0];
+		});
+		backend.release_connection(connection);
+		ASSERT_EQ(journal_mode, "wal");
+
+		// NORMAL
+		ASSERT_EQ(synchronous, "1");
+	}
+
+	std::remove(filename.c_str());
+	std::remove((filename + "-wal").c_str());
+	std::remove((filename + "-shm").c_str());
+}
+
+#endif // USE_SQLITE3
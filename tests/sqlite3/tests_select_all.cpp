@@ -0,0 +1,54 @@
+/**
+ * sqlite3/tests_select_all.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#ifdef USE_SQLITE3
+
+#include <deque>
+
+#include "./memory_database.h"
+
+
+class TestCase_SelectAll : public SQLite3MemoryDatabase
+{
+};
+
+TEST_F(TestCase_SelectAll, all_vector_ReturnsAllModels)
+{
+	auto models = this->select().order_by({orm::q::asc(&Model::id)}).all_vector();
+	ASSERT_EQ(ids_of(models), std::vector<int>({1, 2, 3}));
+	ASSERT_EQ(models[2].name, "Bob");
+}
+
+TEST_F(TestCase_SelectAll, all_vector_ReservesLimit)
+{
+	auto models = this->select().order_by({orm::q::asc(&Model::id)}).limit(2).all_vector();
+	ASSERT_EQ(ids_of(models), std::vector<int>({1, 2}));
+	ASSERT_GE(models.capacity(), 2);
+}
+
+TEST_F(TestCase_SelectAll, all_vector_CapsReservationForLargeLimit)
+{
+	auto models = this->select().limit(1000000).all_vector();
+	ASSERT_EQ(models.size(), 3);
+	ASSERT_LE(models.capacity(), orm::q::Select<Model>::MAX_RESERVED_MODELS);
+}
+
+TEST_F(TestCase_SelectAll, all_vector_AllocatesFromResource)
+{
+	std::pmr::monotonic_buffer_resource arena;
+	auto models = this->select().order_by({orm::q::asc(&Model::id)}).all_vector(&arena);
+	ASSERT_EQ(models.get_allocator().resource(), &arena);
+	ASSERT_EQ(ids_of(models), std::vector<int>({1, 2, 3}));
+}
+
+TEST_F(TestCase_SelectAll, all_into_AppendsToContainer)
+{
+	std::deque<Model> models(1);
+	this->select().where(orm::q::c(&Model::id) > 1).order_by({orm::q::asc(&Model::id)}).all_into(models);
+	ASSERT_EQ(ids_of(models), std::vector<int>({0, 2, 3}));
+}
+
+#endif // USE_SQLITE3
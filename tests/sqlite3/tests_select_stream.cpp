@@ -0,0 +1,111 @@
+/**
+ * sqlite3/tests_select_stream.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#ifdef USE_SQLITE3
+
+#include "./memory_database.h"
+
+
+class TestCase_SelectStream : public SQLite3MemoryDatabase
+{
+};
+
+TEST_F(TestCase_SelectStream, stream_ReadsAllRows)
+{
+	std::vector<std::pair<int, std::string>> rows;
+	for (auto& model : this->select().order_by({orm::q::asc(&Model::id)}).stream())
+	{
+		rows.emplace_back(model.id, model.name);
+	}
+
+	// NULL of the second row does not keep the name of the first one.
+	ASSERT_EQ(rows, (std::vector<std::pair<int, std::string>>{{1, "John"}, {2, ""}, {3, "Bob"}}));
+}
+
+TEST_F(TestCase_SelectStream, stream_BindsParameters)
+{
+	std::vector<int> ids;
+	for (auto& model : this->select().where(orm::q::c(&Model::id) > 1).order_by({orm::q::asc(&Model::id)}).stream())
+	{
+		ids.push_back(model.id);
+	}
+
+	ASSERT_EQ(ids, std::vector<int>({2, 3}));
+}
+
+TEST_F(TestCase_SelectStream, stream_EmptyResult)
+{
+	auto stream = this->select().where(orm::q::c(&Model::id) > 10).stream();
+	ASSERT_EQ(stream.begin(), stream.end());
+}
+
+TEST_F(TestCase_SelectStream, stream_StopsEarlyAndReleasesConnection)
+{
+	size_t count = 0;
+	for ([[maybe_unused]] auto& model : this->select().stream())
+	{
+		count++;
+		break;
+	}
+
+	ASSERT_EQ(count, 1);
+
+	// Statement is reset, so the same query is run from the start.
+	ASSERT_EQ(this->select().all().size(), 3);
+	count = 0;
+	for ([[maybe_unused]] auto& model : this->select().stream())
+	{
+		count++;
+	}
+
+	ASSERT_EQ(count, 3);
+}
+
+TEST_F(TestCase_SelectStream, for_each_ReadsAllRows)
+{
+	std::vector<int> ids;
+	this->select().where(orm::q::c(&Model::id) > 1).order_by({orm::q::asc(&Model::id)})
+		.for_each([&ids](Model& model) -> bool
+		{
+			ids.push_back(model.id);
+			return true;
+		});
+
+	ASSERT_EQ(ids, std::vector<int>({2, 3}));
+}
+
+TEST_F(TestCase_SelectStream, for_each_StopsEarly)
+{
+	std::vector<int> ids;
+	this->select().order_by({orm::q::asc(&Model::id)}).for_each([&ids](Model& model) -> bool
+	{
+		ids.push_back(model.id);
+		return ids.size() < 2;
+	});
+
+	ASSERT_EQ(ids, std::vector<int>({1, 2}));
+}
+
+TEST_F(TestCase_SelectStream, open_cursor_ThrowsMultipleStatements)
+{
+	ASSERT_THROW(
+		(void)this->connection->open_cursor("SELECT 1; SELECT 2;", {}), orm::QueryError
+	);
+}
+
+TEST_F(TestCase_SelectStream, compiled_stream_ReadsRows)
+{
+	auto query = this->select().where(orm::q::c(&Model::id) >= 1).order_by({orm::q::asc(&Model::id)}).compile();
+	std::vector<int> ids;
+	for (auto& model : query.stream(this->connection.get(), {orm::db::Parameter(3LL)}))
+	{
+		ids.push_back(model.id);
+	}
+
+	ASSERT_EQ(ids, std::vector<int>({3}));
+}
+
+#endif // USE_SQLITE3
@@ -0,0 +1,56 @@
+/**
+ * sqlite3/tests_typed_query.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#ifdef USE_SQLITE3
+
+#include <gtest/gtest.h>
+
+#include "../../src/sqlite3/connection.h"
+#include "../../src/db/model.h"
+
+using namespace xw;
+
+
+struct TestCase_SQLite3TypedQuery_Model : public orm::db::Model
+{
+	static constexpr const char* meta_table_name = "typed_query_models";
+
+	int id{};
+	std::string name;
+
+	inline static const std::tuple meta_columns = {
+		orm::db::make_pk_column_meta("id", &TestCase_SQLite3TypedQuery_Model::id),
+		orm::db::make_column_meta("name", &TestCase_SQLite3TypedQuery_Model::name)
+	};
+
+	inline void __orm_set_column__(const std::string& column_name, const char* data) override
+	{
+		this->__orm_set_column_data__(TestCase_SQLite3TypedQuery_Model::meta_columns, column_name, data);
+	}
+};
+
+TEST(TestCase_SQLite3TypedQuery, run_typed_query_RebindsHydratorForEachStatement)
+{
+	using Model = TestCase_SQLite3TypedQuery_Model;
+	orm::sqlite3::SQLite3Connection connection(":memory:");
+	orm::db::RowHydrator<Model> hydrate;
+	std::vector<Model> models;
+	connection.run_typed_query(
+		"SELECT 1 AS id, 'John' AS name; SELECT 'Bob' AS name;", {},
+		[&models, &hydrate](const orm::db::Row& row) -> bool {
+			hydrate(models.emplace_back(), row);
+			return true;
+		}
+	);
+
+	ASSERT_EQ(models.size(), 2);
+	ASSERT_EQ(models[0].id, 1);
+	ASSERT_EQ(models[0].name, "John");
+	ASSERT_EQ(models[1].id, 0);
+	ASSERT_EQ(models[1].name, "Bob");
+}
+
+#endif // USE_SQLITE3
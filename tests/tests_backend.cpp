@@ -0,0 +1,555 @@
+/**
+ * tests_backend.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <mutex>
+#include <optional>
+
+#include <gtest/gtest.h>
+
+#include "../src/backend.h"
+#include "../src/repository.h"
+#include "./queries/mocked_backend.h"
+
+using namespace xw;
+
+
+class TestCase_PoolBackend : public orm::DefaultSQLBackend
+{
+public:
+	std::atomic<size_t> opened = 0;
+	std::atomic<bool> is_failing = false;
+
+	explicit TestCase_PoolBackend(const orm::PoolOptions& options) : orm::DefaultSQLBackend(
+		options, [this]() -> std::shared_ptr<orm::IDatabaseConnection>
+		{
+			if (this->is_failing)
+			{
+				throw orm::DatabaseError("connection failed", _ERROR_DETAILS_);
+			}
+
+			this->opened++;
+			return std::make_shared<MockedConnection>();
+		}
+	)
+	{
+	}
+
+	std::vector<std::string> get_table_names(const orm::IDatabaseConnection*) override
+	{
+		return {};
+	}
+
+	[[nodiscard]]
+	inline std::string dbms_name() const override
+	{
+		return "PoolBackend";
+	}
+};
+
+TEST(TestCase_DefaultSQLBackend, constructor_ThrowsMinGreaterThanMax)
+{
+	orm::PoolOptions options;
+	options.min_connections = 2;
+	options.max_connections = 1;
+	ASSERT_THROW(TestCase_PoolBackend backend(options), ValueError);
+}
+
+TEST(TestCase_DefaultSQLBackend, create_pool_OpensMinConnections)
+{
+	orm::PoolOptions options;
+	options.min_connections = 1;
+	options.max_connections = 3;
+	TestCase_PoolBackend backend(options);
+	backend.create_pool();
+	ASSERT_EQ(backend.opened.load(), 1);
+	ASSERT_EQ(backend.idle_connections_count(), 1);
+}
+
+TEST(TestCase_DefaultSQLBackend, get_connection_OpensConnectionsLazily)
+{
+	orm::PoolOptions options;
+	options.min_connections = 0;
+	options.max_connections = 2;
+	TestCase_PoolBackend backend(options);
+	backend.create_pool();
+	ASSERT_EQ(backend.opened.load(), 0);
+
+	auto first = backend.get_connection();
+	auto second = backend.get_connection();
+	ASSERT_EQ(backend.opened.load(), 2);
+	ASSERT_NE(first, second);
+
+	backend.release_connection(first);
+	ASSERT_EQ(backend.get_connection(), first);
+	ASSERT_EQ(backend.opened.load(), 2);
+}
+
+TEST(TestCase_DefaultSQLBackend, get_connection_ThrowsTimeout)
+{
+	TestCase_PoolBackend backend(1);
+	backend.create_pool();
+	auto connection = backend.get_connection();
+	ASSERT_THROW(backend.get_connection(std::chrono::milliseconds(10)), orm::PoolTimeoutError);
+
+	backend.release_connection(connection);
+	ASSERT_EQ(backend.get_connection(std::chrono::milliseconds(0)), connection);
+}
+
+TEST(TestCase_DefaultSQLBackend, get_connection_UsesAcquireTimeout)
+{
+	orm::PoolOptions options;
+	options.acquire_timeout = std::chrono::milliseconds(0);
+	TestCase_PoolBackend backend(options);
+	backend.create_pool();
+	auto connection = backend.get_connection();
+	ASSERT_THROW(backend.get_connection(), orm::PoolTimeoutError);
+}
+
+TEST(TestCase_DefaultSQLBackend, get_connection_async_DoesNotCountTimeoutWhenWaiting)
+{
+	TestCase_PoolBackend backend(1);
+	backend.create_pool();
+	auto connection = backend.get_connection();
+	std::shared_ptr<orm::IDatabaseConnection> received;
+	backend.get_connection_async([&received](auto provided, std::exception_ptr) { received = provided; });
+	ASSERT_EQ(received, nullptr);
+	ASSERT_EQ(backend.pool_metrics().timeouts_count, 0);
+
+	backend.release_connection(connection);
+	ASSERT_EQ(received, connection);
+	ASSERT_EQ(backend.pool_metrics().timeouts_count, 0);
+}
+
+TEST(TestCase_ShardedConnectionPool, try_acquire_ReturnsNullptrWhenExhausted)
+{
+	orm::PoolOptions options;
+	options.max_connections = 1;
+	orm::ShardedConnectionPool pool(options, []() { return std::make_shared<MockedConnection>(); });
+	pool.create();
+	auto connection = pool.try_acquire();
+	ASSERT_NE(connection, nullptr);
+	ASSERT_EQ(pool.try_acquire(), nullptr);
+	ASSERT_EQ(pool.metrics().timeouts_count, 0);
+
+	pool.release(connection);
+	ASSERT_EQ(pool.try_acquire(), connection);
+}
+
+TEST(TestCase_ShardedConnectionPool, try_acquire_FindsConnectionDuringEviction)
+{
+	orm::PoolOptions options;
+	options.max_connections = 1;
+	options.idle_timeout = std::chrono::hours(1);
+	orm::ShardedConnectionPool pool(options, []() { return std::make_shared<MockedConnection>(); });
+	pool.create();
+	pool.release(pool.try_acquire());
+
+	std::atomic<bool> is_stopped = false;
+	std::thread evicting_thread([&pool, &is_stopped]()
+	{
+		while (!is_stopped)
+		{
+			pool.evict_idle_connections();
+		}
+	});
+
+	size_t missed_count = 0;
+	for (size_t i = 0; i < 10000; i++)
+	{
+		auto connection = pool.try_acquire();
+		if (connection)
+		{
+			pool.release(connection);
+		}
+		else
+		{
+			missed_count++;
+		}
+	}
+
+	is_stopped = true;
+	evicting_thread.join();
+	ASSERT_EQ(missed_count, 0);
+	ASSERT_EQ(pool.connections_count(), 1);
+}
+
+TEST(TestCase_DefaultSQLBackend, evict_idle_connections_KeepsMinConnections)
+{
+	orm::PoolOptions options;
+	options.min_connections = 1;
+	options.max_connections = 3;
+	options.idle_timeout = std::chrono::milliseconds(0);
+	TestCase_PoolBackend backend(options);
+	backend.create_pool();
+	auto first = backend.get_connection();
+	auto second = backend.get_connection();
+	auto third = backend.get_connection();
+	ASSERT_EQ(backend.connections_count(), 3);
+
+	backend.release_connection(first);
+	backend.release_connection(second);
+	backend.release_connection(third);
+	std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	backend.evict_idle_connections();
+	ASSERT_EQ(backend.connections_count(), 1);
+	ASSERT_EQ(backend.idle_connections_count(), 1);
+}
+
+TEST(TestCase_DefaultSQLBackend, get_read_connection_UsesMainPoolWithoutReadPool)
+{
+	TestCase_PoolBackend backend(1);
+	backend.create_pool();
+	ASSERT_FALSE(backend.has_read_pool());
+
+	auto connection = backend.get_read_connection();
+	ASSERT_EQ(backend.idle_connections_count(), 0);
+
+	backend.release_read_connection(connection);
+	ASSERT_EQ(backend.get_connection(std::chrono::milliseconds(0)), connection);
+}
+
+TEST(TestCase_DefaultSQLBackend, get_read_connection_UsesReadPool)
+{
+	std::atomic<size_t> opened_readers = 0;
+	TestCase_PoolBackend backend(1);
+	backend.set_read_pool(2, [&opened_readers]() -> std::shared_ptr<orm::IDatabaseConnection>
+	{
+		opened_readers++;
+		return std::make_shared<MockedConnection>();
+	});
+	backend.create_pool();
+	ASSERT_TRUE(backend.has_read_pool());
+	ASSERT_EQ(backend.opened.load(), 1);
+	ASSERT_EQ(opened_readers.load(), 2);
+
+	auto writer = backend.get_connection();
+	auto first = backend.get_read_connection();
+	auto second = backend.get_read_connection();
+	ASSERT_NE(first, writer);
+	ASSERT_NE(second, writer);
+	ASSERT_EQ(backend.read_pool_metrics().used_connections_count, 2);
+	ASSERT_EQ(backend.pool_metrics().used_connections_count, 1);
+
+	backend.release_read_connection(first);
+	backend.release_read_connection(second);
+	backend.release_connection(writer);
+	ASSERT_EQ(backend.read_pool_metrics().idle_connections_count, 2);
+	ASSERT_EQ(backend.idle_connections_count(), 1);
+}
+
+TEST(TestCase_DefaultSQLBackend, set_read_pool_ThrowsInvalidBounds)
+{
+	TestCase_PoolBackend backend(1);
+	orm::PoolOptions options;
+	options.min_connections = 2;
+	options.max_connections = 1;
+	ASSERT_THROW(backend.set_read_pool(options, []() { return std::make_shared<MockedConnection>(); }), ValueError);
+	ASSERT_FALSE(backend.has_read_pool());
+}
+
+TEST(TestCase_DefaultSQLBackend, add_connection_initializer_InitializesConnectionsOfBothPools)
+{
+	std::vector<std::string> calls;
+	TestCase_PoolBackend backend(1);
+	backend.set_read_pool(1, []() { return std::make_shared<MockedConnection>(); });
+	backend.add_connection_initializer([&calls](orm::IDatabaseConnection&) { calls.emplace_back("first"); });
+	backend.add_connection_initializer([&calls](orm::IDatabaseConnection&) { calls.emplace_back("second"); });
+	backend.create_pool();
+	ASSERT_EQ(calls, std::vector<std::string>({"first", "second", "first", "second"}));
+}
+
+TEST(TestCase_DefaultSQLBackend, add_connection_initializer_FailsOpening)
+{
+	orm::PoolOptions options;
+	options.min_connections = 0;
+	options.max_connections = 1;
+	TestCase_PoolBackend backend(options);
+	backend.add_connection_initializer([](orm::IDatabaseConnection&)
+	{
+		throw orm::DatabaseError("initialization failed", _ERROR_DETAILS_);
+	});
+	backend.create_pool();
+	ASSERT_THROW(backend.get_connection(), orm::DatabaseError);
+	ASSERT_EQ(backend.connections_count(), 0);
+}
+
+TEST(TestCase_DefaultSQLBackend, add_connection_initializer_ThrowsNullptr)
+{
+	TestCase_PoolBackend backend(1);
+	ASSERT_THROW(backend.add_connection_initializer(nullptr), NullPointerException);
+}
+
+struct TestCase_Backend_TestModel : public orm::db::Model
+{
+	static constexpr const char* meta_table_name = "test_model";
+
+	int id{};
+
+	inline static const std::tuple meta_columns = {
+		orm::db::make_pk_column_meta("id", &TestCase_Backend_TestModel::id)
+	};
+
+	inline void __orm_set_column__(const std::string& column_name, const char* data) override
+	{
+		this->__orm_set_column_data__(TestCase_Backend_TestModel::meta_columns, column_name, data);
+	}
+};
+
+TEST(TestCase_DefaultSQLBackend, Repository_RoutesSelectToReadPool)
+{
+	TestCase_PoolBackend backend(1);
+	backend.set_read_pool(1, []() { return std::make_shared<MockedConnection>(); });
+	backend.create_pool();
+	{
+		orm::Repository repository(&backend);
+		repository.select<TestCase_Backend_TestModel>();
+		ASSERT_EQ(backend.read_pool_metrics().used_connections_count, 1);
+		ASSERT_EQ(backend.pool_metrics().used_connections_count, 0);
+
+		repository.delete_<TestCase_Backend_TestModel>();
+		ASSERT_EQ(backend.pool_metrics().used_connections_count, 1);
+
+		repository.free_connection();
+		ASSERT_EQ(backend.read_pool_metrics().used_connections_count, 0);
+		ASSERT_EQ(backend.pool_metrics().used_connections_count, 0);
+
+		repository.select<TestCase_Backend_TestModel>();
+	}
+
+	ASSERT_EQ(backend.read_pool_metrics().used_connections_count, 0);
+}
+
+TEST(TestCase_DefaultSQLBackend, Repository_RoutesSelectToMainConnectionAfterWrite)
+{
+	TestCase_PoolBackend backend(1);
+	backend.set_read_pool(1, []() { return std::make_shared<MockedConnection>(); });
+	backend.create_pool();
+	{
+		orm::Repository repository(&backend);
+		repository.update<TestCase_Backend_TestModel>();
+		repository.select<TestCase_Backend_TestModel>();
+		ASSERT_EQ(backend.pool_metrics().used_connections_count, 1);
+		ASSERT_EQ(backend.read_pool_metrics().used_connections_count, 0);
+
+		repository.free_connection();
+		repository.select<TestCase_Backend_TestModel>().delete_();
+		ASSERT_EQ(backend.read_pool_metrics().used_connections_count, 1);
+		ASSERT_EQ(backend.pool_metrics().used_connections_count, 1);
+
+		repository.select<TestCase_Backend_TestModel>();
+		ASSERT_EQ(backend.read_pool_metrics().used_connections_count, 1);
+	}
+
+	ASSERT_EQ(backend.read_pool_metrics().used_connections_count, 0);
+	ASSERT_EQ(backend.pool_metrics().used_connections_count, 0);
+}
+
+TEST(TestCase_ShardedConnectionPool, acquire_OpensConnectionsLazily)
+{
+	orm::PoolOptions options;
+	options.min_connections = 0;
+	options.max_connections = 2;
+	options.is_sharded = true;
+	TestCase_PoolBackend backend(options);
+	backend.create_pool();
+	ASSERT_EQ(backend.opened.load(), 0);
+
+	auto first = backend.get_connection();
+	auto second = backend.get_connection();
+	ASSERT_EQ(backend.opened.load(), 2);
+	ASSERT_NE(first, second);
+	ASSERT_THROW(backend.get_connection(std::chrono::milliseconds(10)), orm::PoolTimeoutError);
+
+	backend.release_connection(first);
+	ASSERT_EQ(backend.idle_connections_count(), 1);
+	ASSERT_EQ(backend.get_connection(), first);
+	ASSERT_EQ(backend.opened.load(), 2);
+}
+
+TEST(TestCase_ShardedConnectionPool, release_ThrowsForeignConnection)
+{
+	orm::PoolOptions options;
+	options.is_sharded = true;
+	TestCase_PoolBackend backend(options);
+	ASSERT_THROW(backend.release_connection(std::make_shared<MockedConnection>()), ValueError);
+}
+
+TEST(TestCase_ShardedConnectionPool, evict_idle_connections_KeepsMinConnections)
+{
+	orm::PoolOptions options;
+	options.min_connections = 1;
+	options.max_connections = 3;
+	options.idle_timeout = std::chrono::milliseconds(0);
+	options.is_sharded = true;
+	TestCase_PoolBackend backend(options);
+	backend.create_pool();
+	auto first = backend.get_connection();
+	auto second = backend.get_connection();
+	auto third = backend.get_connection();
+	ASSERT_EQ(backend.connections_count(), 3);
+
+	backend.release_connection(first);
+	backend.release_connection(second);
+	backend.release_connection(third);
+	std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	backend.evict_idle_connections();
+	ASSERT_EQ(backend.connections_count(), 1);
+	ASSERT_EQ(backend.idle_connections_count(), 1);
+}
+
+TEST(TestCase_ShardedConnectionPool, get_connection_IsExclusiveUnderContention)
+{
+	orm::PoolOptions options;
+	options.min_connections = 0;
+	options.max_connections = 3;
+	options.is_sharded = true;
+	TestCase_PoolBackend backend(options);
+	backend.create_pool();
+
+	std::atomic<size_t> used = 0;
+	std::atomic<bool> is_exceeded = false;
+	std::vector<std::thread> threads;
+	for (auto i = 0; i < 8; i++)
+	{
+		threads.emplace_back([&backend, &used, &is_exceeded]()
+		{
+			for (auto j = 0; j < 1000; j++)
+			{
+				auto connection = backend.get_connection();
+				if (++used > 3)
+				{
+					is_exceeded = true;
+				}
+
+				used--;
+				backend.release_connection(connection);
+			}
+		});
+	}
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	ASSERT_FALSE(is_exceeded);
+	ASSERT_LE(backend.opened.load(), 3);
+	ASSERT_EQ(backend.idle_connections_count(), backend.connections_count());
+}
+
+static void assert_pool_metrics_are_collected(orm::PoolOptions options)
+{
+	options.min_connections = 1;
+	options.max_connections = 3;
+	TestCase_PoolBackend backend(options);
+	backend.create_pool();
+	auto first = backend.get_connection();
+	auto second = backend.get_connection();
+	backend.is_failing = true;
+	ASSERT_THROW(backend.get_connection(), orm::DatabaseError);
+
+	backend.is_failing = false;
+	auto third = backend.get_connection();
+	ASSERT_THROW(backend.get_connection(std::chrono::milliseconds(0)), orm::PoolTimeoutError);
+
+	auto metrics = backend.pool_metrics();
+	ASSERT_EQ(metrics.connections_count, 3);
+	ASSERT_EQ(metrics.used_connections_count, 3);
+	ASSERT_EQ(metrics.idle_connections_count, 0);
+	ASSERT_EQ(metrics.waiters_count, 0);
+	ASSERT_EQ(metrics.created_count, 3);
+	ASSERT_EQ(metrics.creation_failures_count, 1);
+	ASSERT_EQ(metrics.timeouts_count, 1);
+	ASSERT_EQ(metrics.acquire_wait_time.count, 3);
+	ASSERT_EQ(metrics.hold_time.count, 0);
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	backend.release_connection(first);
+
+	metrics = backend.pool_metrics();
+	ASSERT_EQ(metrics.used_connections_count, 2);
+	ASSERT_EQ(metrics.idle_connections_count, 1);
+	ASSERT_EQ(metrics.hold_time.count, 1);
+	ASSERT_GE(metrics.hold_time.max, std::chrono::milliseconds(2));
+}
+
+TEST(TestCase_DefaultSQLBackend, pool_metrics_CountsConnections)
+{
+	assert_pool_metrics_are_collected(orm::PoolOptions());
+}
+
+TEST(TestCase_ShardedConnectionPool, pool_metrics_CountsConnections)
+{
+	orm::PoolOptions options;
+	options.is_sharded = true;
+	assert_pool_metrics_are_collected(options);
+}
+
+TEST(TestCase_DefaultSQLBackend, report_pool_metrics_CallsCallbackPeriodically)
+{
+	TestCase_PoolBackend backend(2);
+	backend.create_pool();
+	std::atomic<size_t> reports = 0;
+	std::atomic<size_t> connections = 0;
+	std::atomic<bool> has_read_metrics = true;
+	backend.report_pool_metrics([&](const orm::DefaultSQLBackend::PoolsMetrics& metrics)
+	{
+		connections = metrics.main.connections_count;
+		has_read_metrics = metrics.read.has_value();
+		reports++;
+		throw orm::DatabaseError("ignored", _ERROR_DETAILS_);
+	}, std::chrono::milliseconds(1));
+	while (reports < 2)
+	{
+		std::this_thread::yield();
+	}
+
+	backend.report_pool_metrics(nullptr, std::chrono::milliseconds(1));
+	auto reported = reports.load();
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	ASSERT_EQ(reports.load(), reported);
+	ASSERT_EQ(connections.load(), 2);
+	ASSERT_FALSE(has_read_metrics.load());
+}
+
+TEST(TestCase_DefaultSQLBackend, report_pool_metrics_ReportsReadPool)
+{
+	TestCase_PoolBackend backend(1);
+	backend.set_read_pool(3, []() { return std::make_shared<MockedConnection>(); });
+	backend.create_pool();
+	auto reader = backend.get_read_connection();
+
+	std::mutex mutex;
+	std::optional<orm::DefaultSQLBackend::PoolsMetrics> reported;
+	backend.report_pool_metrics([&](const orm::DefaultSQLBackend::PoolsMetrics& metrics)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		reported = metrics;
+	}, std::chrono::milliseconds(1));
+	while (true)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (reported.has_value())
+		{
+			break;
+		}
+	}
+
+	backend.report_pool_metrics(nullptr, std::chrono::milliseconds(1));
+	ASSERT_EQ(reported->main.connections_count, 1);
+	ASSERT_EQ(reported->main.used_connections_count, 0);
+	ASSERT_TRUE(reported->read.has_value());
+	ASSERT_EQ(reported->read->connections_count, 3);
+	ASSERT_EQ(reported->read->used_connections_count, 1);
+
+	auto snapshot = backend.pools_metrics();
+	ASSERT_EQ(snapshot.main.connections_count, 1);
+	ASSERT_EQ(snapshot.read->idle_connections_count, 2);
+	backend.release_read_connection(reader);
+}
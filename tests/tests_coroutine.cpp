@@ -0,0 +1,295 @@
+/**
+ * tests_coroutine.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <atomic>
+#include <coroutine>
+#include <thread>
+#include <optional>
+#include <set>
+
+#include <gtest/gtest.h>
+
+#include "../src/coroutine.h"
+#include "../src/repository.h"
+#include "../src/queries/select.h"
+#include "./queries/mocked_backend.h"
+
+using namespace xw;
+
+
+// Coroutine which starts immediately and is not awaited.
+struct TestCase_Coroutine_Task
+{
+	struct promise_type
+	{
+		TestCase_Coroutine_Task get_return_object()
+		{
+			return {};
+		}
+
+		std::suspend_never initial_suspend() noexcept
+		{
+			return {};
+		}
+
+		std::suspend_never final_suspend() noexcept
+		{
+			return {};
+		}
+
+		void return_void()
+		{
+		}
+
+		void unhandled_exception()
+		{
+			std::terminate();
+		}
+	};
+};
+
+struct TestCase_Coroutine_Model : public orm::db::Model
+{
+	static constexpr const char* meta_table_name = "test_model";
+
+	int id{};
+	std::string name;
+
+	inline static const std::tuple meta_columns = {
+		orm::db::make_pk_column_meta("id", &TestCase_Coroutine_Model::id),
+		orm::db::make_column_meta("name", &TestCase_Coroutine_Model::name)
+	};
+
+	inline void __orm_set_column__(const std::string& column_name, const char* data) override
+	{
+		this->__orm_set_column_data__(TestCase_Coroutine_Model::meta_columns, column_name, data);
+	}
+};
+
+TEST(TestCase_Awaitable, co_await_ContinuesWithoutSuspensionIfCompleted)
+{
+	std::optional<int> result;
+	[&result]() -> TestCase_Coroutine_Task {
+		result = co_await orm::Awaitable<int>([](auto handler) { handler(1, nullptr); });
+	}();
+	ASSERT_EQ(result, 1);
+}
+
+TEST(TestCase_Awaitable, co_await_ResumesFromCompletingThread)
+{
+	orm::Awaitable<int>::result_handler completion;
+	std::optional<int> result;
+	std::thread::id resumed_by;
+	[&]() -> TestCase_Coroutine_Task {
+		result = co_await orm::Awaitable<int>([&completion](auto handler) { completion = std::move(handler); });
+		resumed_by = std::this_thread::get_id();
+	}();
+	ASSERT_FALSE(result.has_value());
+
+	std::thread thread([&completion]() { completion(2, nullptr); });
+	auto thread_id = thread.get_id();
+	thread.join();
+	ASSERT_EQ(result, 2);
+	ASSERT_EQ(resumed_by, thread_id);
+}
+
+TEST(TestCase_Awaitable, co_await_ResumesThroughExecutor)
+{
+	orm::Awaitable<int>::result_handler completion;
+	std::optional<int> result;
+	std::function<void()> task;
+	[&]() -> TestCase_Coroutine_Task {
+		result = co_await orm::Awaitable<int>([&completion](auto handler) { completion = std::move(handler); })
+			.via([&task](std::function<void()> resume) { task = std::move(resume); });
+	}();
+
+	completion(3, nullptr);
+	ASSERT_FALSE(result.has_value());
+	ASSERT_TRUE(task);
+	task();
+	ASSERT_EQ(result, 3);
+}
+
+TEST(TestCase_Awaitable, co_await_ResumesThroughEventLoopExecutor)
+{
+	orm::Awaitable<int>::result_handler completion;
+	std::optional<int> result;
+	std::function<void()> task;
+	[&]() -> TestCase_Coroutine_Task {
+		result = co_await orm::Awaitable<int>([&completion](auto handler) { completion = std::move(handler); });
+	}();
+
+	std::thread loop([&completion, &task]() {
+		orm::event_loop_executor() = [&task](std::function<void()> resume) { task = std::move(resume); };
+		completion(4, nullptr);
+	});
+	loop.join();
+	ASSERT_FALSE(result.has_value());
+	ASSERT_TRUE(task);
+	task();
+	ASSERT_EQ(result, 4);
+}
+
+TEST(TestCase_ThreadPool, post_RunsTasksOnFixedThreads)
+{
+	std::mutex mutex;
+	std::set<std::thread::id> threads;
+	{
+		orm::ThreadPool pool(2);
+		for (size_t i = 0; i < 100; i++)
+		{
+			pool.post([&mutex, &threads]() {
+				std::lock_guard lock(mutex);
+				threads.insert(std::this_thread::get_id());
+			});
+		}
+	}
+
+	ASSERT_GE(threads.size(), 1);
+	ASSERT_LE(threads.size(), 2);
+	ASSERT_FALSE(threads.contains(std::this_thread::get_id()));
+}
+
+TEST(TestCase_ThreadPool, destructor_RunsPostedTasks)
+{
+	std::atomic<size_t> calls = 0;
+	{
+		orm::ThreadPool pool(1);
+		for (size_t i = 0; i < 10; i++)
+		{
+			pool.post([&calls]() { calls++; });
+		}
+	}
+
+	ASSERT_EQ(calls, 10);
+}
+
+TEST(TestCase_Awaitable, co_await_RethrowsError)
+{
+	bool is_thrown = false;
+	[&is_thrown]() -> TestCase_Coroutine_Task {
+		try
+		{
+			co_await orm::Awaitable<>([](auto) { throw orm::SQLError("failed", _ERROR_DETAILS_); });
+		}
+		catch (const orm::SQLError&)
+		{
+			is_thrown = true;
+		}
+	}();
+	ASSERT_TRUE(is_thrown);
+}
+
+TEST(TestCase_Awaitable, co_all_IsResumedWhenQueryCompletes)
+{
+	MockedBackend backend;
+	MockedAsyncConnection connection;
+	std::optional<std::list<TestCase_Coroutine_Model>> models;
+	[&]() -> TestCase_Coroutine_Task {
+		models = co_await orm::q::Select<TestCase_Coroutine_Model>(&connection, backend.sql_builder()).co_all();
+	}();
+	ASSERT_FALSE(models.has_value());
+
+	connection.complete({
+		{{"id", orm::db::Value(1LL)}, {"name", orm::db::Value(std::string_view("John"))}}
+	});
+	ASSERT_TRUE(models.has_value());
+	ASSERT_EQ(models->size(), 1);
+	ASSERT_EQ(models->front().name, "John");
+}
+
+TEST(TestCase_Awaitable, co_count_ReturnsAggregate)
+{
+	MockedBackend backend;
+	MockedAsyncConnection connection;
+	std::optional<size_t> count;
+	[&]() -> TestCase_Coroutine_Task {
+		count = co_await orm::q::Select<TestCase_Coroutine_Model>(&connection, backend.sql_builder()).co_count();
+	}();
+	ASSERT_EQ(connection.sql_query, R"(SELECT count(*) AS agg_result FROM "test_model";)");
+
+	connection.complete({{{"agg_result", orm::db::Value(5LL)}}});
+	ASSERT_EQ(count, 5);
+}
+
+TEST(TestCase_Awaitable, co_get_connection_WaitsForReleasedConnection)
+{
+	MockedBackend backend;
+	auto connection = backend.get_connection();
+	std::shared_ptr<orm::IDatabaseConnection> received;
+	[&]() -> TestCase_Coroutine_Task {
+		received = co_await backend.co_get_connection();
+	}();
+	ASSERT_EQ(received, nullptr);
+
+	backend.release_connection(connection);
+	ASSERT_EQ(received, connection);
+	ASSERT_EQ(backend.idle_connections_count(), 0);
+}
+
+TEST(TestCase_Awaitable, co_connect_ProvidesConnectionToQueries)
+{
+	MockedBackend backend;
+	auto connection = backend.get_connection();
+	orm::Repository repository(&backend);
+	bool is_connected = false;
+	[&]() -> TestCase_Coroutine_Task {
+		co_await repository.co_connect();
+		is_connected = true;
+		co_await repository.select<TestCase_Coroutine_Model>().co_all();
+	}();
+	ASSERT_FALSE(is_connected);
+
+	backend.release_connection(connection);
+	ASSERT_TRUE(is_connected);
+	repository.free_connection();
+	ASSERT_EQ(backend.idle_connections_count(), 1);
+}
+
+TEST(TestCase_Awaitable, co_connect_WaitsForReadConnection)
+{
+	MockedBackend backend;
+	backend.set_read_pool(1, []() { return std::make_shared<MockedConnection>(); });
+	auto read_connection = backend.get_read_connection();
+	orm::Repository repository(&backend);
+	bool is_connected = false;
+	[&]() -> TestCase_Coroutine_Task {
+		co_await repository.co_connect();
+		is_connected = true;
+	}();
+	ASSERT_FALSE(is_connected);
+	ASSERT_EQ(backend.pool_metrics().used_connections_count, 1);
+
+	backend.release_read_connection(read_connection);
+	ASSERT_TRUE(is_connected);
+
+	// The read connection is already acquired, so the query does not wait.
+	repository.select<TestCase_Coroutine_Model>();
+	ASSERT_EQ(backend.read_pool_metrics().used_connections_count, 1);
+	repository.free_connection();
+	ASSERT_EQ(backend.read_pool_metrics().used_connections_count, 0);
+}
+
+TEST(TestCase_Awaitable, co_get_connection_FailsWhenBackendIsDestroyed)
+{
+	auto backend = std::make_unique<MockedBackend>();
+	auto connection = backend->get_connection();
+	bool is_thrown = false;
+	[&]() -> TestCase_Coroutine_Task {
+		try
+		{
+			co_await backend->co_get_connection();
+		}
+		catch (const orm::DatabaseError&)
+		{
+			is_thrown = true;
+		}
+	}();
+	ASSERT_FALSE(is_thrown);
+
+	backend = nullptr;
+	ASSERT_TRUE(is_thrown);
+}
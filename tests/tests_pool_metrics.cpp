@@ -0,0 +1,49 @@
+/**
+ * tests_pool_metrics.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <gtest/gtest.h>
+
+#include "../src/pool_metrics.h"
+
+using namespace xw;
+
+
+TEST(TestCase_DurationHistogram, bucket_index_UsesPowersOfTwo)
+{
+	ASSERT_EQ(orm::DurationHistogram::bucket_index(std::chrono::microseconds(0)), 0);
+	ASSERT_EQ(orm::DurationHistogram::bucket_index(std::chrono::microseconds(1)), 1);
+	ASSERT_EQ(orm::DurationHistogram::bucket_index(std::chrono::microseconds(3)), 2);
+	ASSERT_EQ(orm::DurationHistogram::bucket_index(std::chrono::microseconds(4)), 3);
+	ASSERT_EQ(
+		orm::DurationHistogram::bucket_index(std::chrono::hours(24 * 365)),
+		orm::DurationHistogram::BUCKETS_COUNT - 1
+	);
+}
+
+TEST(TestCase_DurationHistogram, percentile_ReturnsBucketBound)
+{
+	orm::PoolMetricsCollector collector(2);
+	for (auto i = 0; i < 9; i++)
+	{
+		collector.record_acquire(i, std::chrono::microseconds(100));
+	}
+
+	collector.record_acquire(0, std::chrono::microseconds(5000));
+	auto histogram = collector.snapshot(0, 0).acquire_wait_time;
+	ASSERT_EQ(histogram.count, 10);
+	ASSERT_EQ(histogram.max, std::chrono::microseconds(5000));
+	ASSERT_EQ(histogram.mean(), std::chrono::microseconds(590));
+	ASSERT_EQ(histogram.percentile(0.5), std::chrono::microseconds(128));
+	ASSERT_EQ(histogram.percentile(0.9), std::chrono::microseconds(128));
+	ASSERT_EQ(histogram.percentile(0.99), std::chrono::microseconds(5000));
+}
+
+TEST(TestCase_DurationHistogram, percentile_ReturnsZeroIfEmpty)
+{
+	orm::DurationHistogram histogram;
+	ASSERT_EQ(histogram.percentile(0.5), std::chrono::microseconds(0));
+	ASSERT_EQ(histogram.mean(), std::chrono::microseconds(0));
+}
@@ -0,0 +1,134 @@
+/**
+ * tests_reactor.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <coroutine>
+#include <future>
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "../src/reactor.h"
+
+using namespace xw;
+
+
+// Coroutine which starts immediately and is not awaited.
+struct TestCase_Reactor_Task
+{
+	struct promise_type
+	{
+		TestCase_Reactor_Task get_return_object()
+		{
+			return {};
+		}
+
+		std::suspend_never initial_suspend() noexcept
+		{
+			return {};
+		}
+
+		std::suspend_never final_suspend() noexcept
+		{
+			return {};
+		}
+
+		void return_void()
+		{
+		}
+
+		void unhandled_exception()
+		{
+			std::terminate();
+		}
+	};
+};
+
+
+class TestCase_Reactor : public ::testing::Test
+{
+protected:
+	int pipe_descriptors[2] = {-1, -1};
+
+	void SetUp() override
+	{
+		ASSERT_EQ(pipe(this->pipe_descriptors), 0);
+	}
+
+	void TearDown() override
+	{
+		close(this->pipe_descriptors[0]);
+		close(this->pipe_descriptors[1]);
+	}
+};
+
+TEST_F(TestCase_Reactor, watch_CallsHandlerWhenReadable)
+{
+	orm::Reactor reactor;
+	std::promise<unsigned> events;
+	reactor.watch(this->pipe_descriptors[0], orm::Reactor::Readable, [&events](unsigned ready) {
+		events.set_value(ready);
+	});
+	auto future = events.get_future();
+	ASSERT_EQ(future.wait_for(std::chrono::milliseconds(10)), std::future_status::timeout);
+
+	ASSERT_EQ(write(this->pipe_descriptors[1], "x", 1), 1);
+	ASSERT_EQ(future.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+	ASSERT_TRUE(future.get() & orm::Reactor::Readable);
+}
+
+TEST_F(TestCase_Reactor, watch_HandlerCanWatchAgain)
+{
+	orm::Reactor reactor;
+	ASSERT_EQ(write(this->pipe_descriptors[1], "x", 1), 1);
+	std::promise<void> is_called_twice;
+	size_t calls = 0;
+	std::function<void(unsigned)> handler = [&](unsigned) {
+		if (++calls == 2)
+		{
+			is_called_twice.set_value();
+			return;
+		}
+
+		reactor.watch(this->pipe_descriptors[0], orm::Reactor::Readable, handler);
+	};
+	reactor.watch(this->pipe_descriptors[0], orm::Reactor::Readable, handler);
+	ASSERT_EQ(is_called_twice.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+}
+
+TEST_F(TestCase_Reactor, unwatch_DropsHandler)
+{
+	orm::Reactor reactor;
+	std::atomic<bool> is_called = false;
+	reactor.watch(this->pipe_descriptors[0], orm::Reactor::Readable, [&is_called](unsigned) {
+		is_called = true;
+	});
+	reactor.unwatch(this->pipe_descriptors[0]);
+	ASSERT_EQ(write(this->pipe_descriptors[1], "x", 1), 1);
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	ASSERT_FALSE(is_called);
+}
+
+TEST_F(TestCase_Reactor, watch_CoroutineIsNotResumedOnReactorThread)
+{
+	orm::Reactor reactor(1);
+	std::promise<std::thread::id> reactor_thread;
+	std::promise<std::thread::id> resumed_by;
+	[&]() -> TestCase_Reactor_Task {
+		co_await orm::Awaitable<>([&](auto handler) {
+			reactor.watch(this->pipe_descriptors[0], orm::Reactor::Readable, [&reactor_thread, handler](unsigned) {
+				reactor_thread.set_value(std::this_thread::get_id());
+				handler({}, nullptr);
+			});
+		});
+		resumed_by.set_value(std::this_thread::get_id());
+	}();
+
+	ASSERT_EQ(write(this->pipe_descriptors[1], "x", 1), 1);
+	auto future = resumed_by.get_future();
+	ASSERT_EQ(future.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+	ASSERT_NE(future.get(), reactor_thread.get_future().get());
+}
@@ -0,0 +1,209 @@
+/**
+ * tests_replica_pool.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../src/replica_pool.h"
+#include "./queries/mocked_backend.h"
+
+using namespace xw;
+
+
+class TestCase_ReplicaPool : public ::testing::Test
+{
+protected:
+	// Connections of each pool are counted by this vector.
+	std::vector<size_t> opened = {0, 0};
+	bool is_first_failing = false;
+	bool is_second_failing = false;
+
+	// Attempts to open connections of the second pool.
+	size_t second_attempts = 0;
+
+	std::unique_ptr<orm::ReplicaPool> make_pool(
+		orm::ReplicaRouting routing, size_t pool_size=2,
+		std::chrono::milliseconds failure_backoff=orm::ReplicaPool::DEFAULT_FAILURE_BACKOFF,
+		size_t min_connections=0
+	)
+	{
+		std::vector<std::unique_ptr<orm::IConnectionPool>> pools;
+		for (size_t i = 0; i < this->opened.size(); i++)
+		{
+			orm::PoolOptions options;
+			options.min_connections = min_connections;
+			options.max_connections = pool_size;
+			pools.push_back(std::make_unique<orm::ConnectionPool>(
+				options, [this, i]() -> std::shared_ptr<orm::IDatabaseConnection>
+				{
+					if (i == 1)
+					{
+						this->second_attempts++;
+					}
+
+					if ((i == 0 && this->is_first_failing) || (i == 1 && this->is_second_failing))
+					{
+						throw orm::DatabaseError("replica is down", _ERROR_DETAILS_);
+					}
+
+					this->opened[i]++;
+					return std::make_shared<MockedConnection>();
+				}
+			));
+		}
+
+		return std::make_unique<orm::ReplicaPool>(std::move(pools), routing, failure_backoff);
+	}
+};
+
+TEST_F(TestCase_ReplicaPool, constructor_ThrowsEmptyPools)
+{
+	ASSERT_THROW(orm::ReplicaPool({}, orm::ReplicaRouting::RoundRobin), ValueError);
+}
+
+TEST_F(TestCase_ReplicaPool, create_SkipsFailingPool)
+{
+	this->is_second_failing = true;
+	auto pool = this->make_pool(orm::ReplicaRouting::RoundRobin, 2, std::chrono::hours(1), 1);
+	ASSERT_NO_THROW(pool->create());
+	ASSERT_EQ(this->opened, std::vector<size_t>({1, 0}));
+	ASSERT_EQ(this->second_attempts, 1);
+
+	// The failed pool is backed off, so reads are served by the first.
+	for (size_t i = 0; i < 3; i++)
+	{
+		pool->release(pool->acquire());
+	}
+
+	ASSERT_EQ(this->second_attempts, 1);
+	ASSERT_EQ(this->opened, std::vector<size_t>({1, 0}));
+}
+
+TEST_F(TestCase_ReplicaPool, create_ThrowsIfAllPoolsFail)
+{
+	this->is_first_failing = true;
+	this->is_second_failing = true;
+	auto pool = this->make_pool(orm::ReplicaRouting::RoundRobin, 2, std::chrono::hours(1), 1);
+	ASSERT_THROW(pool->create(), orm::DatabaseError);
+}
+
+TEST_F(TestCase_ReplicaPool, acquire_AlternatesPoolsWithRoundRobin)
+{
+	auto pool = this->make_pool(orm::ReplicaRouting::RoundRobin);
+	for (auto i = 0; i < 4; i++)
+	{
+		pool->release(pool->acquire());
+	}
+
+	ASSERT_EQ(this->opened, std::vector<size_t>({1, 1}));
+	ASSERT_EQ(pool->metrics(0).acquire_wait_time.count, 2);
+	ASSERT_EQ(pool->metrics(1).acquire_wait_time.count, 2);
+}
+
+TEST_F(TestCase_ReplicaPool, acquire_PrefersLeastLoadedPool)
+{
+	auto pool = this->make_pool(orm::ReplicaRouting::LeastLoaded);
+	auto first = pool->acquire();
+	auto second = pool->acquire();
+	ASSERT_EQ(this->opened, std::vector<size_t>({1, 1}));
+	ASSERT_EQ(pool->metrics(0).used_connections_count, 1);
+	ASSERT_EQ(pool->metrics(1).used_connections_count, 1);
+
+	pool->release(first);
+	auto third = pool->acquire();
+	ASSERT_EQ(third, first);
+	pool->release(second);
+	pool->release(third);
+	ASSERT_EQ(pool->idle_connections_count(), 2);
+}
+
+TEST_F(TestCase_ReplicaPool, acquire_SkipsFailingPool)
+{
+	this->is_second_failing = true;
+	auto pool = this->make_pool(orm::ReplicaRouting::RoundRobin, 1);
+	auto first = pool->acquire();
+	ASSERT_THROW(pool->acquire(std::chrono::milliseconds(10)), orm::PoolTimeoutError);
+
+	pool->release(first);
+	ASSERT_EQ(pool->acquire(), first);
+	ASSERT_EQ(this->opened, std::vector<size_t>({1, 0}));
+}
+
+TEST_F(TestCase_ReplicaPool, acquire_BacksOffFailingPool)
+{
+	this->is_second_failing = true;
+	auto pool = this->make_pool(orm::ReplicaRouting::LeastLoaded, 3, std::chrono::hours(1));
+
+	// The second pool is the least loaded one while the first
+	// connection is held, so it is tried and fails once.
+	auto first = pool->acquire();
+	pool->release(pool->acquire());
+	ASSERT_EQ(this->second_attempts, 1);
+	for (size_t i = 0; i < 5; i++)
+	{
+		pool->release(pool->acquire());
+	}
+
+	// It is not tried again during the back-off.
+	ASSERT_EQ(this->second_attempts, 1);
+	ASSERT_EQ(pool->metrics(0).timeouts_count + pool->metrics(1).timeouts_count, 0);
+	pool->release(first);
+}
+
+TEST_F(TestCase_ReplicaPool, try_acquire_PrefersExhaustedPoolToBackedOff)
+{
+	this->is_second_failing = true;
+	auto pool = this->make_pool(orm::ReplicaRouting::RoundRobin, 1, std::chrono::hours(1));
+	auto first = pool->try_acquire();
+	ASSERT_NE(first, nullptr);
+
+	// The second pool fails and the first one is exhausted.
+	ASSERT_EQ(pool->try_acquire(), nullptr);
+	auto attempts = this->second_attempts;
+
+	// The second pool is backed off, so it is not tried while the
+	// first one can be waited for.
+	this->is_second_failing = false;
+	ASSERT_EQ(pool->try_acquire(), nullptr);
+	ASSERT_EQ(pool->try_acquire(), nullptr);
+	ASSERT_EQ(this->second_attempts, attempts);
+	ASSERT_EQ(pool->metrics(0).timeouts_count, 0);
+
+	pool->release(first);
+}
+
+TEST_F(TestCase_ReplicaPool, acquire_ThrowsErrorIfAllPoolsFail)
+{
+	std::vector<std::unique_ptr<orm::IConnectionPool>> pools;
+	pools.push_back(std::make_unique<orm::ConnectionPool>(1, []() -> std::shared_ptr<orm::IDatabaseConnection>
+	{
+		throw orm::DatabaseError("replica is down", _ERROR_DETAILS_);
+	}));
+	orm::ReplicaPool pool(std::move(pools), orm::ReplicaRouting::LeastLoaded);
+	ASSERT_THROW(pool.acquire(), orm::DatabaseError);
+}
+
+TEST_F(TestCase_ReplicaPool, release_ThrowsForeignConnection)
+{
+	auto pool = this->make_pool(orm::ReplicaRouting::RoundRobin);
+	ASSERT_THROW(pool->release(std::make_shared<MockedConnection>()), ValueError);
+}
+
+TEST_F(TestCase_ReplicaPool, metrics_SumsPools)
+{
+	auto pool = this->make_pool(orm::ReplicaRouting::RoundRobin);
+	auto first = pool->acquire();
+	auto second = pool->acquire();
+	auto metrics = pool->metrics();
+	ASSERT_EQ(metrics.connections_count, 2);
+	ASSERT_EQ(metrics.used_connections_count, 2);
+	ASSERT_EQ(metrics.created_count, 2);
+	ASSERT_EQ(metrics.acquire_wait_time.count, 2);
+	pool->release(first);
+	pool->release(second);
+}
@@ -178,12 +178,28 @@ TEST_F(DefaultSQLBuilder_TestCase, make_select_query_ComplicatedWhere)
 	std::string expected = R"(SELECT "test"."id" AS "id", "test"."name" AS "name" FROM "test" WHERE ("test"."id" = 1 AND "test"."name" < 'John');)";
 	auto actual = this->sql_builder.sql_select(
 		TestBuilder_TestModel::meta_table_name, {"id", "name"}, false, {}, {
-			orm::q::c(&TestBuilder_TestModel::id) == 1 & orm::q::c(&TestBuilder_TestModel::name) < "John"
+			(orm::q::c(&TestBuilder_TestModel::id) == 1) & (orm::q::c(&TestBuilder_TestModel::name) < "John")
 		}, {}, -1, 0, {}, {}
 	);
 	ASSERT_EQ(expected, actual);
 }
 
+TEST_F(DefaultSQLBuilder_TestCase, make_select_query_WhereWithParameters)
+{
+	std::string expected = R"(SELECT "test"."id" AS "id", "test"."name" AS "name" FROM "test" WHERE ("test"."id" = ? AND "test"."name" < ?);)";
+	std::vector<orm::db::Parameter> parameters;
+	auto actual = this->sql_builder.sql_select(
+		TestBuilder_TestModel::meta_table_name, {"id", "name"}, false, {}, {
+			(orm::q::c(&TestBuilder_TestModel::id) == 1) & (orm::q::c(&TestBuilder_TestModel::name) < "John")
+		}, {}, -1, 0, {}, {}, &parameters
+	);
+	ASSERT_EQ(expected, actual);
+	std::vector<orm::db::Parameter> expected_parameters{
+		orm::db::Parameter(1LL), orm::db::Parameter(std::string("John"))
+	};
+	ASSERT_EQ(expected_parameters, parameters);
+}
+
 TEST_F(DefaultSQLBuilder_TestCase, make_select_query_OrderBy)
 {
 	std::string expected = R"(SELECT "test"."id" AS "id", "test"."name" AS "name" FROM "test" ORDER BY "test"."id" ASC, "test"."name" DESC;)";
@@ -258,7 +274,7 @@ TEST_F(DefaultSQLBuilder_TestCase, make_select_query_ComplicatedHaving)
 		TestBuilder_TestModel::meta_table_name, {"id", "name"}, false, {}, {}, {}, -1, 0, {
 			"id"
 		},
-		orm::q::c(&TestBuilder_TestModel::id) == 1 & orm::q::c(&TestBuilder_TestModel::name) < "John"
+		(orm::q::c(&TestBuilder_TestModel::id) == 1) & (orm::q::c(&TestBuilder_TestModel::name) < "John")
 	);
 	ASSERT_EQ(expected, actual);
 }
@@ -274,6 +290,21 @@ TEST_F(DefaultSQLBuilder_TestCase, make_update_query_Full)
 	ASSERT_EQ(expected, actual);
 }
 
+TEST_F(DefaultSQLBuilder_TestCase, make_update_query_WithParameters)
+{
+	auto expected = R"(UPDATE "test" SET "test"."name" = ? WHERE "test"."id" = ?;)";
+	std::vector<orm::db::Parameter> parameters{orm::db::Parameter(std::string("Hello"))};
+	auto actual = this->sql_builder.sql_update(
+		TestBuilder_TestModel::meta_table_name,
+		R"("test"."name" = ?)",
+		orm::q::c(&TestBuilder_TestModel::id) == 1,
+		&parameters
+	);
+	ASSERT_EQ(expected, actual);
+	ASSERT_EQ(parameters.size(), 2);
+	ASSERT_EQ(parameters.back(), orm::db::Parameter(1LL));
+}
+
 TEST_F(DefaultSQLBuilder_TestCase, make_update_query_WithoutCondition)
 {
 	auto expected = R"(UPDATE "test" SET "test"."name" = 'Hello';)";
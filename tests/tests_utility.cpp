@@ -22,6 +22,15 @@ TEST(TestCase_utility, quote_str_NotQuoted)
 	ASSERT_EQ(orm::util::quote_str("Hello"), R"("Hello")");
 }
 
+TEST(TestCase_utility, append_quoted)
+{
+	std::string sql = "SELECT ";
+	orm::util::append_quoted(sql, "id");
+	sql += ", ";
+	orm::util::append_quoted(sql, R"("name")");
+	ASSERT_EQ(sql, R"(SELECT "id", "name")");
+}
+
 TEST(TestCase_utility, compare_any_True)
 {
 	int a = 10, b = 10;
@@ -41,6 +50,129 @@ TEST(TestCase_utility, compare_any_FalseWithDifferentTypes)
 	ASSERT_FALSE(orm::util::compare_any(a, s));
 }
 
+TEST(TestCase_utility, parse_iso_date)
+{
+	dt::Date date;
+	ASSERT_TRUE(orm::util::parse_iso_date("2021-03-04", date));
+	ASSERT_EQ(date, dt::Date(2021, 3, 4));
+	ASSERT_FALSE(orm::util::parse_iso_date("2021-13-04", date));
+	ASSERT_FALSE(orm::util::parse_iso_date("04.03.2021", date));
+	ASSERT_FALSE(orm::util::parse_iso_date("2021-03", date));
+}
+
+TEST(TestCase_utility, parse_iso_time_WithFraction)
+{
+	dt::Time time;
+	ASSERT_TRUE(orm::util::parse_iso_time("05:06:07.25+02", time));
+	ASSERT_EQ(time, dt::Time(5, 6, 7, 250000));
+	ASSERT_FALSE(orm::util::parse_iso_time("25:06:07", time));
+}
+
+TEST(TestCase_utility, parse_iso_datetime)
+{
+	dt::Datetime datetime;
+	ASSERT_TRUE(orm::util::parse_iso_datetime("2021-03-04 05:06:07", datetime));
+	ASSERT_EQ(datetime, dt::Datetime(2021, 3, 4, 5, 6, 7));
+	ASSERT_TRUE(orm::util::parse_iso_datetime("2021-03-04T05:06:07.000001", datetime));
+	ASSERT_EQ(datetime, dt::Datetime(2021, 3, 4, 5, 6, 7, 1));
+	ASSERT_FALSE(orm::util::parse_iso_datetime("2021-03-04", datetime));
+}
+
+TEST(TestCase_utility, as_datetime_IsoLayout)
+{
+	std::string_view text = "2021-03-04 05:06:07 tail";
+	ASSERT_EQ(
+		orm::util::as_datetime(text.substr(0, 19), orm::util::ISO_DATETIME_FORMAT),
+		dt::Datetime(2021, 3, 4, 5, 6, 7)
+	);
+}
+
+TEST(TestCase_utility, format_IsoLayout)
+{
+	ASSERT_EQ(orm::util::format_date(dt::Date(987, 3, 4), orm::util::ISO_DATE_FORMAT), "0987-03-04");
+	ASSERT_EQ(orm::util::format_time(dt::Time(5, 6, 7, 123), orm::util::ISO_TIME_FORMAT), "05:06:07");
+	ASSERT_EQ(
+		orm::util::format_datetime(dt::Datetime(2021, 12, 31, 23, 59, 58), orm::util::ISO_DATETIME_FORMAT),
+		"2021-12-31 23:59:58"
+	);
+}
+
+TEST(TestCase_utility, LRUCache_take_ReturnsNullOptIfNotCached)
+{
+	orm::util::LRUCache<std::string, int> cache(2);
+	ASSERT_FALSE(cache.take("key").has_value());
+}
+
+TEST(TestCase_utility, LRUCache_take_RemovesEntry)
+{
+	orm::util::LRUCache<std::string, int> cache(2);
+	cache.put("key", 1);
+	ASSERT_EQ(cache.take("key").value(), 1);
+	ASSERT_FALSE(cache.contains("key"));
+	ASSERT_EQ(cache.size(), 0);
+}
+
+TEST(TestCase_utility, LRUCache_put_EvictsLeastRecentlyUsed)
+{
+	std::vector<std::string> evicted;
+	orm::util::LRUCache<std::string, int> cache(2, [&evicted](const std::string& key, int&)
+	{
+		evicted.push_back(key);
+	});
+	cache.put("first", 1);
+	cache.put("second", 2);
+	cache.put("first", cache.take("first").value());
+	cache.put("third", 3);
+	ASSERT_EQ(evicted, std::vector<std::string>{"second"});
+	ASSERT_TRUE(cache.contains("first"));
+	ASSERT_TRUE(cache.contains("third"));
+}
+
+TEST(TestCase_utility, LRUCache_put_ReplacesValueWithSameKey)
+{
+	std::vector<int> evicted;
+	orm::util::LRUCache<std::string, int> cache(2, [&evicted](const std::string&, int& value)
+	{
+		evicted.push_back(value);
+	});
+	cache.put("key", 1);
+	cache.put("key", 2);
+	ASSERT_EQ(evicted, std::vector<int>{1});
+	ASSERT_EQ(cache.size(), 1);
+	ASSERT_EQ(cache.take("key").value(), 2);
+}
+
+TEST(TestCase_utility, LRUCache_put_ZeroCapacityEvictsImmediately)
+{
+	size_t evicted = 0;
+	orm::util::LRUCache<std::string, int> cache(0, [&evicted](const std::string&, int&) { evicted++; });
+	cache.put("key", 1);
+	ASSERT_EQ(evicted, 1);
+	ASSERT_EQ(cache.size(), 0);
+}
+
+TEST(TestCase_utility, LRUCache_discard_DoesNotEvict)
+{
+	size_t evicted = 0;
+	orm::util::LRUCache<std::string, int> cache(3, [&evicted](const std::string&, int&) { evicted++; });
+	cache.put("first", 1);
+	cache.discard();
+	ASSERT_EQ(evicted, 0);
+	ASSERT_EQ(cache.size(), 0);
+}
+
+TEST(TestCase_utility, LRUCache_Destructor_EvictsAll)
+{
+	size_t evicted = 0;
+	{
+		orm::util::LRUCache<std::string, int> cache(3, [&evicted](const std::string&, int&) { evicted++; });
+		cache.put("first", 1);
+		cache.put("second", 2);
+	}
+
+	ASSERT_EQ(evicted, 2);
+}
+
 class TestM : public orm::db::Model
 {
 public: